@@ -40,3 +40,19 @@ if(KPHP_TESTS)
         message(STATUS "---------------------")
     endif()
 endif()
+
+if(KPHP_BENCHMARKS)
+    find_package(benchmark QUIET)
+
+    if(NOT benchmark_FOUND)
+        handle_missing_library("benchmark")
+        set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+        FetchContent_Declare(
+                googlebenchmark
+                GIT_REPOSITORY https://github.com/google/benchmark.git
+                GIT_TAG        v1.5.2
+        )
+        FetchContent_MakeAvailable(googlebenchmark)
+        message(STATUS "---------------------")
+    endif()
+endif()
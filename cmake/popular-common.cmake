@@ -17,6 +17,8 @@ prepend(POPULAR_COMMON_SOURCES ${COMMON_DIR}/
         options.cpp
         kernel-version.cpp
         secure-bzero.cpp
+        re2-compatibility.cpp
+        regexp-pattern.cpp
         crc32_${HOST}.cpp
         crc32c_${HOST}.cpp
         parallel/counter.cpp
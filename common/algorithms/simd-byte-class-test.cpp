@@ -0,0 +1,61 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/algorithms/simd-byte-class.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+TEST(simd_byte_class, find) {
+  const vk::byte_class html_chars{"&\"'<>"};
+  const std::string no_special = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+  const char *begin = no_special.data();
+  const char *end = begin + no_special.size();
+  ASSERT_EQ(html_chars.find_first_of(begin, end), end);
+  ASSERT_EQ(html_chars.find_first_not_of(begin, end), begin);
+  ASSERT_EQ(html_chars.find_last_not_of(begin, end), end);
+
+  const std::string special = "Lorem ipsum dolor sit amet, <b>consectetur</b>";
+  ASSERT_EQ(html_chars.find_first_of(special.data(), special.data() + special.size()), special.data() + special.find('<'));
+
+  const vk::byte_class spaces{vk::string_view{" \n\r\t\v\0", 6}};
+  const std::string padded = std::string(40, ' ') + "text" + std::string(33, '\n') + '\0';
+  const char *padded_end = padded.data() + padded.size();
+  ASSERT_EQ(spaces.find_first_not_of(padded.data(), padded_end), padded.data() + 40);
+  ASSERT_EQ(spaces.find_last_not_of(padded.data(), padded_end), padded.data() + 44);
+  ASSERT_EQ(spaces.find_last_not_of(padded.data(), padded.data() + 40), padded.data());
+}
+
+TEST(simd_byte_class, random) {
+  std::mt19937 gen{7};
+  for (int iteration = 0; iteration < 1000; ++iteration) {
+    vk::byte_class bytes;
+    std::array<bool, 256> expected{};
+    const int bytes_count = std::uniform_int_distribution<int>{0, 64}(gen);
+    for (int i = 0; i < bytes_count; ++i) {
+      const auto c = static_cast<uint8_t>(std::uniform_int_distribution<int>{0, 255}(gen));
+      bytes.add(c);
+      expected[c] = true;
+    }
+    for (int c = 0; c < 256; ++c) {
+      ASSERT_EQ(bytes.contains(static_cast<uint8_t>(c)), expected[c]);
+    }
+
+    // long runs of the same byte with a few random ones
+    std::string s(std::uniform_int_distribution<size_t>{0, 100}(gen), static_cast<char>(std::uniform_int_distribution<int>{0, 255}(gen)));
+    for (int i = std::uniform_int_distribution<int>{0, 3}(gen); i > 0 && !s.empty(); --i) {
+      s[std::uniform_int_distribution<size_t>{0, s.size() - 1}(gen)] = static_cast<char>(std::uniform_int_distribution<int>{0, 255}(gen));
+    }
+    const char *begin = s.data();
+    const char *end = begin + s.size();
+    auto is_of_class = [&expected](char c) { return expected[static_cast<uint8_t>(c)]; };
+    ASSERT_EQ(bytes.find_first_of(begin, end), std::find_if(begin, end, is_of_class));
+    ASSERT_EQ(bytes.find_first_not_of(begin, end), std::find_if_not(begin, end, is_of_class));
+    const auto last_not_of = std::find_if_not(std::make_reverse_iterator(end), std::make_reverse_iterator(begin), is_of_class);
+    ASSERT_EQ(bytes.find_last_not_of(begin, end), last_not_of.base());
+  }
+}
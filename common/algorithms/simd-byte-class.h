@@ -0,0 +1,112 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "common/wrappers/string_view.h"
+
+namespace vk {
+
+// A set of bytes, which can be searched for in a string 16 bytes at once.
+// The membership of a byte is checked with two lookups by its low nibble
+// (for the bytes below and above 0x80), and the result is a bitmask of its high nibbles.
+class byte_class {
+public:
+  byte_class() noexcept = default;
+
+  explicit byte_class(vk::string_view bytes) noexcept {
+    for (char c : bytes) {
+      add(static_cast<uint8_t>(c));
+    }
+  }
+
+  void add(uint8_t c) noexcept {
+    contains_[c] = true;
+    low_nibble_lookup_[c >> 7][c & 0x0f] |= static_cast<uint8_t>(1u << ((c >> 4) & 7));
+  }
+
+  void add_range(uint8_t first, uint8_t last) noexcept {
+    for (uint32_t c = first; c <= last; ++c) {
+      add(static_cast<uint8_t>(c));
+    }
+  }
+
+  bool contains(uint8_t c) const noexcept {
+    return contains_[c];
+  }
+
+  // Returns the first byte of the class or end
+  const char *find_first_of(const char *begin, const char *end) const noexcept {
+    return find_first<true>(begin, end);
+  }
+
+  // Returns the first byte not of the class or end
+  const char *find_first_not_of(const char *begin, const char *end) const noexcept {
+    return find_first<false>(begin, end);
+  }
+
+  // Returns the position after the last byte not of the class or begin
+  const char *find_last_not_of(const char *begin, const char *end) const noexcept {
+#if defined(__SSSE3__)
+    for (; end - begin >= 16; end -= 16) {
+      const uint32_t not_of_class = ~match_mask(end - 16) & 0xffff;
+      if (not_of_class) {
+        return end - 16 + (32 - __builtin_clz(not_of_class));
+      }
+    }
+#endif
+    while (end != begin && contains(static_cast<uint8_t>(end[-1]))) {
+      --end;
+    }
+    return end;
+  }
+
+private:
+  template<bool of_class>
+  const char *find_first(const char *begin, const char *end) const noexcept {
+#if defined(__SSSE3__)
+    for (; end - begin >= 16; begin += 16) {
+      const uint32_t found = (of_class ? match_mask(begin) : ~match_mask(begin)) & 0xffff;
+      if (found) {
+        return begin + __builtin_ctz(found);
+      }
+    }
+#endif
+    while (begin != end && contains(static_cast<uint8_t>(*begin)) != of_class) {
+      ++begin;
+    }
+    return begin;
+  }
+
+#if defined(__SSSE3__)
+  // the bit i is set if the i-th byte is of the class
+  uint32_t match_mask(const char *p) const noexcept {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    // pshufb zeroes the result for the indices with the highest bit set
+    const __m128i low_bytes_lookup = _mm_shuffle_epi8(load_lookup(0), bytes);
+    const __m128i high_bytes_lookup = _mm_shuffle_epi8(load_lookup(1), _mm_xor_si128(bytes, _mm_set1_epi8(static_cast<char>(0x80))));
+    const __m128i high_nibbles = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f));
+    const __m128i high_nibble_bits = _mm_shuffle_epi8(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128), high_nibbles);
+    const __m128i matched = _mm_and_si128(_mm_or_si128(low_bytes_lookup, high_bytes_lookup), high_nibble_bits);
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(matched, _mm_setzero_si128())));
+  }
+
+  __m128i load_lookup(size_t index) const noexcept {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(low_nibble_lookup_[index].data()));
+  }
+#endif
+
+  std::array<bool, 256> contains_{};
+  // the bytes below 0x80 and above, the bit i is set if the byte with the high nibble i (or i + 8) is of the class
+  std::array<std::array<uint8_t, 16>, 2> low_nibble_lookup_{};
+};
+
+} // namespace vk
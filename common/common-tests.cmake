@@ -3,6 +3,7 @@ prepend(COMMON_TESTS_SOURCES ${COMMON_DIR}/
         algorithms/contains-test.cpp
         algorithms/hashes-test.cpp
         algorithms/projections-test.cpp
+        algorithms/simd-byte-class-test.cpp
         algorithms/simd-int-to-string-test.cpp
         algorithms/string-algorithms-test.cpp
         allocators/freelist-test.cpp
@@ -57,3 +57,8 @@ int madvise_madv_free_supported() {
   parse_kernel_version();
   return kernel_x > 4 || (kernel_x == 4 && kernel_y >= 5);
 }
+
+int io_uring_multishot_poll_supported() {
+  parse_kernel_version();
+  return kernel_x > 5 || (kernel_x == 5 && kernel_y >= 13);
+}
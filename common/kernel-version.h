@@ -8,4 +8,5 @@
 
 int epoll_exclusive_supported();
 int madvise_madv_free_supported();
+int io_uring_multishot_poll_supported();
 
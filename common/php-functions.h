@@ -65,6 +65,9 @@ private:
   extra_ref_cnt_value value_;
 };
 
+// string_hash never returns it, so it marks a string which hash is not computed yet
+constexpr int64_t STRING_HASH_UNKNOWN = std::numeric_limits<int64_t>::min();
+
 inline int64_t string_hash(const char *p, size_t l) __attribute__ ((always_inline)) ubsan_supp("alignment");
 
 int64_t string_hash(const char *p, size_t l) {
@@ -184,13 +187,25 @@ bool php_try_to_int(const char *s, size_t l, int64_t *val) {
   return true;
 }
 
+// size of the runtime string header: size, capacity, reference counter and cached hash
+constexpr int STRING_RAW_HEADER_SIZE = 3 * sizeof(int) + sizeof(int64_t);
+
+//writes the runtime string header to dest
+inline void string_raw_header(char *dest, int size, int capacity, int ref_cnt, int64_t hash) {
+  int *dest_int = reinterpret_cast <int *> (dest);
+  dest_int[0] = size;
+  dest_int[1] = capacity;
+  dest_int[2] = ref_cnt;
+  memcpy(dest + 3 * sizeof(int), &hash, sizeof(hash));
+}
+
 //returns len of raw string representation or -1 on error
 inline int string_raw_len(int src_len) {
-  if (src_len < 0 || src_len >= (1 << 30) - 13) {
+  if (src_len < 0 || src_len >= (1 << 30) - STRING_RAW_HEADER_SIZE - 1) {
     return -1;
   }
 
-  return src_len + 13;
+  return src_len + STRING_RAW_HEADER_SIZE + 1;
 }
 
 //returns len of raw string representation and writes it to dest or returns -1 on error
@@ -199,12 +214,9 @@ inline int string_raw(char *dest, int dest_len, const char *src, int src_len) {
   if (raw_len == -1 || raw_len > dest_len) {
     return -1;
   }
-  int *dest_int = reinterpret_cast <int *> (dest);
-  dest_int[0] = src_len;
-  dest_int[1] = src_len;
-  dest_int[2] = ExtraRefCnt::for_global_const;
-  memcpy(dest + 3 * sizeof(int), src, src_len);
-  dest[3 * sizeof(int) + src_len] = '\0';
+  string_raw_header(dest, src_len, src_len, ExtraRefCnt::for_global_const, string_hash(src, src_len));
+  memcpy(dest + STRING_RAW_HEADER_SIZE, src, src_len);
+  dest[STRING_RAW_HEADER_SIZE + src_len] = '\0';
 
   return raw_len;
 }
@@ -0,0 +1,240 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/re2-compatibility.h"
+
+#include <cassert>
+#include <cctype>
+
+namespace vk {
+
+RE2Compatibility check_RE2_compatibility(const char *regexp_string, int64_t regexp_len, bool is_utf8) noexcept {
+  int64_t brackets_depth = 0;
+  bool prev_is_group = false;
+
+  for (int64_t i = 0; i < regexp_len; i++) {
+    switch (regexp_string[i]) {
+      case -128 ... -1:
+      case 1 ... 35:
+      case 37 ... 39:
+      case ',' ... '>':
+      case '@':
+      case 'A' ... 'Z':
+      case ']':
+      case '_':
+      case '`':
+      case 'a' ... 'z':
+      case '}' ... 127:
+        prev_is_group = true;
+        break;
+      case '$':
+      case '^':
+      case '|':
+        prev_is_group = false;
+        break;
+      case 0:
+        return RE2Compatibility::zero_symbol;
+      case '(':
+        brackets_depth++;
+
+        if (regexp_string[i + 1] == '*') {
+          return RE2Compatibility::incompatible;
+        }
+
+        if (regexp_string[i + 1] == '?') {
+          if (regexp_string[i + 2] == ':') {
+            i += 2;
+            break;
+          }
+          if (regexp_string[i + 2] == ':') {
+            i += 2;
+            break;
+          }
+          return RE2Compatibility::incompatible;
+        }
+        prev_is_group = false;
+        break;
+      case ')':
+        brackets_depth--;
+        if (brackets_depth < 0) {
+          return RE2Compatibility::incompatible;
+        }
+        prev_is_group = true;
+        break;
+      case '+':
+      case '*':
+        if (!prev_is_group) {
+          return RE2Compatibility::incompatible;
+        }
+
+        prev_is_group = false;
+        break;
+      case '?':
+        if (!prev_is_group && (i == 0 || (regexp_string[i - 1] != '+' && regexp_string[i - 1] != '*' && regexp_string[i - 1] != '?'))) {
+          return RE2Compatibility::incompatible;
+        }
+
+        prev_is_group = false;
+        break;
+      case '{': {
+        if (!prev_is_group) {
+          return RE2Compatibility::incompatible;
+        }
+
+        i++;
+        int64_t k = 0;
+        while ('0' <= regexp_string[i] && regexp_string[i] <= '9') {
+          i++;
+          k++;
+        }
+
+        if (k > 2) {
+          return RE2Compatibility::incompatible;
+        }
+
+        if (regexp_string[i] == ',') {
+          i++;
+        }
+
+        k = 0;
+        while ('0' <= regexp_string[i] && regexp_string[i] <= '9') {
+          k++;
+          i++;
+        }
+
+        if (k > 2) {
+          return RE2Compatibility::incompatible;
+        }
+
+        if (regexp_string[i] != '}') {
+          return RE2Compatibility::wrong_repetition;
+        }
+
+        prev_is_group = false;
+        break;
+      }
+      case '[':
+        if (regexp_string[i + 1] == '^') {
+          i++;
+        }
+        if (regexp_string[i + 1] == ']') {
+          i++;
+        }
+        while (true) {
+          while (++i < regexp_len && regexp_string[i] != '\\' && regexp_string[i] != ']' && regexp_string[i] != '[') {
+          }
+
+          if (i == regexp_len) {
+            return RE2Compatibility::incompatible;
+          }
+
+          if (regexp_string[i] == '\\') {
+            switch (regexp_string[i + 1]) {
+              case 'x':
+                if (isxdigit(regexp_string[i + 2]) &&
+                    isxdigit(regexp_string[i + 3])) {
+                  i += 3;
+                  continue;
+                }
+                return RE2Compatibility::incompatible;
+              case '0':
+                if ('0' <= regexp_string[i + 2] && regexp_string[i + 2] <= '7' &&
+                    '0' <= regexp_string[i + 3] && regexp_string[i + 3] <= '7') {
+                  i += 3;
+                  continue;
+                }
+                return RE2Compatibility::incompatible;
+              case 'a':
+              case 'f':
+              case 'n':
+              case 'r':
+              case 't':
+              case -128 ... '/':
+              case ':' ... '@':
+              case '[' ... '`':
+              case '{' ... 127:
+                i++;
+                continue;
+              case 'd':
+              case 'D':
+              case 's':
+              case 'S':
+              case 'w':
+              case 'W':
+                if (!is_utf8) {
+                  i++;
+                  continue;
+                }
+                return RE2Compatibility::incompatible;
+              default:
+                return RE2Compatibility::incompatible;
+            }
+          } else if (regexp_string[i] == '[') {
+            if (regexp_string[i + 1] == ':') {
+              return RE2Compatibility::incompatible;
+            }
+          } else if (regexp_string[i] == ']') {
+            break;
+          }
+        }
+        prev_is_group = true;
+        break;
+      case '\\':
+        switch (regexp_string[i + 1]) {
+          case 'x':
+            if (isxdigit(regexp_string[i + 2]) &&
+                isxdigit(regexp_string[i + 3])) {
+              i += 3;
+              break;
+            }
+            return RE2Compatibility::incompatible;
+          case '0':
+            if ('0' <= regexp_string[i + 2] && regexp_string[i + 2] <= '7' &&
+                '0' <= regexp_string[i + 3] && regexp_string[i + 3] <= '7') {
+              i += 3;
+              break;
+            }
+            return RE2Compatibility::incompatible;
+          case 'a':
+          case 'f':
+          case 'n':
+          case 'r':
+          case 't':
+          case -128 ... '/':
+          case ':' ... '@':
+          case '[' ... '`':
+          case '{' ... 127:
+            i++;
+            break;
+          case 'b':
+          case 'B':
+          case 'd':
+          case 'D':
+          case 's':
+          case 'S':
+          case 'w':
+          case 'W':
+            if (!is_utf8) {
+              i++;
+              continue;
+            }
+            return RE2Compatibility::incompatible;
+          default:
+            return RE2Compatibility::incompatible;
+        }
+
+        prev_is_group = true;
+        break;
+      default:
+        assert(0 && "wrong char range assumed");
+    }
+  }
+  if (brackets_depth != 0) {
+    return RE2Compatibility::brackets_mismatch;
+  }
+
+  return RE2Compatibility::compatible;
+}
+
+} // namespace vk
@@ -0,0 +1,24 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+namespace vk {
+
+enum class RE2Compatibility {
+  compatible,
+  incompatible,
+  // these ones are incompatible too, but they are worth reporting
+  zero_symbol,
+  wrong_repetition,
+  brackets_mismatch
+};
+
+// checks if the PCRE pattern (without delimiters and modifiers) can be handled by RE2 with the same semantics;
+// it is shared between the compiler (for constant patterns) and the runtime
+RE2Compatibility check_RE2_compatibility(const char *regexp_string, int64_t regexp_len, bool is_utf8) noexcept;
+
+} // namespace vk
@@ -0,0 +1,191 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "common/regexp-pattern.h"
+
+#include <pcre.h>
+
+namespace vk {
+
+namespace {
+
+bool get_end_delimiter(char start_delimiter, char &end_delimiter) noexcept {
+  switch (start_delimiter) {
+    case '(':
+      end_delimiter = ')';
+      return true;
+    case '[':
+      end_delimiter = ']';
+      return true;
+    case '{':
+      end_delimiter = '}';
+      return true;
+    case '>':
+    case '!' ... '\'':
+    case '*' ... '/':
+    case ':':
+    case ';':
+    case '=':
+    case '?':
+    case '@':
+    case '^':
+    case '_':
+    case '`':
+    case '|':
+    case '~':
+      end_delimiter = start_delimiter;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// the same rules as mb_UTF8_check() has: no overlong sequences, surrogates and code points after U+10FFFF
+bool is_valid_utf8(const char *s, int64_t len) noexcept {
+  const auto *str = reinterpret_cast<const unsigned char *>(s);
+  const auto *end = str + len;
+  while (str != end) {
+    const unsigned int a = *str++;
+    if ((a & 0x80) == 0) {
+      continue;
+    }
+    if ((a & 0x40) == 0 || str == end) {
+      return false;
+    }
+
+    const unsigned int b = *str++;
+    if ((b & 0xc0) != 0x80) {
+      return false;
+    }
+    if ((a & 0x20) == 0) {
+      if ((a & 0x1e) == 0) {
+        return false;
+      }
+      continue;
+    }
+
+    if (str == end || (*str & 0xc0) != 0x80) {
+      return false;
+    }
+    ++str;
+    if ((a & 0x10) == 0) {
+      const unsigned int x = ((a & 0x0f) << 6) | (b & 0x20);
+      if (x == 0 || x == 0x360) {
+        return false;
+      }
+      continue;
+    }
+
+    if (str == end || (*str & 0xc0) != 0x80) {
+      return false;
+    }
+    ++str;
+    if ((a & 0x08) == 0) {
+      const unsigned int t = ((a & 0x07) << 6) | (b & 0x30);
+      if (t == 0 || t >= 0x110) {
+        return false;
+      }
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+const char *regexp_engine_name(RegexpEngine engine) noexcept {
+  switch (engine) {
+    case RegexpEngine::auto_detect:
+      return "auto_detect";
+    case RegexpEngine::RE2:
+      return "RE2";
+    case RegexpEngine::RE2_with_PCRE:
+      return "RE2_with_PCRE";
+    case RegexpEngine::PCRE:
+      return "PCRE";
+  }
+  __builtin_unreachable();
+}
+
+RegexpPatternError parse_regexp_pattern(const char *pattern, int64_t pattern_len, RegexpPattern &result) noexcept {
+  result = RegexpPattern{};
+  if (pattern_len == 0) {
+    return RegexpPatternError::empty;
+  }
+
+  if (!get_end_delimiter(pattern[0], result.end_delimiter)) {
+    return RegexpPatternError::wrong_start_delimiter;
+  }
+
+  int64_t regexp_end = pattern_len - 1;
+  while (regexp_end > 0 && pattern[regexp_end] != result.end_delimiter) {
+    regexp_end--;
+  }
+  if (regexp_end == 0) {
+    return RegexpPatternError::no_end_delimiter;
+  }
+
+  result.body = pattern + 1;
+  result.body_len = regexp_end - 1;
+
+  for (int64_t i = regexp_end + 1; i < pattern_len; i++) {
+    switch (pattern[i]) {
+      case 'i':
+        result.pcre_options |= PCRE_CASELESS;
+        result.caseless = true;
+        break;
+      case 'm':
+        result.pcre_options |= PCRE_MULTILINE;
+        // supported by RE2::Regexp but disabled in an interface while not using posix_syntax
+        result.can_use_RE2 = false;
+        break;
+      case 's':
+        result.pcre_options |= PCRE_DOTALL;
+        result.dot_all = true;
+        break;
+      case 'x':
+        result.pcre_options |= PCRE_EXTENDED;
+        result.can_use_RE2 = false;
+        break;
+      case 'A':
+        result.pcre_options |= PCRE_ANCHORED;
+        result.can_use_RE2 = false;
+        break;
+      case 'D':
+        result.pcre_options |= PCRE_DOLLAR_ENDONLY;
+        result.can_use_RE2 = false;
+        break;
+      case 'S':
+        result.study = true;
+        break;
+      case 'U':
+        result.pcre_options |= PCRE_UNGREEDY;
+        // supported by RE2::Regexp but there is no such an option
+        result.can_use_RE2 = false;
+        break;
+      case 'X':
+        result.pcre_options |= PCRE_EXTRA;
+        break;
+      case 'u':
+        result.pcre_options |= PCRE_UTF8;
+#ifdef PCRE_UCP
+        result.pcre_options |= PCRE_UCP;
+#endif
+        result.is_utf8 = true;
+        break;
+      default:
+        result.unknown_modifier = pattern[i];
+        return RegexpPatternError::unknown_modifier;
+    }
+  }
+
+  if (result.is_utf8 && !is_valid_utf8(result.body, result.body_len)) {
+    return RegexpPatternError::not_utf8;
+  }
+  return RegexpPatternError::no_error;
+}
+
+} // namespace vk
@@ -0,0 +1,53 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstdint>
+
+namespace vk {
+
+// how a pattern is executed, for the constant patterns it is chosen by the compiler
+enum class RegexpEngine {
+  auto_detect,
+  RE2,
+  // RE2 can't skip empty matches the way PCRE does, so PCRE is used for retries after them
+  RE2_with_PCRE,
+  PCRE
+};
+
+const char *regexp_engine_name(RegexpEngine engine) noexcept;
+
+enum class RegexpPatternError {
+  no_error,
+  empty,
+  wrong_start_delimiter,
+  no_end_delimiter,
+  unknown_modifier,
+  not_utf8
+};
+
+// PHP pattern split into the regexp itself and its modifiers
+struct RegexpPattern {
+  // the regexp between the delimiters, it points into the parsed pattern
+  const char *body{nullptr};
+  int64_t body_len{0};
+  char end_delimiter{0};
+  char unknown_modifier{0};
+
+  int32_t pcre_options{0};
+  bool is_utf8{false};
+  bool caseless{false};
+  bool dot_all{false};
+  // the 'S' modifier is accepted, but it does nothing
+  bool study{false};
+  // some modifiers aren't supported by RE2
+  bool can_use_RE2{true};
+};
+
+// parses the delimiters and the modifiers of the pattern and validates the UTF-8 regexps;
+// it is shared between the compiler (for constant patterns) and the runtime
+RegexpPatternError parse_regexp_pattern(const char *pattern, int64_t pattern_len, RegexpPattern &result) noexcept;
+
+} // namespace vk
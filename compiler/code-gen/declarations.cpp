@@ -463,6 +463,11 @@ void ClassDeclaration::compile(CodeGenerator &W) const {
     W << *tl_dep_usings << NL;
   }
 
+  if (klass->is_immutable) {
+    // instance_cache_fetch relies on this tag to return the cached instances without copying
+    W << "using immutable_class_tag = " << klass->src_name << ";" << NL;
+  }
+
   klass->members.for_each([&](const ClassMemberInstanceField &f) {
     W << TypeName(tinf::get_type(f.var)) << " $" << f.local_name() << "{";
     if (f.var->init_val) {
@@ -538,7 +543,8 @@ void ClassDeclaration::compile_accept_visitor(CodeGenerator &W, ClassPtr klass,
 void ClassDeclaration::compile_accept_visitor_methods(CodeGenerator &W, ClassPtr klass) {
   if (!klass->need_instance_to_array_visitor &&
       !klass->need_instance_cache_visitors &&
-      !klass->need_instance_memory_estimate_visitor) {
+      !klass->need_instance_memory_estimate_visitor &&
+      !klass->need_instance_json_visitors) {
     return;
   }
 
@@ -568,6 +574,43 @@ void ClassDeclaration::compile_accept_visitor_methods(CodeGenerator &W, ClassPtr
     compile_accept_visitor(W, klass, "DeepMoveFromScriptToCacheVisitor");
     compile_accept_visitor(W, klass, "DeepDestroyFromCacheVisitor");
   }
+
+  if (klass->need_instance_json_visitors) {
+    W << NL;
+    compile_accept_visitor(W, klass, "InstanceToJsonVisitor");
+    compile_accept_json_field_visitor(W, klass);
+  }
+}
+
+void ClassDeclaration::compile_accept_json_field_visitor(CodeGenerator &W, ClassPtr klass) {
+  //void accept_json_field(InstanceFromJsonVisitor &visitor) {
+  //  switch (visitor.get_key_hash()) {
+  //    case hash_x: visitor("x", $x); break;
+  //    case hash_y: visitor("y", $y); visitor("y_with_same_hash", $y_with_same_hash); break;
+  //  }
+  //}
+  // the json key is matched only with the fields which names have the same hash, like the string switch does
+  std::map<int64_t, std::vector<std::string>> fields_by_hash;
+  for (auto cur_klass = klass; cur_klass; cur_klass = cur_klass->parent_class) {
+    cur_klass->members.for_each([&fields_by_hash](const ClassMemberInstanceField &f) {
+      const std::string name{f.local_name()};
+      fields_by_hash[string_hash(name.c_str(), name.size())].emplace_back(name);
+    });
+  }
+
+  FunctionSignatureGenerator(W) << "void accept_json_field(InstanceFromJsonVisitor &visitor) " << BEGIN
+                                << "switch (visitor.get_key_hash()) " << BEGIN;
+  for (const auto &hash_and_fields : fields_by_hash) {
+    W << "case " << std::to_string(static_cast<long long>(hash_and_fields.first)) << ":" << NL;
+    for (const auto &name : hash_and_fields.second) {
+      W << "visitor(\"" << name << "\", $" << name << ");" << NL;
+    }
+    W << "break;" << NL;
+  }
+  W << END << NL
+    << END << NL << NL;
+
+  compile_class_method(FunctionSignatureGenerator(W), klass, "void accept(InstanceFromJsonVisitor &visitor)", "accept_json_field(visitor)");
 }
 
 void ClassDeclaration::compile_serialization_methods(CodeGenerator &W, ClassPtr klass) {
@@ -120,6 +120,7 @@ private:
   static void compile_class_method(FunctionSignatureGenerator &&W, ClassPtr klass, vk::string_view method_signature, const ReturnValueT &return_value);
 
   static void compile_accept_visitor(CodeGenerator &W, ClassPtr klass, const char *visitor_type);
+  static void compile_accept_json_field_visitor(CodeGenerator &W, ClassPtr klass);
   IncludesCollector compile_front_includes(CodeGenerator &W) const;
   void compile_back_includes(CodeGenerator &W, IncludesCollector &&front_includes) const;
   void declare_all_variables(VertexPtr v, CodeGenerator &W) const;
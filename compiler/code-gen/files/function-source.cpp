@@ -6,6 +6,7 @@
 
 #include "compiler/code-gen/common.h"
 #include "compiler/code-gen/declarations.h"
+#include "compiler/code-gen/files/vars-reset.h"
 #include "compiler/code-gen/includes.h"
 #include "compiler/code-gen/namespace.h"
 #include "compiler/code-gen/naming.h"
@@ -20,6 +21,7 @@ void declare_global_vars(FunctionPtr function, CodeGenerator &W) {
   for (auto global_var : function->global_var_ids) {
     W << VarExternDeclaration(global_var) << NL;
   }
+  GlobalVarsReset::declare_touched_flags(function, W);
 }
 
 void declare_const_vars(FunctionPtr function, CodeGenerator &W) {
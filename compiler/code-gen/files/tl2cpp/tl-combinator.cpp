@@ -19,6 +19,53 @@ inline std::vector<std::string> get_not_optional_fields_masks(const vk::tl::comb
   return res;
 }
 
+// Int, Long, Double and # args, which are fetched without magic, have the fixed size (in ints)
+static int get_fixed_fetch_size(const std::unique_ptr<vk::tl::arg> &arg) {
+  if (arg->is_optional() || arg->is_fields_mask_optional() || arg->is_forwarded_function()) {
+    return 0;
+  }
+  auto *type_expr = arg->type_expr->as<vk::tl::type_expr>();
+  if (!type_expr || !type_expr->children.empty() || is_magic_processing_needed(type_expr)) {
+    return 0;
+  }
+  const auto *type = type_of(type_expr);
+  if (!type) {
+    return 0;
+  }
+  if (type->is_integer_variable() || type->id == TL_INT) {
+    return 1;
+  }
+  if (type->id == TL_LONG || type->id == TL_DOUBLE) {
+    return 2;
+  }
+  return 0;
+}
+
+// The consecutive args of the fixed size are fetched after a single bounds check of the whole block
+FixedFetchBlock get_fixed_fetch_block(const vk::tl::combinator *combinator, const vk::tl::arg *target) {
+  std::vector<const vk::tl::arg *> block;
+  int x4_bytes_length = 0;
+  for (size_t i = 0; i <= combinator->args.size(); ++i) {
+    if (i < combinator->args.size()) {
+      const auto &arg = combinator->args[i];
+      if (arg->is_optional()) {
+        continue;
+      }
+      if (int size = get_fixed_fetch_size(arg)) {
+        block.emplace_back(arg.get());
+        x4_bytes_length += size;
+        continue;
+      }
+    }
+    if (block.size() > 1 && std::find(block.begin(), block.end(), target) != block.end()) {
+      return FixedFetchBlock{target == block.front(), target == block.back(), x4_bytes_length};
+    }
+    block.clear();
+    x4_bytes_length = 0;
+  }
+  return FixedFetchBlock{};
+}
+
 CombinatorGen::CombinatorGen(const vk::tl::combinator *combinator, CombinatorPart part, bool typed_mode) :
   combinator(combinator),
   part(part),
@@ -186,12 +233,16 @@ void CombinatorFetch::gen_before_args_processing(CodeGenerator &W) const {
 };
 
 void CombinatorFetch::gen_arg_processing(CodeGenerator &W, const std::unique_ptr<vk::tl::arg> &arg) const {
+  const auto fixed_block = get_fixed_fetch_block(combinator, arg.get());
+  if (fixed_block.is_first) {
+    W << fmt_format("if (rpc_check_fetch_len({})) ", fixed_block.x4_bytes_length) << BEGIN;
+  }
   if (arg->is_fields_mask_optional()) {
     W << fmt_format("if ({}{} & (1 << {})) ", var_num_access,
                     combinator->get_var_num_arg(arg->exist_var_num)->name,
                     arg->exist_var_bit) << BEGIN;
   }
-  W << tl2cpp::TypeExprFetch(arg, var_num_access, typed_mode);
+  W << tl2cpp::TypeExprFetch(arg, var_num_access, typed_mode, fixed_block.x4_bytes_length > 0);
   if (arg->var_num != -1 && tl2cpp::type_of(arg->type_expr)->is_integer_variable()) {
     // save the field mask for the future use
     if (!typed_mode) {
@@ -205,6 +256,9 @@ void CombinatorFetch::gen_arg_processing(CodeGenerator &W, const std::unique_ptr
   if (arg->is_fields_mask_optional()) {
     W << END << NL;
   }
+  if (fixed_block.is_last) {
+    W << END << NL;
+  }
 }
 
 void CombinatorFetch::gen_after_args_processing(CodeGenerator &W) const {
@@ -14,6 +14,15 @@ enum class CombinatorPart {
 
 std::vector<std::string> get_not_optional_fields_masks(const vk::tl::combinator *constructor);
 
+struct FixedFetchBlock {
+  bool is_first{false};
+  bool is_last{false};
+  int x4_bytes_length{0};
+};
+
+// the fixed size block of the combinator args, which the target arg belongs to (blocks of a single arg are ignored)
+FixedFetchBlock get_fixed_fetch_block(const vk::tl::combinator *combinator, const vk::tl::arg *target);
+
 struct CombinatorGen {
   const vk::tl::combinator *combinator;
   CombinatorPart part;
@@ -96,12 +105,21 @@ private:
       }
       return result;
     }
- * 2) Exclamation mark handling (! modifier):
+ * 2) Fixed size args handling, the consecutive Int, Long, Double and # args are fetched after a single bounds check:
+    array<mixed> c_hints_objectExt::fetch(int fields_mask) {
+      array<mixed> result;
+      if (rpc_check_fetch_len(2)) {
+        result.set_value(tl_str$type, t_Int().fetch_unchecked(), -445613708);
+        result.set_value(tl_str$object_id, t_Int().fetch_unchecked(), 65801733);
+      }
+      ...
+    }
+ * 3) Exclamation mark handling (! modifier):
     var f_rpcProxy_diagonalTargets::fetch() {
       fetch_magic_if_not_bare(0x1cb5c415, "Incorrect magic in result of function: rpcProxy.diagonalTargets");
       return t_Vector<t_Vector<t_Maybe<tl_exclamation_fetch_wrapper, 0>, 0>, 0>(t_Vector<t_Maybe<tl_exclamation_fetch_wrapper, 0>, 0>(t_Maybe<tl_exclamation_fetch_wrapper, 0>(std::move(X)))).fetch();
     }
- * 3) Handling of the main part of the type expression in TypeExprStore/Fetch
+ * 4) Handling of the main part of the type expression in TypeExprStore/Fetch
 */
 struct CombinatorFetch : CombinatorGen {
   CombinatorFetch(const vk::tl::combinator *combinator, CombinatorPart part, bool typed_mode) :
@@ -102,10 +102,11 @@ void TypeExprFetch::compile(CodeGenerator &W) const {
   }
   if (!typed_mode) {
     W << "result.set_value(" << register_tl_const_str(arg->name) << ", "
-      << get_full_value(arg->type_expr.get(), var_num_access) << ".fetch(), "
+      << get_full_value(arg->type_expr.get(), var_num_access) << (is_len_checked ? ".fetch_unchecked(), " : ".fetch(), ")
       << hash_tl_const_str(arg->name) << "L);" << NL;
   } else {
-    W << get_full_value(arg->type_expr.get(), var_num_access) + ".typed_fetch_to(" << get_tl_object_field_access(arg, field_rw_type::WRITE) << ");" << NL;
+    W << get_full_value(arg->type_expr.get(), var_num_access) + (is_len_checked ? ".typed_fetch_unchecked_to(" : ".typed_fetch_to(")
+      << get_tl_object_field_access(arg, field_rw_type::WRITE) << ");" << NL;
   }
 }
 }
@@ -40,11 +40,14 @@ struct TypeExprFetch {
   const std::unique_ptr<vk::tl::arg> &arg;
   std::string var_num_access;
   bool typed_mode;
+  // the data length is already checked for the whole fixed size block of args
+  bool is_len_checked;
 
-  explicit inline TypeExprFetch(const std::unique_ptr<vk::tl::arg> &arg, std::string var_num_access, bool typed_mode = false) :
+  explicit inline TypeExprFetch(const std::unique_ptr<vk::tl::arg> &arg, std::string var_num_access, bool typed_mode = false, bool is_len_checked = false) :
     arg(arg),
     var_num_access(std::move(var_num_access)),
-    typed_mode(typed_mode) {}
+    typed_mode(typed_mode),
+    is_len_checked(is_len_checked) {}
 
   void compile(CodeGenerator &W) const;
 };
@@ -30,8 +30,12 @@ struct InitVar {
       kphp_assert(location.function && location.file);
       W << VarName(var) << ".init (" << var->init_val << ", "
         << RawString(location.function->name) << ", "
-        << RawString(location.file->unified_file_name + ':' + std::to_string(location.line))
-        << ");" << NL;
+        << RawString(location.file->unified_file_name + ':' + std::to_string(location.line));
+      const auto engine = init_val.as<op_conv_regexp>()->engine;
+      if (engine != vk::RegexpEngine::auto_detect) {
+        W << ", RegexpEngine::" << vk::regexp_engine_name(engine);
+      }
+      W << ");" << NL;
     } else {
       W << VarName(var) << " = " << var->init_val << ";" << NL;
     }
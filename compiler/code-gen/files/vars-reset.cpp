@@ -4,20 +4,84 @@
 
 #include "compiler/code-gen/files/vars-reset.h"
 
+#include "common/algorithms/hashes.h"
+
 #include "compiler/code-gen/common.h"
 #include "compiler/code-gen/declarations.h"
 #include "compiler/code-gen/includes.h"
 #include "compiler/code-gen/namespace.h"
 #include "compiler/code-gen/vertex-compiler.h"
+#include "compiler/compiler-core.h"
 #include "compiler/data/class-data.h"
+#include "compiler/data/function-data.h"
+#include "compiler/data/lib-data.h"
 #include "compiler/data/src-file.h"
+#include "compiler/data/var-data.h"
 #include "compiler/data/vars-collector.h"
 #include "compiler/vertex.h"
 
+// the files are hashed into the flags: a collision only makes some vars be reset when they are not touched,
+// but the flag of a file doesn't depend on the other files, so adding a file doesn't change the generated code of others
+static constexpr size_t TOUCHED_FLAGS_COUNT = 4096;
+// checking too many flags is not cheaper than resetting vars unconditionally
+static constexpr size_t MAX_CHECKED_TOUCHED_FLAGS = 8;
+
 GlobalVarsReset::GlobalVarsReset(SrcFilePtr main_file) :
   main_file_(main_file) {
 }
 
+bool GlobalVarsReset::is_touched_tracking_enabled() {
+  if (G->settings().full_global_vars_reset.get() || G->settings().is_static_lib_mode()) {
+    return false;
+  }
+  // vars of the libs are reset by the libs themselves entirely
+  for (LibPtr lib : G->get_libs()) {
+    if (lib && !lib->is_raw_php()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GlobalVarsReset::does_touch_vars(FunctionPtr func) {
+  return (!func->global_var_ids.empty() || !func->static_var_ids.empty()) && is_touched_tracking_enabled();
+}
+
+size_t GlobalVarsReset::get_touched_flag(FunctionPtr func) {
+  const size_t hash = func->file_id ? vk::std_hash(func->file_id->unified_file_name) : vk::std_hash(func->name);
+  return hash % TOUCHED_FLAGS_COUNT;
+}
+
+void GlobalVarsReset::declare_touched_flags(FunctionPtr func, CodeGenerator &W) {
+  if (does_touch_vars(func)) {
+    W << "extern bool global_vars_touched[];" << NL;
+  }
+}
+
+void GlobalVarsReset::compile_mark_touched(FunctionPtr func, CodeGenerator &W) {
+  if (does_touch_vars(func)) {
+    W << "global_vars_touched[" << std::to_string(get_touched_flag(func)) << "] = true;" << NL;
+  }
+}
+
+void GlobalVarsReset::collect_touched_flags(FunctionPtr func, std::unordered_set<FunctionPtr> &visited, GlobalVarsTouchedFlags &touched_flags) {
+  if (!visited.emplace(func).second) {
+    return;
+  }
+
+  for (auto dep_function : func->dep) {
+    collect_touched_flags(dep_function, visited, touched_flags);
+  }
+
+  const size_t flag = get_touched_flag(func);
+  for (auto var : func->global_var_ids) {
+    touched_flags[var].emplace(flag);
+  }
+  for (auto var : func->static_var_ids) {
+    touched_flags[var].emplace(flag);
+  }
+}
+
 void GlobalVarsReset::declare_extern_for_init_val(VertexPtr v, std::set<VarPtr> &externed_vars, CodeGenerator &W) {
   if (auto var_vertex = v.try_as<op_var>()) {
     VarPtr var = var_vertex->var_id;
@@ -31,7 +95,19 @@ void GlobalVarsReset::declare_extern_for_init_val(VertexPtr v, std::set<VarPtr>
   }
 }
 
-void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &used_vars, int part_i, CodeGenerator &W) {
+void GlobalVarsReset::compile_reset_var(VarPtr var, CodeGenerator &W) {
+  W << "hard_reset_var(" << VarName(var);
+  //FIXME: brk and comments
+  if (var->init_val) {
+    W << UnlockComments();
+    W << ", " << var->init_val;
+    W << LockComments();
+  }
+  W << ");" << NL;
+}
+
+void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &used_vars, const GlobalVarsTouchedFlags &touched_flags,
+                                   int part_i, CodeGenerator &W) {
   IncludesCollector includes;
   for (auto var : used_vars) {
     includes.add_var_signature_depends(var);
@@ -47,20 +123,37 @@ void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &use
     }
   }
 
-  FunctionSignatureGenerator(W) << "void " << GlobalVarsResetFuncName(func, part_i) << " " << BEGIN;
+  std::vector<VarPtr> always_reset_vars;
+  std::map<std::set<size_t>, std::vector<VarPtr>> vars_by_touched_flags;
   for (auto var : used_vars) {
     if (G->settings().is_static_lib_mode() && var->is_builtin_global()) {
       continue;
     }
+    auto var_flags = touched_flags.find(var);
+    // builtin globals are also written by the runtime, so they are reset every time
+    if (var->is_builtin_global() || var_flags == touched_flags.end() || var_flags->second.size() > MAX_CHECKED_TOUCHED_FLAGS) {
+      always_reset_vars.emplace_back(var);
+    } else {
+      vars_by_touched_flags[var_flags->second].emplace_back(var);
+    }
+  }
 
-    W << "hard_reset_var(" << VarName(var);
-    //FIXME: brk and comments
-    if (var->init_val) {
-      W << UnlockComments();
-      W << ", " << var->init_val;
-      W << LockComments();
+  if (!vars_by_touched_flags.empty()) {
+    W << "extern bool global_vars_touched[];" << NL << NL;
+  }
+
+  FunctionSignatureGenerator(W) << "void " << GlobalVarsResetFuncName(func, part_i) << " " << BEGIN;
+  for (auto var : always_reset_vars) {
+    compile_reset_var(var, W);
+  }
+  for (const auto &flags_and_vars : vars_by_touched_flags) {
+    W << "if (" << JoinValues(flags_and_vars.first, " || ", join_mode::one_line,
+                              [](CodeGenerator &W, size_t flag) { W << "global_vars_touched[" << std::to_string(flag) << "]"; })
+      << ") " << BEGIN;
+    for (auto var : flags_and_vars.second) {
+      compile_reset_var(var, W);
     }
-    W << ");" << NL;
+    W << END << NL;
   }
 
   W << END;
@@ -70,13 +163,29 @@ void GlobalVarsReset::compile_part(FunctionPtr func, const std::set<VarPtr> &use
 
 void GlobalVarsReset::compile_func(FunctionPtr func, int parts_n, CodeGenerator &W) {
   W << OpenNamespace();
+  const bool tracking_enabled = is_touched_tracking_enabled();
+  if (tracking_enabled) {
+    // all vars are reset for the first time
+    W << "bool global_vars_touched[" << std::to_string(TOUCHED_FLAGS_COUNT) << "];" << NL;
+    W << "static bool global_vars_first_reset = true;" << NL << NL;
+  }
+
   FunctionSignatureGenerator(W) << "void " << GlobalVarsResetFuncName(func) << " " << BEGIN;
+  if (tracking_enabled) {
+    W << "if (global_vars_first_reset) " << BEGIN
+      << "memset(global_vars_touched, true, sizeof(global_vars_touched));" << NL
+      << "global_vars_first_reset = false;" << NL
+      << END << NL;
+  }
 
   for (int i = 0; i < parts_n; i++) {
     W << "void " << GlobalVarsResetFuncName(func, i) << ";" << NL;
     W << GlobalVarsResetFuncName(func, i) << ";" << NL;
   }
 
+  if (tracking_enabled) {
+    W << "memset(global_vars_touched, false, sizeof(global_vars_touched));" << NL;
+  }
   W << END;
   W << NL;
   W << CloseNamespace();
@@ -89,6 +198,12 @@ void GlobalVarsReset::compile(CodeGenerator &W) const {
   vars_collector.collect_global_and_static_vars_from(main_func);
   auto used_vars = vars_collector.flush();
 
+  GlobalVarsTouchedFlags touched_flags;
+  if (is_touched_tracking_enabled()) {
+    std::unordered_set<FunctionPtr> visited;
+    collect_touched_flags(main_func, visited, touched_flags);
+  }
+
   static const std::string vars_reset_src_prefix = "vars_reset.";
   std::vector<std::string> src_names(used_vars.size());
   for (int i = 0; i < used_vars.size(); i++) {
@@ -98,7 +213,7 @@ void GlobalVarsReset::compile(CodeGenerator &W) const {
   for (int i = 0; i < used_vars.size(); i++) {
     W << OpenFile(src_names[i], "o_vars_reset", false);
     W << ExternInclude("runtime-headers.h");
-    compile_part(main_func, used_vars[i], i, W);
+    compile_part(main_func, used_vars[i], touched_flags, i, W);
     W << CloseFile();
   }
 
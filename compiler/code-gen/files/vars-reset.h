@@ -4,21 +4,39 @@
 
 #pragma once
 
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "compiler/code-gen/code-generator.h"
 #include "compiler/data/data_ptr.h"
 #include "compiler/data/vertex-adaptor.h"
 
+// Functions, which use global or static vars, mark the flag of their file as touched on entry;
+// between requests only the vars used by the functions of the touched files are reset
+using GlobalVarsTouchedFlags = std::unordered_map<VarPtr, std::set<size_t>>;
+
 struct GlobalVarsReset {
   GlobalVarsReset(SrcFilePtr main_file);
 
   void compile(CodeGenerator &W) const;
 
-  static void compile_part(FunctionPtr func, const std::set<VarPtr> &used_vars, int part_i, CodeGenerator &W);
+  static void compile_part(FunctionPtr func, const std::set<VarPtr> &used_vars, const GlobalVarsTouchedFlags &touched_flags,
+                           int part_i, CodeGenerator &W);
 
   static void compile_func(FunctionPtr func, int parts_n, CodeGenerator &W);
 
   static void declare_extern_for_init_val(VertexPtr v, std::set<VarPtr> &externed_vars, CodeGenerator &W);
 
+  static bool is_touched_tracking_enabled();
+  static bool does_touch_vars(FunctionPtr func);
+  static void declare_touched_flags(FunctionPtr func, CodeGenerator &W);
+  static void compile_mark_touched(FunctionPtr func, CodeGenerator &W);
+
 private:
+  static size_t get_touched_flag(FunctionPtr func);
+  static void collect_touched_flags(FunctionPtr func, std::unordered_set<FunctionPtr> &visited, GlobalVarsTouchedFlags &touched_flags);
+  static void compile_reset_var(VarPtr var, CodeGenerator &W);
+
   SrcFilePtr main_file_;
 };
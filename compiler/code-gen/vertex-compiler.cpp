@@ -11,6 +11,7 @@
 
 #include "compiler/code-gen/common.h"
 #include "compiler/code-gen/declarations.h"
+#include "compiler/code-gen/files/vars-reset.h"
 #include "compiler/code-gen/naming.h"
 #include "compiler/code-gen/raw-data.h"
 #include "compiler/data/class-data.h"
@@ -982,6 +983,7 @@ void compile_function_resumable(VertexAdaptor<op_function> func_root, CodeGenera
   //CALL FUNCTION
   W << FunctionDeclaration(func, false) << " " <<
     BEGIN;
+  GlobalVarsReset::compile_mark_touched(func, W);
   W << "return start_resumable < " << FunctionClassName(func) << "::ReturnT >" <<
     "(new " << FunctionClassName(func) << "(";
 
@@ -994,6 +996,7 @@ void compile_function_resumable(VertexAdaptor<op_function> func_root, CodeGenera
   //FORK FUNCTION
   W << FunctionForkDeclaration(func, false) << " " <<
     BEGIN;
+  GlobalVarsReset::compile_mark_touched(func, W);
   W << "return fork_resumable < " << FunctionClassName(func) << "::ReturnT >" <<
     "(new " << FunctionClassName(func) << "(";
   W << JoinValues(func->param_ids, ", ", join_mode::one_line, var_name_gen);
@@ -1016,6 +1019,7 @@ void compile_function(VertexAdaptor<op_function> func_root, CodeGenerator &W) {
   W << FunctionDeclaration(func, false) << " " << BEGIN;
 
   compile_tracing_profiler(func, W);
+  GlobalVarsReset::compile_mark_touched(func, W);
 
   for (auto var : func->local_var_ids) {
     if (var->type() != VarData::var_local_inplace_t && !var->is_foreach_reference) {
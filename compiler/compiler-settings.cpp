@@ -305,6 +305,9 @@ void CompilerSettings::init() {
   tl_classname_prefix.value_ = "C$VK$TL$";
 
   option_as_dir(composer_root);
+  if (!objs_cache_dir.get().empty()) {
+    option_as_dir(objs_cache_dir);
+  }
 }
 
 std::string CompilerSettings::read_runtime_sha256_file(const std::string &filename) {
@@ -110,10 +110,12 @@ public:
   KphpOption<bool> composer_no_dev;
 
   KphpOption<bool> force_make;
+  KphpOption<std::string> objs_cache_dir;
   KphpOption<bool> no_make;
   KphpOption<uint64_t> jobs_count;
   KphpOption<uint64_t> threads_count;
   KphpOption<uint64_t> globals_split_count;
+  KphpOption<bool> full_global_vars_reset;
 
   KphpOption<bool> require_functions_typing;
   KphpOption<bool> require_class_typing;
@@ -26,6 +26,7 @@ prepend(KPHP_COMPILER_SCHEDULER_SOURCES scheduler/
         scheduler.cpp)
 
 prepend(KPHP_COMPILER_MAKE_SOURCES make/
+        cpp-to-obj-target.cpp
         hardlink-or-copy.cpp
         make-runner.cpp
         make.cpp
@@ -108,6 +109,7 @@ prepend(KPHP_COMPILER_PIPES_SOURCES pipes/
         check-abstract-function-defaults.cpp
         check-access-modifiers.cpp
         check-classes.cpp
+        check-const-regexps.cpp
         check-conversions.cpp
         check-function-calls.cpp
         check-modifications-of-const-vars.cpp
@@ -207,7 +209,7 @@ set_property(SOURCE ${KPHP_COMPILER_DIR}/kphp2cpp.cpp
 
 add_executable(kphp2cpp ${KPHP_COMPILER_DIR}/kphp2cpp.cpp)
 target_include_directories(kphp2cpp PUBLIC ${KPHP_COMPILER_DIR})
-set(COMPILER_LIBS vk::kphp2cpp_src vk::tlo_parsing_src vk::popular_common -l:libyaml-cpp.a fmt::fmt -l:libre2.a crypto pthread)
+set(COMPILER_LIBS vk::kphp2cpp_src vk::tlo_parsing_src vk::popular_common -l:libyaml-cpp.a fmt::fmt -l:libre2.a -l:libpcre.a crypto pthread)
 target_link_libraries(kphp2cpp PRIVATE ${COMPILER_LIBS})
 target_link_options(kphp2cpp PRIVATE ${NO_PIE})
 set_target_properties(kphp2cpp PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${BIN_DIR})
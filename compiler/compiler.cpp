@@ -41,6 +41,7 @@
 #include "compiler/pipes/check-abstract-function-defaults.h"
 #include "compiler/pipes/check-access-modifiers.h"
 #include "compiler/pipes/check-classes.h"
+#include "compiler/pipes/check-const-regexps.h"
 #include "compiler/pipes/check-conversions.h"
 #include "compiler/pipes/check-function-calls.h"
 #include "compiler/pipes/check-modifications-of-const-vars.h"
@@ -250,6 +251,7 @@ bool compiler_execute(CompilerSettings *settings) {
     >> PassC<RemoveEmptyFunctionCalls>{}
     >> PassC<PreprocessBreakPass>{}
     >> PassC<CalcConstTypePass>{}
+    >> PassC<CheckConstRegexpsPass>{}
     >> PassC<CollectConstVarsPass>{}
     >> PassC<ConvertListAssignmentsPass>{}
     >> PassC<RegisterVariablesPass>{}
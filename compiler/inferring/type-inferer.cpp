@@ -6,12 +6,15 @@
 
 #include "compiler/compiler-core.h"
 #include "compiler/inferring/edge.h"
+#include "compiler/scheduler/scheduler-base.h"
 #include "compiler/threading/profiler.h"
 
 namespace tinf {
 
 TypeInferer::TypeInferer() :
-  finish_flag(false) {
+  finish_flag(false),
+  tasks_count_(0),
+  max_tasks_count_(1) {
 }
 
 void TypeInferer::recalc_node(Node *node) {
@@ -72,12 +75,23 @@ public:
     stage::set_name("Infer types");
     stage::set_function(FunctionPtr());
     inferer_->run_queue(&queue_);
+    inferer_->on_task_finished();
   }
 };
 
 CachedProfiler TypeInfererTask::type_inferer_profiler{"Type Inferring"};
 
+Task *TypeInferer::create_task(NodeQueue &&queue) {
+  __sync_fetch_and_add(&tasks_count_, 1);
+  return new TypeInfererTask(this, std::move(queue));
+}
+
+void TypeInferer::on_task_finished() {
+  __sync_fetch_and_sub(&tasks_count_, 1);
+}
+
 std::vector<Task *> TypeInferer::get_tasks() {
+  max_tasks_count_ = static_cast<int>(G->settings().threads_count.get());
   std::vector<Task *> res;
   for (int i = 0; i < Q.size(); i++) {
     NodeQueue q = std::move(Q.get(i));
@@ -85,16 +99,37 @@ std::vector<Task *> TypeInferer::get_tasks() {
       continue;
     }
 
-    res.push_back(new TypeInfererTask(this, std::move(q)));
+    res.push_back(create_task(std::move(q)));
   }
   return res;
 }
 
-int TypeInferer::do_run_queue() {
+// the recalc of a node pushes its dependants to the queue of the current thread,
+// so all the nodes reachable from a queue are inferred by one thread, unless the queue is shared:
+// when some threads are idle, the half of the queue is passed to them as a new task
+void TypeInferer::try_share_queue(NodeQueue &q) {
+  static constexpr size_t MIN_SHARED_QUEUE_SIZE = 64;
+  if (q.size() < MIN_SHARED_QUEUE_SIZE || tasks_count_ >= max_tasks_count_) {
+    return;
+  }
+
+  NodeQueue shared;
+  for (size_t i = q.size() / 2; i > 0; --i) {
+    // the nodes are already owned by the queue (see Node::try_start_recalc), the ownership is passed with them
+    shared.push(q.front());
+    q.pop();
+  }
+  register_async_task(create_task(std::move(shared)));
+}
+
+int TypeInferer::do_run_queue(bool allow_sharing) {
   NodeQueue &q = *Q;
 
   int cnt = 0;
   while (!q.empty()) {
+    if (allow_sharing) {
+      try_share_queue(q);
+    }
     cnt++;
     Node *node = q.front();
 
@@ -111,12 +146,14 @@ int TypeInferer::do_run_queue() {
 
 int TypeInferer::run_queue(NodeQueue *new_q) {
   *Q = std::move(*new_q);
-  return do_run_queue();
+  return do_run_queue(true);
 }
 
 void TypeInferer::run_node(Node *node) {
+  // the queue isn't shared here: the current thread waits for the node,
+  // and the shared task may be not started until the current task is finished
   if (add_node(node)) {
-    do_run_queue();
+    do_run_queue(false);
   }
   while (node->get_recalc_cnt() == 0) {
     usleep(250);
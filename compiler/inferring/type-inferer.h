@@ -19,6 +19,9 @@ class TypeInferer {
 private:
   TLS<std::vector<RestrictionBase *>> restrictions;
   bool finish_flag;
+  // the queues are split between the tasks while there are less of them than the threads
+  volatile int tasks_count_;
+  int max_tasks_count_;
 
 public:
   TLS<NodeQueue> Q;
@@ -36,6 +39,7 @@ public:
 
   int run_queue(NodeQueue *q);
   std::vector<Task *> get_tasks();
+  void on_task_finished();
 
   void run_node(Node *node);
 
@@ -43,7 +47,9 @@ public:
   bool is_finished();
 
 private:
-  int do_run_queue();
+  Task *create_task(NodeQueue &&queue);
+  void try_share_queue(NodeQueue &q);
+  int do_run_queue(bool allow_sharing);
 };
 
 } // namespace tinf
@@ -230,6 +230,8 @@ int main(int argc, char *argv[]) {
              'O', "output-lib-dir", "KPHP_OUT_LIB_DIR");
   parser.add("Force make. Old object files and binary will be removed", settings->force_make,
              'F', "force-make", "KPHP_FORCE_MAKE");
+  parser.add("Directory for caching object files, they are reused by compilations with the same C++ sources", settings->objs_cache_dir,
+             "objs-cache-dir", "KPHP_OBJS_CACHE_DIR");
   parser.add("Code generation only, without making an output binary", settings->no_make,
              "no-make", "KPHP_NO_MAKE");
   parser.add("Processes number for the compilation", settings->jobs_count,
@@ -238,6 +240,8 @@ int main(int argc, char *argv[]) {
              't', "threads-count", "KPHP_THREADS_COUNT", std::to_string(get_default_threads_count()));
   parser.add("Count of global variables per dedicated .cpp file. Lowering it could decrease compilation time", settings->globals_split_count,
              "globals-split-count", "KPHP_GLOBALS_SPLIT_COUNT", "1024");
+  parser.add("Reset all global and static variables between requests, not only the ones of the touched files", settings->full_global_vars_reset,
+             "full-global-vars-reset", "KPHP_FULL_GLOBAL_VARS_RESET");
   parser.add("Builtin tl schema. Incompatible with lib mode", settings->tl_schema_file,
              'T', "tl-schema", "KPHP_TL_SCHEMA");
   parser.add("Generate storers and fetchers for internal tl functions", settings->gen_tl_internals,
@@ -0,0 +1,45 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/make/cpp-to-obj-target.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compiler/make/hardlink-or-copy.h"
+
+bool Cpp2ObjTarget::try_restore_from_cache() {
+  if (cache_path_.empty() || access(cache_path_.c_str(), R_OK) != 0) {
+    return false;
+  }
+  hard_link_or_copy(cache_path_, get_file()->path);
+  // the cached object may be older than the sources, it is touched to be up to date for the next make
+  restored_from_cache_ = utimensat(AT_FDCWD, get_file()->path.c_str(), nullptr, 0) == 0;
+  return restored_from_cache_;
+}
+
+void Cpp2ObjTarget::before_run() {
+  restored_from_cache_ = false;
+  if (!cache_path_.empty()) {
+    // the object may be a hard link to the cached one, the compiler mustn't rewrite the cached object in place
+    get_file()->unlink();
+  }
+}
+
+bool Cpp2ObjTarget::after_run_success() {
+  if (!Target::after_run_success()) {
+    return false;
+  }
+  if (!cache_path_.empty() && !restored_from_cache_) {
+    // the object is placed under a temporary name and renamed, so the concurrent compilations never see a partial one
+    const std::string tmp_path = cache_path_ + "." + std::to_string(getpid());
+    hard_link_or_copy(get_file()->path, tmp_path);
+    if (rename(tmp_path.c_str(), cache_path_.c_str()) != 0) {
+      unlink(tmp_path.c_str());
+    }
+  }
+  return true;
+}
@@ -11,8 +11,22 @@
 #include "compiler/make/target.h"
 
 class Cpp2ObjTarget : public Target {
+private:
+  // the object file in the objs cache dir, it's reused by the compilations with the same C++ sources and flags
+  std::string cache_path_;
+  // the object is a hard link to the cached one (or its copy), so there is no need to store it back
+  bool restored_from_cache_{false};
+
 public:
-  string get_cmd() final {
+  void set_cache_path(std::string &&cache_path) {
+    cache_path_ = std::move(cache_path);
+  }
+
+  bool try_restore_from_cache() final;
+  void before_run() final;
+  bool after_run_success() final;
+
+  std::string get_cmd() final {
     std::stringstream ss;
     const auto cpp_list = dep_list();
     const char *cpp_type = vk::contains(cpp_list, ".h") ? "-x c++-header " : "";
@@ -23,6 +23,10 @@ void MakeRunner::run_target(Target *target) {
     }
   }
 
+  if (!ready && target->try_restore_from_cache()) {
+    ready = target->after_run_success();
+  }
+
   if (!ready) {
     target->compute_priority();
     pending_jobs.push(target);
@@ -114,6 +118,7 @@ static int run_cmd(const string &cmd) {
 
 bool MakeRunner::start_job(Target *target) {
   target->start_time = get_utime(CLOCK_MONOTONIC);
+  target->before_run();
   string cmd = target->get_cmd();
 
   int pid = run_cmd(cmd);
@@ -7,7 +7,10 @@
 #include <forward_list>
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "common/algorithms/hashes.h"
+#include "common/crc32.h"
 #include "common/wrappers/mkdir_recursive.h"
 
 #include "compiler/compiler-core.h"
@@ -72,8 +75,10 @@ public:
     return create_target(new FileTarget(), vector<Target *>(), cpp);
   }
 
-  Target *create_cpp2obj_target(File *cpp, File *obj) {
-    return create_target(new Cpp2ObjTarget(), to_targets(cpp), obj);
+  Target *create_cpp2obj_target(File *cpp, File *obj, std::string cache_path = {}) {
+    auto *target = new Cpp2ObjTarget();
+    target->set_cache_path(std::move(cache_path));
+    return create_target(target, to_targets(cpp), obj);
   }
 
   Target *create_objs2obj_target(vector<File *> objs, File *obj) {
@@ -272,15 +277,71 @@ static std::unordered_map<File *, long long> create_dep_mtime(const Index &cpp_d
   return dep_mtime;
 }
 
+// the cache key of an object file is made of the contents of its cpp file and all the headers included by it;
+// the cache dir is split by the runtime and the C++ flags like the precompiled headers dir
+static std::unordered_map<File *, std::string> create_objs_cache_paths(const Index &cpp_dir, const std::forward_list<Index> &imported_headers,
+                                                                       const CompilerSettings &settings) {
+  std::unordered_map<File *, std::string> cache_paths;
+  if (settings.objs_cache_dir.get().empty() || settings.force_make.get()) {
+    return cache_paths;
+  }
+
+  std::string cache_dir = settings.objs_cache_dir.get();
+  cache_dir.append(settings.runtime_sha256.get()).append(1, '/');
+  cache_dir.append(settings.cxx_flags_sha256.get()).append(1, '/');
+  const mode_t old_mask = umask(0);
+  const bool dir_created = mkdir_recursive(cache_dir.c_str(), 0777);
+  umask(old_mask);
+  kphp_error_act(dir_created,
+                 fmt_format("Can't create objs cache dir '{}': {}", cache_dir, strerror(errno)),
+                 return cache_paths);
+
+  const auto &files = cpp_dir.get_files();
+  auto lib_version_it = std::find_if(files.begin(), files.end(), [](File *file) { return file->name == "_lib_version.h"; });
+  kphp_assert(lib_version_it != files.end());
+
+  for (File *cpp_file : files) {
+    if (cpp_file->ext != ".cpp") {
+      continue;
+    }
+    std::vector<File *> deps{cpp_file, *lib_version_it};
+    std::unordered_set<File *> visited{deps.begin(), deps.end()};
+    for (size_t i = 0; i < deps.size(); ++i) {
+      for (const auto &include : deps[i]->includes) {
+        File *header = cpp_dir.get_file(include);
+        if (header && visited.insert(header).second) {
+          deps.push_back(header);
+        }
+      }
+    }
+    std::sort(deps.begin() + 2, deps.end(), [](File *a, File *b) { return a->name < b->name; });
+
+    std::string signature = fmt_format("{}\n", cpp_file->compile_with_debug_info_flag);
+    bool is_cacheable = true;
+    for (File *dep : deps) {
+      is_cacheable &= dep->crc64_with_comments != static_cast<unsigned long long>(-1);
+      fmt_format_to(std::back_inserter(signature), "{} {:x}\n", dep->name, dep->crc64_with_comments);
+      for (const auto &lib_include : dep->lib_includes) {
+        fmt_format_to(std::back_inserter(signature), "{} {}\n", lib_include, get_imported_header_mtime(lib_include, imported_headers));
+      }
+    }
+    if (is_cacheable) {
+      cache_paths[cpp_file] = fmt_format("{}{:016x}{:016x}.o", cache_dir, compute_crc64(signature.data(), signature.size()), vk::std_hash(signature));
+    }
+  }
+  return cache_paths;
+}
+
 static std::vector<File *> create_obj_files(MakeSetup *make, Index &obj_dir, const Index &cpp_dir,
-                                            const std::forward_list<Index> &imported_headers) {
+                                            const std::forward_list<Index> &imported_headers, const CompilerSettings &settings) {
   std::unordered_map<File *, long long> dep_mtime = create_dep_mtime(cpp_dir, imported_headers);
+  std::unordered_map<File *, std::string> cache_paths = create_objs_cache_paths(cpp_dir, imported_headers, settings);
   std::vector<File *> objs;
   for (const auto &cpp_file : cpp_dir.get_files()) {
     if (cpp_file->ext == ".cpp") {
       File *obj_file = obj_dir.insert_file(static_cast<std::string>(cpp_file->name_without_ext) + ".o");
       obj_file->compile_with_debug_info_flag = cpp_file->compile_with_debug_info_flag;
-      make->create_cpp2obj_target(cpp_file, obj_file);
+      make->create_cpp2obj_target(cpp_file, obj_file, std::move(cache_paths[cpp_file]));
       Target *cpp_target = cpp_file->target;
       cpp_target->force_changed(dep_mtime[cpp_file]);
       objs.push_back(obj_file);
@@ -329,7 +390,7 @@ static bool kphp_make(File &bin, Index &obj_dir, const Index &cpp_dir, std::forw
     make.create_cpp_target(&link_file);
     lib_objs.emplace_back(&link_file);
   }
-  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers);
+  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers, settings);
   std::copy(lib_objs.begin(), lib_objs.end(), std::back_inserter(objs));
   make.create_objs2bin_target(objs, &bin);
   make.init_env(settings);
@@ -343,7 +404,7 @@ static bool kphp_make_static_lib(File &static_lib, Index &obj_dir, const Index &
                                  const std::forward_list<Index> &imported_headers, const CompilerSettings &settings,
                                  const std::string &gch_dir, FILE *stats_file) {
   MakeSetup make{stats_file};
-  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers);
+  std::vector<File *> objs = create_obj_files(&make, obj_dir, cpp_dir, imported_headers, settings);
   make.create_objs2static_lib_target(objs, &static_lib);
   make.init_env(settings);
   if (!gch_dir.empty()) {
@@ -63,6 +63,13 @@ void Target::on_require() {
   file->needed = true;
 }
 
+bool Target::try_restore_from_cache() {
+  return false;
+}
+
+void Target::before_run() {
+}
+
 bool Target::after_run_success() {
   long long res = file->read_stat();
   if (res < 0) {
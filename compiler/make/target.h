@@ -42,7 +42,9 @@ public:
   std::string get_name();
 
   void on_require();
-  bool after_run_success() __attribute__ ((warn_unused_result));
+  virtual bool try_restore_from_cache() __attribute__ ((warn_unused_result));
+  virtual void before_run();
+  virtual bool after_run_success() __attribute__ ((warn_unused_result));
   void after_run_fail();
 
   void force_changed(long long new_mtime);
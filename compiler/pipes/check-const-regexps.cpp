@@ -0,0 +1,130 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "compiler/pipes/check-const-regexps.h"
+
+#include <pcre.h>
+#include <re2/re2.h>
+
+#include "common/re2-compatibility.h"
+#include "common/regexp-pattern.h"
+
+#include "compiler/gentree.h"
+
+namespace {
+
+// see MAX_SUBPATTERNS in runtime/regexp.h
+constexpr int MAX_SUBPATTERNS = 512;
+
+bool check_subpatterns_count(int subpatterns_count) {
+  kphp_error_act(subpatterns_count <= MAX_SUBPATTERNS,
+                 fmt_format("Maximum number of subpatterns {} exceeded, {} subpatterns found", MAX_SUBPATTERNS, subpatterns_count),
+                 return false);
+  return true;
+}
+
+// mirrors regexp::compile() from runtime/regexp.cpp; returns auto_detect if the pattern is invalid
+vk::RegexpEngine choose_regexp_engine(const std::string &pattern) {
+  vk::RegexpPattern parsed;
+  const auto parse_error = vk::parse_regexp_pattern(pattern.c_str(), pattern.size(), parsed);
+  if (parsed.study) {
+    kphp_warning(fmt_format("Study doesn't supported in regexp {}", pattern));
+  }
+  switch (parse_error) {
+    case vk::RegexpPatternError::no_error:
+      break;
+    case vk::RegexpPatternError::empty:
+      kphp_error(0, "Empty regular expression");
+      return vk::RegexpEngine::auto_detect;
+    case vk::RegexpPatternError::wrong_start_delimiter:
+      kphp_error(0, fmt_format("Wrong start delimiter in regular expression \"{}\"", pattern));
+      return vk::RegexpEngine::auto_detect;
+    case vk::RegexpPatternError::no_end_delimiter:
+      kphp_error(0, fmt_format("No ending matching delimiter '{}' found in regexp: {}", parsed.end_delimiter, pattern));
+      return vk::RegexpEngine::auto_detect;
+    case vk::RegexpPatternError::unknown_modifier:
+      kphp_error(0, fmt_format("Unknown modifier '{}' found in regexp {}", parsed.unknown_modifier, pattern));
+      return vk::RegexpEngine::auto_detect;
+    case vk::RegexpPatternError::not_utf8:
+      kphp_error(0, fmt_format("Regexp {} contains not UTF-8 symbols", pattern));
+      return vk::RegexpEngine::auto_detect;
+  }
+
+  const std::string body{parsed.body, static_cast<size_t>(parsed.body_len)};
+  const bool is_utf8 = parsed.is_utf8;
+  RE2::Options RE2_options(RE2::Latin1);
+  RE2_options.set_log_errors(false);
+  RE2_options.set_case_sensitive(!parsed.caseless);
+  RE2_options.set_dot_nl(parsed.dot_all);
+  if (is_utf8) {
+    RE2_options.set_encoding(RE2::Options::EncodingUTF8);
+  }
+  bool can_use_RE2 = parsed.can_use_RE2;
+
+  if (can_use_RE2) {
+    switch (vk::check_RE2_compatibility(body.c_str(), body.size(), is_utf8)) {
+      case vk::RE2Compatibility::compatible:
+        break;
+      case vk::RE2Compatibility::incompatible:
+        can_use_RE2 = false;
+        break;
+      case vk::RE2Compatibility::zero_symbol:
+        kphp_error(0, fmt_format("Regexp contains symbol with code 0: {}", pattern));
+        return vk::RegexpEngine::auto_detect;
+      case vk::RE2Compatibility::wrong_repetition:
+        kphp_warning(fmt_format("Wrong regexp {}", pattern));
+        can_use_RE2 = false;
+        break;
+      case vk::RE2Compatibility::brackets_mismatch:
+        kphp_warning(fmt_format("Brackets mismatch in regexp {}", pattern));
+        can_use_RE2 = false;
+        break;
+    }
+  }
+
+  if (can_use_RE2) {
+    RE2 RE2_regexp(body, RE2_options);
+    if (RE2_regexp.ok()) {
+      if (!check_subpatterns_count(RE2_regexp.NumberOfCapturingGroups() + 1)) {
+        return vk::RegexpEngine::auto_detect;
+      }
+      std::string min_str;
+      std::string max_str;
+      // rough estimate for "can match empty string", PCRE is needed to retry after empty matches
+      if (RE2_regexp.PossibleMatchRange(&min_str, &max_str, 1) && !min_str.empty()) {
+        return vk::RegexpEngine::RE2;
+      }
+    } else {
+      can_use_RE2 = false;
+    }
+  }
+
+  const char *error = nullptr;
+  int erroffset = 0;
+  pcre *pcre_regexp = pcre_compile(body.c_str(), parsed.pcre_options, &error, &erroffset, nullptr);
+  kphp_error_act(pcre_regexp, fmt_format("Regexp {} compilation failed: {} at offset {}", pattern, error, erroffset),
+                 return vk::RegexpEngine::auto_detect);
+
+  int subpatterns_count = 0;
+  pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_CAPTURECOUNT, &subpatterns_count);
+  pcre_free(pcre_regexp);
+  if (can_use_RE2) {
+    return vk::RegexpEngine::RE2_with_PCRE;
+  }
+  if (!check_subpatterns_count(subpatterns_count + 1)) {
+    return vk::RegexpEngine::auto_detect;
+  }
+  return vk::RegexpEngine::PCRE;
+}
+
+} // namespace
+
+VertexPtr CheckConstRegexpsPass::on_enter_vertex(VertexPtr root) {
+  if (auto conv_regexp = root.try_as<op_conv_regexp>()) {
+    if (const auto *pattern = GenTree::get_constexpr_string(conv_regexp->expr())) {
+      conv_regexp->engine = choose_regexp_engine(*pattern);
+    }
+  }
+  return root;
+}
@@ -0,0 +1,18 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include "compiler/function-pass.h"
+
+// Validates constant regexp patterns and chooses an engine (RE2 or PCRE) for them,
+// so they are reported at compile time and initialized in runtime without any detection
+class CheckConstRegexpsPass final : public FunctionPassBase {
+public:
+  string get_description() override {
+    return "Check const regexps";
+  }
+
+  VertexPtr on_enter_vertex(VertexPtr root) override;
+};
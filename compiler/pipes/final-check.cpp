@@ -63,6 +63,18 @@ void check_instance_to_array_call(VertexAdaptor<op_func_call> call) {
   type->class_type()->deeply_require_instance_to_array_visitor();
 }
 
+void check_instance_to_json_call(VertexAdaptor<op_func_call> call) {
+  auto type = tinf::get_type(call->args()[0]);
+  kphp_error_return(type->ptype() == tp_Class, "You may not use instance_to_json with non-instance var");
+  type->class_type()->deeply_require_instance_json_visitors();
+}
+
+void check_instance_from_json_call(VertexAdaptor<op_func_call> call) {
+  auto klass = tinf::get_type(call)->class_type();
+  kphp_error_return(klass, "Can not infer the result class of instance_from_json call");
+  klass->deeply_require_instance_json_visitors();
+}
+
 void check_estimate_memory_usage_call(VertexAdaptor<op_func_call> call) {
   auto type = tinf::get_type(call->args()[0]);
   std::unordered_set<ClassPtr> classes_inside;
@@ -396,6 +408,10 @@ void FinalCheckPass::check_op_func_call(VertexAdaptor<op_func_call> call) {
       check_instance_cache_store_call(call);
     } else if (function_name == "instance_to_array") {
       check_instance_to_array_call(call);
+    } else if (function_name == "instance_to_json") {
+      check_instance_to_json_call(call);
+    } else if (function_name == "instance_from_json") {
+      check_instance_from_json_call(call);
     } else if (function_name == "estimate_memory_usage") {
       check_estimate_memory_usage_call(call);
     } else if (function_name == "get_global_vars_memory_stats") {
@@ -487,6 +487,14 @@ private:
       kphp_error_act(klass, fmt_format("bad second parameter: can't find the class {}", *class_name), return call);
 
       kphp_error(klass->is_serializable, fmt_format("You may not deserialize class without @kphp-serializable tag {}", klass->name));
+    } else if (func->name == "instance_from_json" && call_args.size() == 2) {
+      auto *class_name = GenTree::get_constexpr_string(call_args[1]);
+      kphp_error_act(class_name && !class_name->empty(), "bad second parameter: expected constant nonempty string with class name", return call);
+
+      auto klass = G->get_class(*class_name);
+      kphp_error_act(klass, fmt_format("bad second parameter: can't find the class {}", *class_name), return call);
+
+      kphp_error(klass->is_class() && !klass->modifiers.is_abstract(), fmt_format("You may not decode interface or abstract class from json {}", klass->name));
     }
 
     return call;
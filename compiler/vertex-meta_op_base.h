@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "common/regexp-pattern.h"
 #include "common/wrappers/iterator_range.h"
 
 #include "compiler/common.h"
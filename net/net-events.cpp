@@ -15,6 +15,7 @@ net_reactor_ctx_t main_thread_reactor = {.epoll_fd = -1,
                                          .prev_now = 0,
                                          .timestamp = 0,
                                          .epoll_events = NULL,
+                                         .uring = NULL,
                                          .events = NULL,
                                          .timers = NULL,
                                          .event_heap = NULL,
@@ -0,0 +1,294 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "net/net-reactor-uring.h"
+
+#include <assert.h>
+
+#include "common/kprintf.h"
+
+DECLARE_VERBOSITY(net_events);
+
+#if NET_REACTOR_URING_ENABLED
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "common/kernel-version.h"
+
+static const unsigned URING_SQ_ENTRIES = 4096;
+// completions of poll removals are not interesting, stale poll completions are recognized by the fd generation
+static const uint64_t URING_IGNORED_USER_DATA = UINT64_MAX;
+
+struct net_reactor_uring {
+  int ring_fd;
+  int max_events;
+
+  void *rings;
+  size_t rings_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_array;
+  unsigned sq_mask;
+  unsigned sq_entries;
+
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  struct io_uring_cqe *cqes;
+  unsigned cq_mask;
+
+  // per fd: flags of the armed poll (0 if fd isn't watched) and the generation of the poll request
+  unsigned *armed_events;
+  uint32_t *generations;
+};
+
+static int io_uring_setup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, size_t arg_size) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+static unsigned uring_pending_submissions(const net_reactor_uring *uring) {
+  return *uring->sq_tail - __atomic_load_n(uring->sq_head, __ATOMIC_ACQUIRE);
+}
+
+static struct io_uring_sqe *uring_get_sqe(net_reactor_uring *uring) {
+  if (uring_pending_submissions(uring) == uring->sq_entries) {
+    int res;
+    do {
+      res = io_uring_enter(uring->ring_fd, uring->sq_entries, 0, 0, nullptr, 0);
+    } while (res < 0 && errno == EINTR);
+    if (res < 0) {
+      tvkprintf(net_events, 0, "io_uring_enter(): %m\n");
+    }
+    assert(uring_pending_submissions(uring) < uring->sq_entries);
+  }
+  const unsigned tail = *uring->sq_tail;
+  const unsigned idx = tail & uring->sq_mask;
+  struct io_uring_sqe *sqe = &uring->sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  uring->sq_array[idx] = idx;
+  return sqe;
+}
+
+static void uring_commit_sqe(net_reactor_uring *uring) {
+  __atomic_store_n(uring->sq_tail, *uring->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+static uint64_t uring_poll_user_data(const net_reactor_uring *uring, int fd) {
+  return (static_cast<uint64_t>(uring->generations[fd]) << 32) | static_cast<uint32_t>(fd);
+}
+
+static void uring_queue_poll_add(net_reactor_uring *uring, int fd) {
+  const unsigned events = uring->armed_events[fd];
+  struct io_uring_sqe *sqe = uring_get_sqe(uring);
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  // EPOLLEXCLUSIVE is kept: the listening sockets shared by the workers mustn't wake all of them
+  sqe->poll32_events = events & ~EPOLLET;
+  // level triggered events are emulated by re-arming oneshot polls after each completion
+  sqe->len = (events & EPOLLET) ? IORING_POLL_ADD_MULTI : 0;
+  sqe->user_data = uring_poll_user_data(uring, fd);
+  uring_commit_sqe(uring);
+}
+
+static void uring_queue_poll_remove(net_reactor_uring *uring, int fd) {
+  struct io_uring_sqe *sqe = uring_get_sqe(uring);
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = uring_poll_user_data(uring, fd);
+  sqe->user_data = URING_IGNORED_USER_DATA;
+  uring_commit_sqe(uring);
+}
+
+bool net_reactor_uring_supported() {
+  return io_uring_multishot_poll_supported();
+}
+
+struct net_reactor_uring *net_reactor_uring_create(int max_events) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  const int ring_fd = io_uring_setup(URING_SQ_ENTRIES, &params);
+  if (ring_fd < 0) {
+    tvkprintf(net_events, 0, "io_uring_setup(): %m\n");
+    return nullptr;
+  }
+  const unsigned required_features = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & required_features) != required_features) {
+    tvkprintf(net_events, 0, "io_uring features %08x are not supported by kernel\n", required_features & ~params.features);
+    close(ring_fd);
+    return nullptr;
+  }
+
+  auto *uring = static_cast<net_reactor_uring *>(calloc(1, sizeof(net_reactor_uring)));
+  uring->ring_fd = ring_fd;
+  uring->max_events = max_events;
+
+  const size_t sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  const size_t cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  uring->rings_size = sq_ring_size > cq_ring_size ? sq_ring_size : cq_ring_size;
+  uring->rings = mmap(nullptr, uring->rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  uring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  uring->sqes = static_cast<struct io_uring_sqe *>(mmap(nullptr, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                                        ring_fd, IORING_OFF_SQES));
+  if (uring->rings == MAP_FAILED || uring->sqes == MAP_FAILED) {
+    tvkprintf(net_events, 0, "io_uring mmap(): %m\n");
+    if (uring->rings != MAP_FAILED) {
+      munmap(uring->rings, uring->rings_size);
+    }
+    if (uring->sqes != MAP_FAILED) {
+      munmap(uring->sqes, uring->sqes_size);
+    }
+    close(ring_fd);
+    free(uring);
+    return nullptr;
+  }
+
+  char *rings = static_cast<char *>(uring->rings);
+  uring->sq_head = reinterpret_cast<unsigned *>(rings + params.sq_off.head);
+  uring->sq_tail = reinterpret_cast<unsigned *>(rings + params.sq_off.tail);
+  uring->sq_array = reinterpret_cast<unsigned *>(rings + params.sq_off.array);
+  uring->sq_mask = *reinterpret_cast<unsigned *>(rings + params.sq_off.ring_mask);
+  uring->sq_entries = *reinterpret_cast<unsigned *>(rings + params.sq_off.ring_entries);
+
+  uring->cq_head = reinterpret_cast<unsigned *>(rings + params.cq_off.head);
+  uring->cq_tail = reinterpret_cast<unsigned *>(rings + params.cq_off.tail);
+  uring->cqes = reinterpret_cast<struct io_uring_cqe *>(rings + params.cq_off.cqes);
+  uring->cq_mask = *reinterpret_cast<unsigned *>(rings + params.cq_off.ring_mask);
+
+  uring->armed_events = static_cast<unsigned *>(calloc(max_events, sizeof(uring->armed_events[0])));
+  uring->generations = static_cast<uint32_t *>(calloc(max_events, sizeof(uring->generations[0])));
+  return uring;
+}
+
+void net_reactor_uring_destroy(struct net_reactor_uring *uring) {
+  munmap(uring->sqes, uring->sqes_size);
+  munmap(uring->rings, uring->rings_size);
+  close(uring->ring_fd);
+  free(uring->armed_events);
+  free(uring->generations);
+  free(uring);
+}
+
+void net_reactor_uring_arm(struct net_reactor_uring *uring, int fd, unsigned epoll_events) {
+  assert(0 <= fd && fd < uring->max_events);
+  if (uring->armed_events[fd]) {
+    uring_queue_poll_remove(uring, fd);
+  }
+  uring->generations[fd]++;
+  uring->armed_events[fd] = epoll_events;
+  if (epoll_events) {
+    uring_queue_poll_add(uring, fd);
+  }
+}
+
+void net_reactor_uring_disarm(struct net_reactor_uring *uring, int fd) {
+  assert(0 <= fd && fd < uring->max_events);
+  if (uring->armed_events[fd]) {
+    uring_queue_poll_remove(uring, fd);
+    uring->armed_events[fd] = 0;
+    uring->generations[fd]++;
+  }
+}
+
+static int uring_reap_completions(net_reactor_uring *uring, struct epoll_event *events, int max_events) {
+  int num_events = 0;
+  unsigned head = *uring->cq_head;
+  const unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+  for (; head != tail && num_events < max_events; ++head) {
+    const struct io_uring_cqe *cqe = &uring->cqes[head & uring->cq_mask];
+    if (cqe->user_data == URING_IGNORED_USER_DATA) {
+      continue;
+    }
+    const int fd = static_cast<int>(cqe->user_data & 0xffffffff);
+    const uint32_t generation = static_cast<uint32_t>(cqe->user_data >> 32);
+    if (fd < 0 || fd >= uring->max_events || uring->generations[fd] != generation || !uring->armed_events[fd]) {
+      continue;
+    }
+    if (cqe->res == -EINVAL && (uring->armed_events[fd] & EPOLLEXCLUSIVE)) {
+      // old kernels don't support exclusive multishot polls
+      tvkprintf(net_events, 1, "io_uring exclusive poll of fd %d failed, poll it without EPOLLEXCLUSIVE\n", fd);
+      uring->armed_events[fd] &= ~EPOLLEXCLUSIVE;
+      uring_queue_poll_add(uring, fd);
+      continue;
+    }
+    if (cqe->res < 0) {
+      tvkprintf(net_events, 1, "io_uring poll of fd %d failed: %s\n", fd, strerror(-cqe->res));
+      uring->armed_events[fd] = 0;
+      continue;
+    }
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+      uring_queue_poll_add(uring, fd);
+    }
+    events[num_events].events = static_cast<uint32_t>(cqe->res);
+    events[num_events].data.fd = fd;
+    num_events++;
+  }
+  __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+  return num_events;
+}
+
+int net_reactor_uring_wait(struct net_reactor_uring *uring, struct epoll_event *events, int max_events, int timeout) {
+  struct __kernel_timespec ts;
+  ts.tv_sec = timeout / 1000;
+  ts.tv_nsec = (timeout % 1000) * 1000000LL;
+  struct io_uring_getevents_arg arg;
+  memset(&arg, 0, sizeof(arg));
+  arg.ts = timeout >= 0 ? reinterpret_cast<uint64_t>(&ts) : 0;
+
+  // pending poll changes are submitted with the same syscall that waits for the completions
+  const unsigned min_complete = timeout != 0 ? 1 : 0;
+  const int res = io_uring_enter(uring->ring_fd, uring_pending_submissions(uring), min_complete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                 &arg, sizeof(arg));
+  const int saved_errno = errno;
+  const int num_events = uring_reap_completions(uring, events, max_events);
+  if (res < 0 && saved_errno != ETIME && num_events == 0) {
+    errno = saved_errno;
+    return -1;
+  }
+  return num_events;
+}
+
+#else
+
+// the kernel headers of the build host are older than linux 5.13, the reactor stays on epoll
+
+bool net_reactor_uring_supported() {
+  tvkprintf(net_events, 0, "io_uring support isn't compiled in\n");
+  return false;
+}
+
+struct net_reactor_uring *net_reactor_uring_create(int) {
+  return nullptr;
+}
+
+void net_reactor_uring_destroy(struct net_reactor_uring *) {
+  assert(0);
+}
+
+void net_reactor_uring_arm(struct net_reactor_uring *, int, unsigned) {
+  assert(0);
+}
+
+void net_reactor_uring_disarm(struct net_reactor_uring *, int) {
+  assert(0);
+}
+
+int net_reactor_uring_wait(struct net_reactor_uring *, struct epoll_event *, int, int) {
+  assert(0);
+  return -1;
+}
+
+#endif
@@ -0,0 +1,27 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <sys/epoll.h>
+
+/*
+ *  io_uring backend of the net reactor: fds are watched with poll requests of the ring
+ *  (multishot ones for edge triggered events and re-armed oneshot ones for level triggered),
+ *  all poll changes of the loop iteration are submitted at once by the next wait.
+ *  Completions are converted back to epoll events, so the rest of the reactor doesn't know about the ring.
+ */
+
+struct net_reactor_uring;
+
+bool net_reactor_uring_supported();
+struct net_reactor_uring *net_reactor_uring_create(int max_events);
+void net_reactor_uring_destroy(struct net_reactor_uring *uring);
+
+// epoll_events are the flags for epoll_ctl(), arming an already watched fd replaces its flags
+void net_reactor_uring_arm(struct net_reactor_uring *uring, int fd, unsigned epoll_events);
+void net_reactor_uring_disarm(struct net_reactor_uring *uring, int fd);
+
+// the same contract as epoll_wait()
+int net_reactor_uring_wait(struct net_reactor_uring *uring, struct epoll_event *events, int max_events, int timeout);
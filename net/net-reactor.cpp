@@ -19,11 +19,13 @@
 #include "common/server/signals.h"
 
 #include "net/net-msg-buffers.h"
+#include "net/net-reactor-uring.h"
 #include "net/time-slice.h"
 
 DEFINE_VERBOSITY(net_events);
 
 static int epoll_sleep_time;
+static int use_io_uring;
 static const double max_time_slice = 0.05;
 
 OPTION_PARSER(OPT_NETWORK, "epoll-sleep-time", required_argument, "sleep time in main cycle, set in microseconds (between 1mcs and 0.5s), experimental") {
@@ -32,6 +34,20 @@ OPTION_PARSER(OPT_NETWORK, "epoll-sleep-time", required_argument, "sleep time in
   return 0;
 }
 
+FLAG_OPTION_PARSER(OPT_NETWORK, "io-uring", use_io_uring, "watch network events via io_uring instead of epoll (linux 5.13+), experimental");
+
+static void net_reactor_init_uring(net_reactor_ctx_t *ctx) {
+  ctx->uring = NULL;
+  if (use_io_uring) {
+    if (net_reactor_uring_supported()) {
+      ctx->uring = net_reactor_uring_create(ctx->max_events);
+    }
+    if (!ctx->uring) {
+      tvkprintf(net_events, 0, "io_uring can't be used, fall back to epoll\n");
+    }
+  }
+}
+
 void net_reactor_alloc(net_reactor_ctx_t *ctx, int max_events, int max_timers) {
   ctx->max_events = max_events;
   ctx->max_timers = max_timers;
@@ -62,6 +78,7 @@ void net_reactor_free(net_reactor_ctx_t *ctx) {
 bool net_reactor_init(net_reactor_ctx_t *ctx) {
   ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
   if (ctx->epoll_fd >= 0) {
+    net_reactor_init_uring(ctx);
     return true;
   }
 
@@ -72,6 +89,7 @@ bool net_reactor_create(net_reactor_ctx_t *ctx, int max_events, int max_timers)
   ctx->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
   if (ctx->epoll_fd >= 0) {
     net_reactor_alloc(ctx, max_events, max_timers);
+    net_reactor_init_uring(ctx);
 
     return true;
   }
@@ -83,6 +101,10 @@ bool net_reactor_create(net_reactor_ctx_t *ctx, int max_events, int max_timers)
 
 void net_reactor_destroy(net_reactor_ctx_t *ctx) {
   close(ctx->epoll_fd);
+  if (ctx->uring) {
+    net_reactor_uring_destroy(ctx->uring);
+    ctx->uring = NULL;
+  }
 }
 
 event_t *net_reactor_fd_event(net_reactor_ctx_t *ctx, int fd) {
@@ -181,6 +203,9 @@ void net_reactor_clear_event(net_reactor_ctx_t *ctx, int fd) {
   if (event->in_queue) {
     net_reactor_remove_event_from_heap(ctx, event, false);
   }
+  if (ctx->uring) {
+    net_reactor_uring_disarm(ctx->uring, fd);
+  }
   memset(event, 0, sizeof(*event));
 }
 
@@ -263,6 +288,9 @@ static int epoll_unconv_flags(int f) {
 }
 
 int net_reactor_wait(net_reactor_ctx_t *ctx, int timeout) {
+  if (ctx->uring) {
+    return net_reactor_uring_wait(ctx->uring, ctx->epoll_events, ctx->max_events, timeout);
+  }
   return epoll_wait(ctx->epoll_fd, ctx->epoll_events, ctx->max_events, timeout);
 }
 
@@ -340,7 +368,9 @@ int net_reactor_insert(net_reactor_ctx_t *ctx, int fd, int flags) {
     tvkprintf(net_events, 3, "epoll_ctl(%d,%d,%d,%d,%08x)\n", ctx->epoll_fd, (ev->state & EVT_IN_EPOLL) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, ee.data.fd,
               ee.events);
 
-    if (epoll_ctl(ctx->epoll_fd, (ev->state & EVT_IN_EPOLL) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ee) < 0) {
+    if (ctx->uring) {
+      net_reactor_uring_arm(ctx->uring, fd, ee.events);
+    } else if (epoll_ctl(ctx->epoll_fd, (ev->state & EVT_IN_EPOLL) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ee) < 0) {
       tvkprintf(net_events, 0, "epoll_ctl(): %m\n");
     }
     ev->state |= EVT_IN_EPOLL;
@@ -358,7 +388,9 @@ int net_reactor_remove(net_reactor_ctx_t *ctx, int fd) {
 
   if (!(ev->state & EVT_FAKE) && (ev->state & EVT_IN_EPOLL)) {
     ev->state &= ~EVT_IN_EPOLL;
-    if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_DEL, fd, 0) < 0) {
+    if (ctx->uring) {
+      net_reactor_uring_disarm(ctx->uring, fd);
+    } else if (epoll_ctl(ctx->epoll_fd, EPOLL_CTL_DEL, fd, 0) < 0) {
       tvkprintf(net_events, 0, "epoll_ctl(): %m\n");
     }
   }
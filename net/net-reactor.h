@@ -60,6 +60,8 @@ struct event_timer {
   const char *operation;
 };
 
+struct net_reactor_uring;
+
 struct net_reactor_ctx {
   int epoll_fd;
   int max_events;
@@ -70,6 +72,7 @@ struct net_reactor_ctx {
   int prev_now;
   int64_t timestamp;
   struct epoll_event *epoll_events;
+  struct net_reactor_uring *uring; // if not NULL, fds are watched via io_uring instead of epoll_fd
   event_t *events;
   event_t *timers;
   event_t **event_heap;
@@ -15,6 +15,7 @@ prepend(NET_SOURCES ${BASE_DIR}/net/
         net-aes-keys.cpp
         net-socket.cpp
         net-reactor.cpp
+        net-reactor-uring.cpp
         net-msg-part.cpp
         net-mysql-client.cpp
         net-memcache-client.cpp
@@ -23,4 +24,29 @@ prepend(NET_SOURCES ${BASE_DIR}/net/
         net-msg.cpp
         net-msg-part.cpp)
 
+include(CheckIncludeFile)
+include(CheckSymbolExists)
+include(CheckCSourceCompiles)
+# the io_uring backend needs linux 5.13 uapi headers, otherwise net-reactor-uring.cpp is built as a stub and epoll is used
+check_include_file(linux/io_uring.h HAVE_LINUX_IO_URING_H)
+if(HAVE_LINUX_IO_URING_H)
+    check_symbol_exists(__NR_io_uring_enter sys/syscall.h HAVE_NR_IO_URING_ENTER)
+    check_symbol_exists(IORING_FEAT_EXT_ARG linux/io_uring.h HAVE_IORING_FEAT_EXT_ARG)
+    check_symbol_exists(IORING_POLL_ADD_MULTI linux/io_uring.h HAVE_IORING_POLL_ADD_MULTI)
+    check_symbol_exists(IORING_CQE_F_MORE linux/io_uring.h HAVE_IORING_CQE_F_MORE)
+    check_c_source_compiles("
+        #include <linux/io_uring.h>
+        int main() {
+          struct io_uring_getevents_arg arg = {0};
+          struct io_uring_sqe sqe = {0};
+          sqe.poll32_events = 0;
+          return (int)arg.ts + (int)sqe.poll32_events;
+        }" HAVE_IO_URING_GETEVENTS_ARG)
+endif()
+if(HAVE_NR_IO_URING_ENTER AND HAVE_IORING_FEAT_EXT_ARG AND HAVE_IORING_POLL_ADD_MULTI AND HAVE_IORING_CQE_F_MORE AND HAVE_IO_URING_GETEVENTS_ARG)
+    set_source_files_properties(${BASE_DIR}/net/net-reactor-uring.cpp PROPERTIES COMPILE_DEFINITIONS NET_REACTOR_URING_ENABLED=1)
+else()
+    message(STATUS "io_uring headers are too old, --io-uring will fall back to epoll")
+endif()
+
 vk_add_library(net_src OBJECT ${NET_SOURCES})
@@ -0,0 +1,227 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/aho-corasick.h"
+
+#include <map>
+#include <memory>
+
+#include "runtime/allocator.h"
+
+AhoCorasickReplacer::~AhoCorasickReplacer() noexcept {
+  if (memory_) {
+    if (use_heap_memory_) {
+      dl::heap_deallocate(memory_, memory_size_);
+    } else {
+      dl::deallocate(memory_, memory_size_);
+    }
+  }
+}
+
+void AhoCorasickReplacer::build(const AhoCorasickPatterns &patterns) noexcept {
+  php_assert(patterns.search.count() == patterns.replace.count());
+  size_t search_total_len = 0;
+  size_t replace_total_len = 0;
+  for (int64_t i = 0; i < patterns.search.count(); ++i) {
+    search_total_len += patterns.search.get_value(i).size();
+    replace_total_len += patterns.replace.get_value(i).size();
+  }
+  allocate_memory(search_total_len + 1, replace_total_len);
+  for (int64_t i = 0; i < patterns.search.count(); ++i) {
+    const string &search = patterns.search.get_value(i);
+    const string &replace = patterns.replace.get_value(i);
+    add_pattern(vk::string_view{search.c_str(), search.size()}, vk::string_view{replace.c_str(), replace.size()});
+  }
+  build_failure_links();
+}
+
+void AhoCorasickReplacer::allocate_memory(size_t max_nodes, size_t replace_total_len) noexcept {
+  php_assert(!memory_);
+  memory_size_ = max_nodes * sizeof(Node) + replace_total_len;
+  memory_ = static_cast<char *>(use_heap_memory_ ? dl::heap_allocate(memory_size_) : dl::allocate(memory_size_));
+  php_assert(memory_);
+  nodes_ = reinterpret_cast<Node *>(memory_);
+  std::uninitialized_fill_n(nodes_, max_nodes, Node{});
+  nodes_count_ = 1;
+  replacements_ = memory_ + max_nodes * sizeof(Node);
+}
+
+void AhoCorasickReplacer::add_pattern(vk::string_view search, vk::string_view replace) noexcept {
+  const int32_t pattern = patterns_count_++;
+  if (search.empty()) {
+    has_empty_search_ = true;
+    return;
+  }
+
+  // an occurrence of the pattern may appear after replacing the previous patterns
+  if (has_empty_replace_ && search.size() > 1) {
+    sequential_replace_equivalent_ = false;
+  }
+  for (char c : search) {
+    if (replace_bytes_[static_cast<uint8_t>(c)]) {
+      sequential_replace_equivalent_ = false;
+    }
+  }
+  for (char c : replace) {
+    replace_bytes_.set(static_cast<uint8_t>(c));
+  }
+  has_empty_replace_ |= replace.empty();
+
+  int32_t node = 0;
+  for (char c : search) {
+    const auto byte = static_cast<uint8_t>(c);
+    int32_t child = node ? find_child(node, byte) : root_next_[byte];
+    if (child) {
+      if (nodes_[child].owner != pattern) {
+        nodes_[child].owner = -1;
+      }
+    } else {
+      child = nodes_count_++;
+      Node &new_node = nodes_[child];
+      new_node.depth = nodes_[node].depth + 1;
+      new_node.owner = pattern;
+      new_node.byte = byte;
+      if (node) {
+        new_node.next_sibling = nodes_[node].first_child;
+        nodes_[node].first_child = child;
+      } else {
+        root_next_[byte] = child;
+      }
+    }
+    node = child;
+  }
+
+  Node &terminal = nodes_[node];
+  if (terminal.replace_len != -1) {
+    // the same search string has been added already, the first replacement is used as in strtr
+    return;
+  }
+  terminal.replace_offset = replacements_size_;
+  terminal.replace_len = static_cast<int32_t>(replace.size());
+  memcpy(replacements_ + replacements_size_, replace.data(), replace.size());
+  replacements_size_ += static_cast<uint32_t>(replace.size());
+}
+
+void AhoCorasickReplacer::build_failure_links() noexcept {
+  // the nodes are visited in the BFS order, so the failure links of the shorter prefixes are ready
+  const int32_t queue_size = nodes_count_;
+  auto *queue = static_cast<int32_t *>(use_heap_memory_ ? dl::heap_allocate(queue_size * sizeof(int32_t)) : dl::allocate(queue_size * sizeof(int32_t)));
+  int32_t queue_end = 0;
+  for (int32_t child : root_next_) {
+    if (child) {
+      nodes_[child].output = nodes_[child].replace_len != -1 ? child : 0;
+      queue[queue_end++] = child;
+    }
+  }
+
+  for (int32_t queue_begin = 0; queue_begin != queue_end; ++queue_begin) {
+    const Node &node = nodes_[queue[queue_begin]];
+    // the patterns of different owners overlap, or one of them is a substring of another
+    if (node.replace_len != -1 && node.owner == -1) {
+      sequential_replace_equivalent_ = false;
+    }
+    if (node.fail && (node.owner == -1 || node.owner != nodes_[node.fail].owner)) {
+      sequential_replace_equivalent_ = false;
+    }
+
+    for (int32_t child = node.first_child; child; child = nodes_[child].next_sibling) {
+      Node &child_node = nodes_[child];
+      child_node.fail = next_state(node.fail, child_node.byte);
+      child_node.output = child_node.replace_len != -1 ? child : nodes_[child_node.fail].output;
+      queue[queue_end++] = child;
+    }
+  }
+
+  if (use_heap_memory_) {
+    dl::heap_deallocate(queue, queue_size * sizeof(int32_t));
+  } else {
+    dl::deallocate(queue, queue_size * sizeof(int32_t));
+  }
+}
+
+string AhoCorasickReplacer::replace_all(const string &subject, int64_t &replace_count) const noexcept {
+  if (has_empty_search_ || nodes_count_ == 1) {
+    return subject;
+  }
+
+  const auto *begin = reinterpret_cast<const uint8_t *>(subject.c_str());
+  const uint8_t *end = begin + subject.size();
+  // the bytes before are already copied into the result
+  const uint8_t *copied = begin;
+  const uint8_t *pos = begin;
+  int32_t state = 0;
+  // the leftmost-longest match found so far, it is committed as soon as no other match can start before or at it
+  const uint8_t *match_begin = nullptr;
+  int32_t match_node = 0;
+  int64_t count = 0;
+  string result;
+
+  while (true) {
+    if (match_node && (pos == end || pos - nodes_[state].depth > match_begin)) {
+      const Node &matched = nodes_[match_node];
+      if (!count) {
+        result.reserve_at_least(static_cast<string::size_type>(subject.size()));
+      }
+      result.append(reinterpret_cast<const char *>(copied), static_cast<string::size_type>(match_begin - copied));
+      result.append(replacements_ + matched.replace_offset, static_cast<string::size_type>(matched.replace_len));
+      ++count;
+      copied = pos = match_begin + matched.depth;
+      state = 0;
+      match_node = 0;
+      continue;
+    }
+    if (!state) {
+      while (pos != end && !root_next_[*pos]) {
+        ++pos;
+      }
+    }
+    if (pos == end) {
+      break;
+    }
+
+    state = next_state(state, *pos++);
+    if (const int32_t output = nodes_[state].output) {
+      const uint8_t *output_begin = pos - nodes_[output].depth;
+      if (!match_node || output_begin < match_begin || (output_begin == match_begin && nodes_[output].depth > nodes_[match_node].depth)) {
+        match_begin = output_begin;
+        match_node = output;
+      }
+    }
+  }
+
+  if (!count) {
+    return subject;
+  }
+  replace_count += count;
+  result.append(reinterpret_cast<const char *>(copied), static_cast<string::size_type>(end - copied));
+  return result;
+}
+
+namespace {
+
+using AhoCorasickCache = std::map<std::pair<const void *, const void *>, std::unique_ptr<AhoCorasickReplacer>>;
+
+AhoCorasickCache &get_aho_corasick_cache() noexcept {
+  static AhoCorasickCache cache;
+  return cache;
+}
+
+} // namespace
+
+const AhoCorasickReplacer *get_cached_aho_corasick_replacer(const void *first_array, const void *second_array) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  const auto &cache = get_aho_corasick_cache();
+  auto it = cache.find({first_array, second_array});
+  return it != cache.end() ? it->second.get() : nullptr;
+}
+
+const AhoCorasickReplacer &cache_aho_corasick_replacer(const void *first_array, const void *second_array,
+                                                       std::unique_ptr<AhoCorasickReplacer> &&replacer) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  auto &cached = get_aho_corasick_cache()[{first_array, second_array}];
+  if (!cached) {
+    cached = std::move(replacer);
+  }
+  return *cached;
+}
@@ -0,0 +1,146 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+
+#include "common/mixin/not_copyable.h"
+#include "common/wrappers/string_view.h"
+
+#include "runtime/critical_section.h"
+#include "runtime/kphp_core.h"
+
+// The search and replace strings in the order of priority.
+// The values are converted to strings once: the automaton building and the sequential replacement fallback
+// pass over them several times, and the conversion warnings mustn't be repeated
+struct AhoCorasickPatterns {
+  array<string> search;
+  array<string> replace;
+  bool is_filled{false};
+
+  void add(const string &search_string, const string &replace_string) noexcept {
+    search.push_back(search_string);
+    replace.push_back(replace_string);
+  }
+};
+
+// Aho-Corasick automaton, which replaces a set of patterns in a single pass over the subject.
+// The matches are chosen as in strtr: the leftmost one, and the longest one among those starting at the same position.
+class AhoCorasickReplacer : vk::not_copyable {
+public:
+  explicit AhoCorasickReplacer(bool use_heap_memory) noexcept:
+    use_heap_memory_(use_heap_memory) {
+  }
+
+  ~AhoCorasickReplacer() noexcept;
+
+  void build(const AhoCorasickPatterns &patterns) noexcept;
+
+  // The subject is returned as is if any search string is empty
+  string replace_all(const string &subject, int64_t &replace_count) const noexcept;
+
+  // The single pass gives the same result as replacing the patterns one by one, like str_replace does,
+  // if occurrences of different patterns can't overlap and a replacement can't produce an occurrence of the following patterns
+  bool is_sequential_replace_equivalent() const noexcept {
+    return !has_empty_search_ && sequential_replace_equivalent_;
+  }
+
+private:
+  struct Node {
+    int32_t first_child{0};
+    int32_t next_sibling{0};
+    int32_t fail{0};
+    // the node of the longest pattern, which is a suffix of this node
+    int32_t output{0};
+    int32_t depth{0};
+    // the index of the only pattern passing through this node or -1 if there are several ones
+    int32_t owner{-1};
+    uint32_t replace_offset{0};
+    // -1 if no pattern ends in this node
+    int32_t replace_len{-1};
+    uint8_t byte{0};
+  };
+
+  void allocate_memory(size_t max_nodes, size_t replace_total_len) noexcept;
+  void add_pattern(vk::string_view search, vk::string_view replace) noexcept;
+  void build_failure_links() noexcept;
+
+  int32_t find_child(int32_t node, uint8_t byte) const noexcept {
+    for (int32_t child = nodes_[node].first_child; child; child = nodes_[child].next_sibling) {
+      if (nodes_[child].byte == byte) {
+        return child;
+      }
+    }
+    return 0;
+  }
+
+  int32_t next_state(int32_t node, uint8_t byte) const noexcept {
+    while (node) {
+      if (const int32_t child = find_child(node, byte)) {
+        return child;
+      }
+      node = nodes_[node].fail;
+    }
+    return root_next_[byte];
+  }
+
+  const bool use_heap_memory_{false};
+  bool has_empty_search_{false};
+  bool sequential_replace_equivalent_{true};
+  bool has_empty_replace_{false};
+  int32_t patterns_count_{0};
+
+  char *memory_{nullptr};
+  size_t memory_size_{0};
+  Node *nodes_{nullptr};
+  int32_t nodes_count_{0};
+  char *replacements_{nullptr};
+  uint32_t replacements_size_{0};
+
+  // the transitions from the root are dense, the root itself is the node 0,
+  // a zero here means that no pattern starts with this byte and allows to skip the byte quickly
+  std::array<int32_t, 256> root_next_{};
+  std::bitset<256> replace_bytes_;
+};
+
+// The automatons for the constant arrays are built once and kept between requests,
+// they are identified by the addresses of the arrays (the second one is nullptr for strtr)
+const AhoCorasickReplacer *get_cached_aho_corasick_replacer(const void *first_array, const void *second_array) noexcept;
+const AhoCorasickReplacer &cache_aho_corasick_replacer(const void *first_array, const void *second_array,
+                                                       std::unique_ptr<AhoCorasickReplacer> &&replacer) noexcept;
+
+// Returns false if the patterns can't be replaced in a single pass with the same result as the sequential replacement,
+// the cache keys should be non null only for the constant arrays;
+// get_patterns() is called only if the automaton isn't cached yet
+template<class GetPatterns>
+bool aho_corasick_replace(const string &subject, string &result, int64_t &replace_count, bool sequential,
+                          const void *first_array, const void *second_array, const GetPatterns &get_patterns) noexcept {
+  auto replace = [&](const AhoCorasickReplacer &replacer) {
+    if (sequential && !replacer.is_sequential_replace_equivalent()) {
+      return false;
+    }
+    result = replacer.replace_all(subject, replace_count);
+    return true;
+  };
+
+  if (first_array) {
+    const AhoCorasickReplacer *cached = get_cached_aho_corasick_replacer(first_array, second_array);
+    if (!cached) {
+      const AhoCorasickPatterns &patterns = get_patterns();
+      dl::CriticalSectionGuard critical_section;
+      auto replacer = std::make_unique<AhoCorasickReplacer>(true);
+      replacer->build(patterns);
+      cached = &cache_aho_corasick_replacer(first_array, second_array, std::move(replacer));
+    }
+    return replace(*cached);
+  }
+
+  AhoCorasickReplacer replacer{false};
+  replacer.build(get_patterns());
+  return replace(replacer);
+}
@@ -27,6 +27,7 @@ memory_resource::Dealer &get_memory_dealer() noexcept {
 }
 
 volatile bool script_allocator_enabled = false;
+bool script_allocator_slab_mode = false;
 
 } // namespace
 
@@ -75,11 +76,15 @@ void init_script_allocator(void *buffer, size_t buffer_size) noexcept {
   php_assert(!is_malloc_replaced());
 
   CriticalSectionGuard lock;
-  dealer.current_script_resource().init(buffer, buffer_size);
+  dealer.current_script_resource().init(buffer, buffer_size, script_allocator_slab_mode);
   script_allocator_enabled = true;
   query_num++;
 }
 
+void set_script_allocator_slab_mode(bool slab_mode) noexcept {
+  script_allocator_slab_mode = slab_mode;
+}
+
 void free_script_allocator() noexcept {
   auto &dealer = get_memory_dealer();
   php_assert(!dealer.heap_script_resource_replacer());
@@ -103,6 +108,14 @@ void *allocate(size_t size) noexcept {
   return dealer.current_script_resource().allocate(size);
 }
 
+bool is_enough_script_memory_for(size_t size) noexcept {
+  auto &dealer = get_memory_dealer();
+  if (dealer.heap_script_resource_replacer()) {
+    return true;
+  }
+  return script_allocator_enabled && dealer.current_script_resource().is_enough_memory_for(size);
+}
+
 void *allocate0(size_t size) noexcept {
   php_assert(size);
   auto &dealer = get_memory_dealer();
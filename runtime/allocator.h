@@ -27,12 +27,14 @@ size_t get_heap_memory_used() noexcept;
 
 void global_init_script_allocator() noexcept;
 void init_script_allocator(void *buffer, size_t buffer_size) noexcept; // init script allocator with arena of n bytes at buf
+void set_script_allocator_slab_mode(bool slab_mode) noexcept; // serve small pieces of script memory from slabs
 void free_script_allocator() noexcept;
 
 void *allocate(size_t n) noexcept; // allocate script memory
 void *allocate0(size_t n) noexcept; // allocate zeroed script memory
 void *reallocate(void *p, size_t new_size, size_t old_size) noexcept; // reallocate script memory
 void deallocate(void *p, size_t n) noexcept; // deallocate script memory
+bool is_enough_script_memory_for(size_t n) noexcept; // check that allocate(n) won't hit the memory limit
 
 void *heap_allocate(size_t n) noexcept; // allocate heap memory (persistent between script runs)
 void *heap_reallocate(void *p, size_t new_size, size_t old_size) noexcept; // reallocate heap memory
@@ -2338,6 +2338,11 @@ bool array<T>::is_equal_inner_pointer(const array &other) const noexcept {
   return p == other.p;
 }
 
+template<class T>
+const void *array<T>::get_inner_pointer() const noexcept {
+  return p;
+}
+
 template<class T>
 void swap(array<T> &lhs, array<T> &rhs) {
   lhs.swap(rhs);
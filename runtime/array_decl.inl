@@ -61,18 +61,21 @@ private:
     entry_pointer_type prev;
   };
 
+  // probing reads only `next` and `int_key` of every visited bucket,
+  // so they are kept together in the first 16 bytes of an entry, in front of the value;
+  // `value` and `int_key` must have the same offsets in both entry types, iterators rely on it
   struct int_hash_entry : list_hash_entry {
-    T value;
-
     int64_t int_key;
 
+    T value;
+
     inline key_type get_key() const;
   };
 
   struct string_hash_entry : list_hash_entry {
-    T value;
-
     int64_t int_key;
+
+    T value;
     string string_key;
 
     inline key_type get_key() const;
@@ -409,6 +412,7 @@ public:
   const T *get_const_vector_pointer() const; // unsafe
 
   bool is_equal_inner_pointer(const array &other) const noexcept;
+  const void *get_inner_pointer() const noexcept; // unsafe
 
   void reserve(int64_t int_size, int64_t string_size, bool make_vector_if_possible);
 
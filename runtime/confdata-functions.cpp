@@ -70,6 +70,20 @@ bool verify_confdata_key_param(const string &param, const char *real_name) noexc
   return true;
 }
 
+// All sections starting with the prefix are placed in a row before the smallest key, which is greater than any of them
+confdata_sample_storage::const_iterator get_prefix_range_end(const confdata_sample_storage &confdata_storage, const string &prefix) noexcept {
+  auto len = prefix.size();
+  while (len && static_cast<unsigned char>(prefix[len - 1]) == 0xFF) {
+    --len;
+  }
+  if (!len) {
+    return confdata_storage.end();
+  }
+  string prefix_upper_bound{prefix.c_str(), len};
+  ++prefix_upper_bound[len - 1];
+  return confdata_storage.lower_bound(prefix_upper_bound);
+}
+
 } // namespace
 
 void init_confdata_functions_lib() {
@@ -156,42 +170,42 @@ array<mixed> f$confdata_get_values_by_any_wildcard(const string &wildcard) noexc
 
   // wildcard has a form of '\w+' and does not contain a predefined prefix
   array<mixed> result;
-  auto merge_into_result = [&result, &wildcard](confdata_sample_storage::const_iterator iter) {
-    const auto section_suffix = f$substr(iter->first, wildcard.size()).val();
-    php_assert(iter->second.is_array());
+  auto merge_into_result = [&result, &wildcard](const confdata_sample_storage::value_type &section) {
+    const string section_suffix{section.first.c_str() + wildcard.size(), section.first.size() - wildcard.size()};
+    php_assert(section.second.is_array());
     // it must be an array (we loaded it this way)
-    const auto &second_key_array = iter->second.as_array();
+    const auto &second_key_array = section.second.as_array();
     const auto inserting_size = second_key_array.size() + result.size();
     result.reserve(inserting_size.int_size, inserting_size.string_size, inserting_size.is_vector);
-    for (const auto &section_it : iter->second) {
+    for (const auto &section_it : second_key_array) {
       result.set_value(string{section_suffix}.append(section_it.get_key()), section_it.get_value());
     }
   };
-  auto it = confdata_storage.lower_bound(wildcard);
-  while (it != confdata_storage.end() && it->first.starts_with(wildcard)) {
+  // the keys in the range are not compared with the wildcard
+  const auto last = get_prefix_range_end(confdata_storage, wildcard);
+  for (auto it = confdata_storage.lower_bound(wildcard); it != last; ++it) {
     const vk::string_view section_wildcard{it->first.c_str(), it->first.size()};
     switch (predefined_wildcards.detect_first_key_type(section_wildcard)) {
       case ConfdataFirstKeyType::simple_key:
-        result.set_value(f$substr(it->first, wildcard.size()).val(), it->second);
+        result.set_value(string{it->first.c_str() + wildcard.size(), it->first.size() - wildcard.size()}, it->second);
         break;
       case ConfdataFirstKeyType::predefined_wildcard:
         // not a subset of any other prefixes
         if (!vk::contains(section_wildcard, ".") &&
             predefined_wildcards.is_most_common_predefined_wildcard(section_wildcard)) {
-          merge_into_result(it);
+          merge_into_result(*it);
         }
         break;
       case ConfdataFirstKeyType::one_dot_wildcard:
         // not a subset of any other predefined prefixes
         if (!predefined_wildcards.has_wildcard_for_key(section_wildcard)) {
-          merge_into_result(it);
+          merge_into_result(*it);
         }
         break;
       case ConfdataFirstKeyType::two_dots_wildcard:
         // a subset of ConfdataFirstKeyType::one_dot_wildcard
         break;
     }
-    ++it;
   }
 
   return result;
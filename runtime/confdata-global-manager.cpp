@@ -71,7 +71,7 @@ void ConfdataSample::destroy() noexcept {
   php_assert(!resource_ == !confdata_storage_);
   if (resource_) {
     clear();
-    confdata_storage_->~map();
+    confdata_storage_->~confdata_sample_storage();
     resource_->deallocate(confdata_storage_, sizeof(*confdata_storage_));
 
     confdata_storage_ = nullptr;
@@ -12,10 +12,11 @@
 #include "runtime/confdata-keys.h"
 #include "runtime/inter-process-resource.h"
 #include "runtime/kphp_core.h"
-#include "runtime/memory_resource/resource_allocator.h"
+#include "runtime/memory_resource/persistent_map.h"
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 
-using confdata_sample_storage = memory_resource::stl::map<string, mixed, memory_resource::unsynchronized_pool_resource, stl_string_less>;
+// the samples share the unchanged sections, so a new sample costs O(K log N) for K changed sections
+using confdata_sample_storage = memory_resource::persistent_map<string, mixed, memory_resource::unsynchronized_pool_resource, stl_string_less>;
 
 enum class ConfdataGarbageDestroyWay {
   shallow_first,
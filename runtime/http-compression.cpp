@@ -0,0 +1,409 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#include "runtime/http-compression.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <zlib.h>
+#include <zstd.h>
+
+#include "common/mixin/not_copyable.h"
+#include "common/wrappers/string_view.h"
+
+#include "runtime/critical_section.h"
+#include "runtime/zlib.h"
+
+namespace {
+
+// the bodies smaller than this are compressed fast enough, so they aren't cached
+constexpr size_t HTTP_COMPRESSION_CACHE_MIN_BODY_SIZE = 1024;
+
+class HttpCompressionLevels {
+public:
+  explicit HttpCompressionLevels(int32_t default_level, int32_t min_level, int32_t max_level) noexcept:
+    min_level_(min_level),
+    max_level_(max_level) {
+    levels_[0] = {0, default_level};
+  }
+
+  bool parse(const char *levels) noexcept {
+    std::array<std::pair<size_t, int32_t>, MAX_LEVELS> parsed{};
+    size_t count = 0;
+    const char *pos = levels;
+    while (true) {
+      if (count == MAX_LEVELS) {
+        return false;
+      }
+      char *end = nullptr;
+      const long long first = strtoll(pos, &end, 10);
+      if (end == pos) {
+        return false;
+      }
+      if (count == 0) {
+        parsed[count++] = {0, static_cast<int32_t>(first)};
+      } else {
+        if (*end != ':' || first <= static_cast<long long>(parsed[count - 1].first)) {
+          return false;
+        }
+        pos = end + 1;
+        const long long level = strtoll(pos, &end, 10);
+        if (end == pos) {
+          return false;
+        }
+        parsed[count++] = {static_cast<size_t>(first), static_cast<int32_t>(level)};
+      }
+      const int32_t level = parsed[count - 1].second;
+      if (level < min_level_ || level > max_level_) {
+        return false;
+      }
+      if (*end == '\0') {
+        break;
+      }
+      if (*end != ',') {
+        return false;
+      }
+      pos = end + 1;
+    }
+    levels_ = parsed;
+    count_ = count;
+    return true;
+  }
+
+  int32_t get(size_t body_size) const noexcept {
+    size_t i = count_ - 1;
+    while (levels_[i].first > body_size) {
+      --i;
+    }
+    return levels_[i].second;
+  }
+
+private:
+  static constexpr size_t MAX_LEVELS = 8;
+
+  const int32_t min_level_;
+  const int32_t max_level_;
+  // the body size, from which the level is used, sorted by the size; the first size is always 0
+  std::array<std::pair<size_t, int32_t>, MAX_LEVELS> levels_{};
+  size_t count_{1};
+};
+
+HttpCompressionLevels gzip_levels{6, 0, 9};
+HttpCompressionLevels zstd_levels{3, 1, 19};
+
+size_t http_compression_cache_size_limit = 0;
+
+// Compressed bodies that live on heap and survive between requests of the same worker,
+// it pays off for the responses that are byte-identical, like rendered static pages.
+// The least recently used bodies are evicted when the total size exceeds the limit.
+class HttpCompressionCache : vk::not_copyable {
+public:
+  static HttpCompressionCache &get() noexcept {
+    static HttpCompressionCache cache;
+    return cache;
+  }
+
+  bool is_enabled() const noexcept {
+    return http_compression_cache_size_limit != 0;
+  }
+
+  const std::string *find(HttpEncoding encoding, int32_t level, vk::string_view body) noexcept {
+    dl::CriticalSectionGuard critical_section;
+    auto it = index_.find(hash(encoding, body));
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    const CachedBody &cached = *it->second;
+    if (cached.encoding != encoding || cached.level != level || vk::string_view{cached.body} != body) {
+      return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &cached.compressed;
+  }
+
+  void add(HttpEncoding encoding, int32_t level, vk::string_view body, vk::string_view compressed) noexcept {
+    const size_t entry_size = body.size() + compressed.size();
+    if (entry_size > http_compression_cache_size_limit) {
+      return;
+    }
+
+    dl::CriticalSectionGuard critical_section;
+    const size_t key = hash(encoding, body);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      erase(it);
+    }
+    while (total_size_ + entry_size > http_compression_cache_size_limit) {
+      erase(index_.find(lru_.back().key));
+    }
+
+    lru_.emplace_front();
+    CachedBody &cached = lru_.front();
+    cached.key = key;
+    cached.encoding = encoding;
+    cached.level = level;
+    cached.body.assign(body.data(), body.size());
+    cached.compressed.assign(compressed.data(), compressed.size());
+    index_.emplace(key, lru_.begin());
+    total_size_ += entry_size;
+  }
+
+private:
+  struct CachedBody {
+    size_t key{0};
+    HttpEncoding encoding{HttpEncoding::identity};
+    int32_t level{0};
+    std::string body;
+    std::string compressed;
+  };
+
+  HttpCompressionCache() = default;
+
+  static size_t hash(HttpEncoding encoding, vk::string_view body) noexcept {
+    return std::hash<vk::string_view>{}(body) ^ (static_cast<size_t>(encoding) * 0x9e3779b97f4a7c15ULL);
+  }
+
+  void erase(std::unordered_map<size_t, std::list<CachedBody>::iterator>::iterator it) noexcept {
+    total_size_ -= it->second->body.size() + it->second->compressed.size();
+    lru_.erase(it->second);
+    index_.erase(it);
+  }
+
+  std::list<CachedBody> lru_;
+  std::unordered_map<size_t, std::list<CachedBody>::iterator> index_;
+  size_t total_size_{0};
+};
+
+ZSTD_CCtx *get_zstd_context() noexcept {
+  static ZSTD_CCtx *context = ZSTD_createCCtx();
+  return context;
+}
+
+const string_buffer *zstd_encode(const char *s, int32_t s_len, int32_t level) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  ZSTD_CCtx *context = get_zstd_context();
+  const size_t bound = ZSTD_compressBound(static_cast<size_t>(s_len));
+  static_SB.clean().reserve(static_cast<int>(bound));
+  const size_t compressed_size = context ? ZSTD_compressCCtx(context, static_SB.buffer(), bound, s, static_cast<size_t>(s_len), level) : 0;
+  if (!context || ZSTD_isError(compressed_size)) {
+    php_warning("Error during pack of string with length %d", s_len);
+    static_SB.clean();
+    return &static_SB;
+  }
+  static_SB.set_pos(static_cast<int64_t>(compressed_size));
+  return &static_SB;
+}
+
+const string_buffer *compress(HttpEncoding encoding, const char *s, int32_t s_len, int32_t level) noexcept {
+  switch (encoding) {
+    case HttpEncoding::gzip:
+      return zlib_encode(s, s_len, level, ZLIB_ENCODE);
+    case HttpEncoding::deflate:
+      return zlib_encode(s, s_len, level, ZLIB_COMPRESS);
+    case HttpEncoding::zstd:
+      return zstd_encode(s, s_len, level);
+    case HttpEncoding::identity:
+      break;
+  }
+  static_SB.clean().append(s, static_cast<size_t>(s_len));
+  return &static_SB;
+}
+
+struct HttpStreamCompressor {
+  HttpEncoding encoding{HttpEncoding::identity};
+  bool zlib_stream_inited{false};
+  z_stream zlib_stream{};
+};
+
+HttpStreamCompressor stream_compressor;
+
+void end_stream_compression() noexcept {
+  if (stream_compressor.zlib_stream_inited) {
+    deflateEnd(&stream_compressor.zlib_stream);
+    stream_compressor.zlib_stream_inited = false;
+  }
+  stream_compressor.encoding = HttpEncoding::identity;
+}
+
+bool zlib_stream_compress(const char *s, int32_t s_len, bool finish) noexcept {
+  z_stream &strm = stream_compressor.zlib_stream;
+  strm.avail_in = static_cast<unsigned int>(s_len);
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(s));
+  // the sync flush marker and the trailer
+  const auto reserved = static_cast<unsigned int>(deflateBound(&strm, static_cast<uLong>(s_len)) + 16);
+  while (true) {
+    static_SB.reserve(static_cast<int>(reserved));
+    strm.avail_out = reserved;
+    strm.next_out = reinterpret_cast<Bytef *>(static_SB.buffer() + static_SB.size());
+    const int ret = deflate(&strm, finish ? Z_FINISH : Z_SYNC_FLUSH);
+    static_SB.set_pos(static_cast<int64_t>(static_SB.size() + reserved - strm.avail_out));
+    if (ret == Z_STREAM_END || (!finish && strm.avail_out != 0 && (ret == Z_OK || ret == Z_BUF_ERROR))) {
+      return true;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      return false;
+    }
+  }
+}
+
+bool zstd_stream_compress(const char *s, int32_t s_len, bool finish) noexcept {
+  ZSTD_inBuffer input{s, static_cast<size_t>(s_len), 0};
+  size_t reserved = ZSTD_compressBound(static_cast<size_t>(s_len)) + 32;
+  while (true) {
+    static_SB.reserve(static_cast<int>(reserved));
+    ZSTD_outBuffer output{static_SB.buffer() + static_SB.size(), reserved, 0};
+    const size_t remaining = ZSTD_compressStream2(get_zstd_context(), &output, &input, finish ? ZSTD_e_end : ZSTD_e_flush);
+    if (ZSTD_isError(remaining)) {
+      return false;
+    }
+    static_SB.set_pos(static_cast<int64_t>(static_SB.size() + output.pos));
+    if (remaining == 0) {
+      return true;
+    }
+    reserved = remaining;
+  }
+}
+
+} // namespace
+
+HttpEncoding choose_http_encoding(int32_t accepted_encodings) noexcept {
+  if (accepted_encodings & HTTP_ACCEPT_ZSTD) {
+    return HttpEncoding::zstd;
+  }
+  if (accepted_encodings & HTTP_ACCEPT_GZIP) {
+    return HttpEncoding::gzip;
+  }
+  if (accepted_encodings & HTTP_ACCEPT_DEFLATE) {
+    return HttpEncoding::deflate;
+  }
+  return HttpEncoding::identity;
+}
+
+int32_t parse_http_accept_encoding(const char *header_value) noexcept {
+  int32_t accepted_encodings = 0;
+  if (strstr(header_value, "gzip") != nullptr) {
+    accepted_encodings |= HTTP_ACCEPT_GZIP;
+  }
+  if (strstr(header_value, "deflate") != nullptr) {
+    accepted_encodings |= HTTP_ACCEPT_DEFLATE;
+  }
+  if (strstr(header_value, "zstd") != nullptr) {
+    accepted_encodings |= HTTP_ACCEPT_ZSTD;
+  }
+  return accepted_encodings;
+}
+
+const char *get_http_content_encoding_header(HttpEncoding encoding) noexcept {
+  switch (encoding) {
+    case HttpEncoding::gzip:
+      return "Content-Encoding: gzip";
+    case HttpEncoding::deflate:
+      return "Content-Encoding: deflate";
+    case HttpEncoding::zstd:
+      return "Content-Encoding: zstd";
+    case HttpEncoding::identity:
+      break;
+  }
+  return "Content-Encoding: identity";
+}
+
+bool set_http_compression_levels(const char *encoding, const char *levels) noexcept {
+  if (!strcmp(encoding, "gzip")) {
+    return gzip_levels.parse(levels);
+  }
+  if (!strcmp(encoding, "zstd")) {
+    return zstd_levels.parse(levels);
+  }
+  return false;
+}
+
+int32_t get_http_compression_level(HttpEncoding encoding, size_t body_size) noexcept {
+  return encoding == HttpEncoding::zstd ? zstd_levels.get(body_size) : gzip_levels.get(body_size);
+}
+
+void set_http_compression_cache_size_limit(size_t limit) noexcept {
+  http_compression_cache_size_limit = limit;
+}
+
+const string_buffer *http_compress(HttpEncoding encoding, const char *s, int32_t s_len) noexcept {
+  const int32_t level = get_http_compression_level(encoding, static_cast<size_t>(s_len));
+  auto &cache = HttpCompressionCache::get();
+  const vk::string_view body{s, static_cast<size_t>(s_len)};
+  const bool use_cache = cache.is_enabled() && body.size() >= HTTP_COMPRESSION_CACHE_MIN_BODY_SIZE;
+  if (use_cache) {
+    if (const std::string *compressed = cache.find(encoding, level, body)) {
+      static_SB.clean().append(compressed->data(), compressed->size());
+      return &static_SB;
+    }
+  }
+
+  const string_buffer *compressed = compress(encoding, s, s_len, level);
+  if (use_cache && compressed->size()) {
+    cache.add(encoding, level, body, vk::string_view{compressed->buffer(), compressed->size()});
+  }
+  return compressed;
+}
+
+void http_stream_compression_start(HttpEncoding encoding) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  end_stream_compression();
+  // the size of the whole body is unknown, so the level for the small bodies is used
+  const int32_t level = get_http_compression_level(encoding, 0);
+  switch (encoding) {
+    case HttpEncoding::gzip:
+    case HttpEncoding::deflate: {
+      z_stream &strm = stream_compressor.zlib_stream;
+      memset(&strm, 0, sizeof(strm));
+      const int32_t window_bits = encoding == HttpEncoding::gzip ? ZLIB_ENCODE : ZLIB_COMPRESS;
+      stream_compressor.zlib_stream_inited = deflateInit2(&strm, level, Z_DEFLATED, window_bits, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) == Z_OK;
+      php_assert(stream_compressor.zlib_stream_inited);
+      break;
+    }
+    case HttpEncoding::zstd: {
+      ZSTD_CCtx *context = get_zstd_context();
+      php_assert(context);
+      ZSTD_CCtx_reset(context, ZSTD_reset_session_and_parameters);
+      ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+      break;
+    }
+    case HttpEncoding::identity:
+      break;
+  }
+  stream_compressor.encoding = encoding;
+}
+
+const string_buffer *http_stream_compress(const char *s, int32_t s_len, bool finish) noexcept {
+  dl::CriticalSectionGuard critical_section;
+  static_SB.clean();
+  bool ok = true;
+  switch (stream_compressor.encoding) {
+    case HttpEncoding::gzip:
+    case HttpEncoding::deflate:
+      ok = zlib_stream_compress(s, s_len, finish);
+      break;
+    case HttpEncoding::zstd:
+      ok = zstd_stream_compress(s, s_len, finish);
+      break;
+    case HttpEncoding::identity:
+      static_SB.append(s, static_cast<size_t>(s_len));
+      break;
+  }
+  if (!ok) {
+    php_warning("Error during pack of string with length %d", s_len);
+    static_SB.clean();
+  }
+  if (finish) {
+    end_stream_compression();
+  }
+  return &static_SB;
+}
+
+void free_http_compression_lib() noexcept {
+  dl::CriticalSectionGuard critical_section;
+  end_stream_compression();
+}
@@ -0,0 +1,49 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "runtime/kphp_core.h"
+
+// The encodings accepted by the client, they are parsed from the Accept-Encoding header
+constexpr int32_t HTTP_ACCEPT_GZIP = 1;
+constexpr int32_t HTTP_ACCEPT_DEFLATE = 2;
+constexpr int32_t HTTP_ACCEPT_ZSTD = 8;
+
+enum class HttpEncoding {
+  identity,
+  gzip,
+  deflate,
+  zstd,
+};
+
+// The most effective encoding among the accepted ones
+HttpEncoding choose_http_encoding(int32_t accepted_encodings) noexcept;
+
+int32_t parse_http_accept_encoding(const char *header_value) noexcept;
+
+// Returns the whole header line, e.g. "Content-Encoding: gzip"
+const char *get_http_content_encoding_header(HttpEncoding encoding) noexcept;
+
+// The levels are set by a list like "6,65536:4,1048576:1",
+// the first level is used for the small bodies, the next ones for the bodies of the given size and greater;
+// gzip levels are used for deflate as well
+bool set_http_compression_levels(const char *encoding, const char *levels) noexcept;
+
+int32_t get_http_compression_level(HttpEncoding encoding, size_t body_size) noexcept;
+
+// The compressed bodies are kept between requests of the same worker, 0 disables the cache
+void set_http_compression_cache_size_limit(size_t limit) noexcept;
+
+const string_buffer *http_compress(HttpEncoding encoding, const char *s, int32_t s_len) noexcept;//returns pointer to static_SB
+
+// The body sent by parts is compressed as a single stream,
+// every part is flushed, so that the client can decode it without waiting for the next one
+void http_stream_compression_start(HttpEncoding encoding) noexcept;
+const string_buffer *http_stream_compress(const char *s, int32_t s_len, bool finish) noexcept;//returns pointer to static_SB
+
+void free_http_compression_lib() noexcept;
@@ -0,0 +1,483 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <cstring>
+
+#include "runtime/kphp_core.h"
+#include "runtime/misc.h"
+#include "runtime/shape.h"
+
+// instance_to_json() and instance_from_json() walk the typed fields of the instances with the generated visitors,
+// so the json is written from and parsed straight into the fields without the intermediate array<mixed>
+
+constexpr int32_t INSTANCE_JSON_MAX_DEPTH = 64;
+
+class InstanceToJsonVisitor {
+public:
+  InstanceToJsonVisitor(int64_t options, int32_t depth) :
+    options_(options),
+    depth_(depth) {
+  }
+
+  template<typename T>
+  void operator()(const char *field_name, const T &value) {
+    if (!is_first_field_) {
+      static_SB << ',';
+    }
+    is_first_field_ = false;
+    // the field names are php identifiers, they don't need escaping
+    static_SB << '"' << field_name << "\":";
+    is_ok_ &= encode(value);
+  }
+
+  bool is_ok() const {
+    return is_ok_;
+  }
+
+  bool encode(bool value) {
+    if (value) {
+      static_SB.append("true", 4);
+    } else {
+      static_SB.append("false", 5);
+    }
+    return true;
+  }
+
+  bool encode(int64_t value) {
+    static_SB << value;
+    return true;
+  }
+
+  bool encode(double value) {
+    return do_json_encode(mixed{value}, options_, false);
+  }
+
+  bool encode(const string &value) {
+    return do_json_encode(mixed{value}, options_, false);
+  }
+
+  bool encode(const mixed &value) {
+    return do_json_encode(value, options_, false);
+  }
+
+  template<typename T>
+  bool encode(const Optional<T> &value) {
+    if (value.has_value()) {
+      return encode(value.val());
+    }
+    if (value.is_false()) {
+      static_SB.append("false", 5);
+    } else {
+      static_SB.append("null", 4);
+    }
+    return true;
+  }
+
+  template<typename T>
+  bool encode(const array<T> &value) {
+    const bool is_vector = value.is_vector() && !(options_ & JSON_FORCE_OBJECT);
+    static_SB << "{["[is_vector];
+    bool ok = true;
+    for (auto it = value.begin(); it != value.end(); ++it) {
+      if (it != value.begin()) {
+        static_SB << ',';
+      }
+      if (!is_vector) {
+        const auto key = it.get_key();
+        if (array<T>::is_int_key(key)) {
+          static_SB << '"' << key.to_int() << '"';
+        } else {
+          ok &= encode(key.as_string());
+        }
+        static_SB << ':';
+      }
+      ok &= encode(it.get_value());
+    }
+    static_SB << "}]"[is_vector];
+    return ok;
+  }
+
+  template<typename I>
+  bool encode(const class_instance<I> &instance) {
+    if (instance.is_null()) {
+      static_SB.append("null", 4);
+      return true;
+    }
+    return encode_fields(instance, std::is_empty<I>{});
+  }
+
+  template<typename ...Args>
+  bool encode(const std::tuple<Args...> &value) {
+    static_SB << '[';
+    const bool ok = encode_tuple(value);
+    static_SB << ']';
+    return ok;
+  }
+
+  template<size_t ...Is, typename ...T>
+  bool encode(const shape<std::index_sequence<Is...>, T...> &value) {
+    // shape doesn't have key names at runtime, that's why it's encoded as a list like in instance_to_array()
+    static_SB << '[';
+    bool ok = true;
+    bool is_first = true;
+    std::initializer_list<int32_t>{((void)(ok &= encode_list_item(value.template get<Is>(), is_first)), 0)...};
+    static_SB << ']';
+    return ok;
+  }
+
+private:
+  template<typename I>
+  bool encode_fields(const class_instance<I> &, std::true_type /*is_empty*/) {
+    static_SB.append("{}", 2);
+    return true;
+  }
+
+  template<typename I>
+  bool encode_fields(const class_instance<I> &instance, std::false_type /*is_empty*/) {
+    if (depth_ >= INSTANCE_JSON_MAX_DEPTH) {
+      php_warning("maximum depth of nested instances exceeded in function instance_to_json");
+      static_SB.append("null", 4);
+      return false;
+    }
+    InstanceToJsonVisitor fields_visitor{options_, depth_ + 1};
+    static_SB << '{';
+    instance.get()->accept(fields_visitor);
+    static_SB << '}';
+    return fields_visitor.is_ok();
+  }
+
+  template<typename T>
+  bool encode_list_item(const T &value, bool &is_first) {
+    if (!is_first) {
+      static_SB << ',';
+    }
+    is_first = false;
+    return encode(value);
+  }
+
+  template<size_t Index = 0, typename ...Args>
+  std::enable_if_t<Index != sizeof...(Args), bool> encode_tuple(const std::tuple<Args...> &value) {
+    if (Index != 0) {
+      static_SB << ',';
+    }
+    const bool ok = encode(std::get<Index>(value));
+    return encode_tuple<Index + 1>(value) && ok;
+  }
+
+  template<size_t Index = 0, typename ...Args>
+  std::enable_if_t<Index == sizeof...(Args), bool> encode_tuple(const std::tuple<Args...> &) {
+    return true;
+  }
+
+  bool is_first_field_{true};
+  bool is_ok_{true};
+  const int64_t options_{0};
+  const int32_t depth_{0};
+};
+
+class JsonToInstanceDecoder;
+
+class InstanceFromJsonVisitor {
+public:
+  InstanceFromJsonVisitor(const string &key, JsonToInstanceDecoder &decoder) :
+    key_(key),
+    decoder_(decoder) {
+  }
+
+  // the generated accept() calls the visitor only for the fields which names have the same hash as the key
+  int64_t get_key_hash() const {
+    return key_.hash();
+  }
+
+  template<typename T>
+  void operator()(const char *field_name, T &value);
+
+  bool is_found() const {
+    return is_found_;
+  }
+
+  bool is_ok() const {
+    return is_ok_;
+  }
+
+private:
+  const string &key_;
+  JsonToInstanceDecoder &decoder_;
+  bool is_found_{false};
+  bool is_ok_{true};
+};
+
+class JsonToInstanceDecoder {
+public:
+  explicit JsonToInstanceDecoder(const string &json) :
+    json_(json.c_str()),
+    json_len_(static_cast<int>(json.size())) {
+  }
+
+  int get_pos() const {
+    return pos_;
+  }
+
+  bool is_finished() {
+    json_skip_blanks(json_, pos_);
+    return pos_ == json_len_;
+  }
+
+  bool decode(mixed &value) {
+    return do_json_decode(json_, json_len_, pos_, value);
+  }
+
+  bool decode(bool &value) {
+    if (try_skip_literal("true", 4)) {
+      value = true;
+      return true;
+    }
+    if (try_skip_literal("false", 5)) {
+      value = false;
+      return true;
+    }
+    return false;
+  }
+
+  bool decode(int64_t &value) {
+    // the scalars don't allocate inside the mixed
+    mixed scalar;
+    if (!decode_scalar(scalar) || !(scalar.is_int() || scalar.is_float())) {
+      return false;
+    }
+    value = scalar.to_int();
+    return true;
+  }
+
+  bool decode(double &value) {
+    mixed scalar;
+    if (!decode_scalar(scalar) || !(scalar.is_int() || scalar.is_float())) {
+      return false;
+    }
+    value = scalar.to_float();
+    return true;
+  }
+
+  bool decode(string &value) {
+    json_skip_blanks(json_, pos_);
+    mixed str;
+    if (json_[pos_] != '"' || !decode(str)) {
+      return false;
+    }
+    value = std::move(str.as_string());
+    return true;
+  }
+
+  template<typename T>
+  bool decode(Optional<T> &value) {
+    if (try_skip_literal("null", 4)) {
+      value = Optional<T>{};
+      return true;
+    }
+    if (!std::is_same<T, bool>{} && try_skip_literal("false", 5)) {
+      value = false;
+      return true;
+    }
+    T item{};
+    if (!decode(item)) {
+      return false;
+    }
+    value = std::move(item);
+    return true;
+  }
+
+  template<typename T>
+  bool decode(array<T> &value) {
+    json_skip_blanks(json_, pos_);
+    const char open = json_[pos_];
+    if ((open != '[' && open != '{') || !enter()) {
+      return false;
+    }
+    pos_++;
+    value = array<T>{};
+    const char close = open == '[' ? ']' : '}';
+    if (try_skip_char(close)) {
+      return leave();
+    }
+    do {
+      if (open == '[') {
+        T item{};
+        if (!decode(item)) {
+          return false;
+        }
+        value.push_back(std::move(item));
+      } else {
+        mixed key;
+        if (!decode_key(key) || !decode(value[key])) {
+          return false;
+        }
+      }
+    } while (try_skip_char(','));
+    return try_skip_char(close) && leave();
+  }
+
+  template<typename I>
+  bool decode(class_instance<I> &instance) {
+    if (try_skip_literal("null", 4)) {
+      instance = class_instance<I>{};
+      return true;
+    }
+    return decode_fields(instance, std::integral_constant<bool, std::is_empty<I>{} || std::is_abstract<I>{}>{});
+  }
+
+  template<typename ...Args>
+  bool decode(std::tuple<Args...> &value) {
+    if (!try_skip_char('[') || !enter()) {
+      return false;
+    }
+    return decode_tuple(value) && try_skip_char(']') && leave();
+  }
+
+  template<size_t ...Is, typename ...T>
+  bool decode(shape<std::index_sequence<Is...>, T...> &value) {
+    if (!try_skip_char('[') || !enter()) {
+      return false;
+    }
+    bool ok = true;
+    bool is_first = true;
+    std::initializer_list<int32_t>{((void)(ok = ok && decode_list_item(value.template get<Is>(), is_first)), 0)...};
+    return ok && try_skip_char(']') && leave();
+  }
+
+private:
+  template<typename I>
+  bool decode_fields(class_instance<I> &, std::true_type /*is_empty or is_abstract*/) {
+    return false;
+  }
+
+  template<typename I>
+  bool decode_fields(class_instance<I> &instance, std::false_type /*is_empty or is_abstract*/) {
+    if (!try_skip_char('{') || !enter()) {
+      return false;
+    }
+    instance = class_instance<I>{};
+    instance.alloc();
+    if (try_skip_char('}')) {
+      return leave();
+    }
+    do {
+      mixed key;
+      if (!decode_key(key)) {
+        return false;
+      }
+      InstanceFromJsonVisitor field_visitor{key.as_string(), *this};
+      instance.get()->accept(field_visitor);
+      if (!field_visitor.is_found()) {
+        // the unknown fields are skipped
+        mixed skipped;
+        if (!decode(skipped)) {
+          return false;
+        }
+      } else if (!field_visitor.is_ok()) {
+        return false;
+      }
+    } while (try_skip_char(','));
+    return try_skip_char('}') && leave();
+  }
+
+  template<typename T>
+  bool decode_list_item(T &value, bool &is_first) {
+    if (!is_first && !try_skip_char(',')) {
+      return false;
+    }
+    is_first = false;
+    return decode(value);
+  }
+
+  template<size_t Index = 0, typename ...Args>
+  std::enable_if_t<Index != sizeof...(Args), bool> decode_tuple(std::tuple<Args...> &value) {
+    if (Index != 0 && !try_skip_char(',')) {
+      return false;
+    }
+    return decode(std::get<Index>(value)) && decode_tuple<Index + 1>(value);
+  }
+
+  template<size_t Index = 0, typename ...Args>
+  std::enable_if_t<Index == sizeof...(Args), bool> decode_tuple(std::tuple<Args...> &) {
+    return true;
+  }
+
+  bool decode_key(mixed &key) {
+    json_skip_blanks(json_, pos_);
+    return json_[pos_] == '"' && decode(key) && try_skip_char(':');
+  }
+
+  bool decode_scalar(mixed &scalar) {
+    json_skip_blanks(json_, pos_);
+    const char c = json_[pos_];
+    return (c == '-' || ('0' <= c && c <= '9')) && decode(scalar);
+  }
+
+  bool try_skip_char(char c) {
+    json_skip_blanks(json_, pos_);
+    if (json_[pos_] != c) {
+      return false;
+    }
+    pos_++;
+    return true;
+  }
+
+  bool try_skip_literal(const char *literal, int len) {
+    json_skip_blanks(json_, pos_);
+    if (json_len_ - pos_ < len || std::memcmp(json_ + pos_, literal, len)) {
+      return false;
+    }
+    pos_ += len;
+    return true;
+  }
+
+  bool enter() {
+    return ++depth_ <= INSTANCE_JSON_MAX_DEPTH;
+  }
+
+  bool leave() {
+    --depth_;
+    return true;
+  }
+
+  const char *json_{nullptr};
+  int json_len_{0};
+  int pos_{0};
+  int32_t depth_{0};
+};
+
+template<typename T>
+void InstanceFromJsonVisitor::operator()(const char *field_name, T &value) {
+  if (!is_found_ && std::strlen(field_name) == key_.size() && !std::memcmp(field_name, key_.c_str(), key_.size())) {
+    is_found_ = true;
+    is_ok_ = decoder_.decode(value);
+  }
+}
+
+template<class T>
+Optional<string> f$instance_to_json(const class_instance<T> &instance, int64_t options = 0) {
+  if (options & ~JSON_AVAILABLE_OPTIONS) {
+    php_warning("Wrong parameter options = %ld in function instance_to_json", options);
+    return false;
+  }
+  static_SB.clean();
+  InstanceToJsonVisitor visitor{options, 0};
+  if (!visitor.encode(instance) && !(options & JSON_PARTIAL_OUTPUT_ON_ERROR)) {
+    return false;
+  }
+  return static_SB.str();
+}
+
+template<class ResultClass>
+ResultClass f$instance_from_json(const string &json, const string &/*class_name*/) {
+  ResultClass result;
+  JsonToInstanceDecoder decoder{json};
+  if (!decoder.decode(result) || !decoder.is_finished()) {
+    php_warning("Can't decode instance from json at pos %d in function instance_from_json", decoder.get_pos());
+    return {};
+  }
+  return result;
+}
@@ -14,9 +14,10 @@
 
 #include "runtime/allocator.h"
 #include "runtime/critical_section.h"
+#include "runtime/inter-process-epoch.h"
 #include "runtime/inter-process-mutex.h"
 #include "runtime/inter-process-resource.h"
-#include "runtime/memory_resource/resource_allocator.h"
+#include "runtime/memory_resource/persistent_map.h"
 #include "runtime/refcountable_php_classes.h"
 
 namespace ic_impl_ {
@@ -92,16 +93,34 @@ public:
     mem_resource.deallocate(this, sizeof(ElementHolder));
   }
 
-  ElementHolder(std::chrono::nanoseconds now, int64_t ttl,
-                std::unique_ptr<InstanceWrapperBase> &&instance,
-                CacheContext &context) noexcept:
+  ElementHolder(std::unique_ptr<InstanceWrapperBase> &&instance, CacheContext &context) noexcept:
     inserted_by_process(getpid()),
     instance_wrapper(std::move(instance)),
     cache_context(context) {
-    update_time_points(now, ttl);
     cache_context.stats.elements_created.fetch_add(1, std::memory_order_relaxed);
   }
 
+  // is reset on each ttl update, exactly one fetch after that gets the early expiration miss
+  std::atomic<bool> early_fetch_performed{false};
+  const pid_t inserted_by_process{0};
+
+  std::unique_ptr<InstanceWrapperBase> instance_wrapper;
+  CacheContext &cache_context;
+
+  // Removed elements list
+  std::atomic<ElementHolder *> next_in_garbage_list{nullptr};
+};
+
+// The time points are never changed in place: a modification replaces them in a copied storage node,
+// which is published with the next snapshot, so fetch never sees a torn combination of them
+struct ElementTimePoints {
+  ElementTimePoints() = default;
+
+  ElementTimePoints(std::chrono::nanoseconds now, int64_t ttl, std::chrono::nanoseconds previous_stored_at = std::chrono::nanoseconds::min()) noexcept:
+    stored_at(std::max(now, previous_stored_at)),
+    expiring_at(ttl > 0 ? stored_at + std::chrono::seconds{ttl} : std::chrono::nanoseconds::max()) {
+  }
+
   // returns how long the element is lived in relation to the expected lifetime
   double freshness_ratio(std::chrono::nanoseconds now, double immortal_ratio = 0.5) const noexcept {
     // an immortal element
@@ -116,25 +135,27 @@ public:
     return real_age.count() / max_age.count();
   }
 
-  void update_time_points(std::chrono::nanoseconds now, int64_t ttl) noexcept {
-    stored_at = std::max(now, stored_at);
-    expiring_at = ttl > 0 ? stored_at + std::chrono::seconds{ttl} : std::chrono::nanoseconds::max();
-    early_fetch_performed = false;
-  }
-
   std::chrono::nanoseconds stored_at{std::chrono::nanoseconds::min()};
   std::chrono::nanoseconds expiring_at{std::chrono::nanoseconds::max()};
-  bool early_fetch_performed{false};
-  const pid_t inserted_by_process{0};
-
-  std::unique_ptr<InstanceWrapperBase> instance_wrapper;
-  CacheContext &cache_context;
+};
 
-  // Removed elements list
-  std::atomic<ElementHolder *> next_in_garbage_list{nullptr};
+struct StoredElement {
+  vk::intrusive_ptr<ElementHolder> element;
+  ElementTimePoints time_points;
 };
 
-using ElementStorage_ = memory_resource::stl::map<string, vk::intrusive_ptr<ElementHolder>, memory_resource::unsynchronized_pool_resource, stl_string_less>;
+using ElementStorage_ = memory_resource::persistent_map<string, StoredElement, memory_resource::unsynchronized_pool_resource, stl_string_less>;
+
+// An immutable copy of the storage, which is read by fetch without any locks
+struct ElementStorageSnapshot : private vk::not_copyable {
+  explicit ElementStorageSnapshot(const ElementStorage_ &storage) noexcept:
+    storage(storage) {
+  }
+
+  const ElementStorage_ storage;
+  uint64_t retired_at_epoch{0};
+  ElementStorageSnapshot *next_retired{nullptr};
+};
 
 struct SharedDataStorages : private vk::not_copyable {
   explicit SharedDataStorages(memory_resource::unsynchronized_pool_resource &resource) :
@@ -142,7 +163,12 @@ struct SharedDataStorages : private vk::not_copyable {
   }
 
   inter_process_mutex storage_mutex;
+  // is modified under the storage_mutex and published after each modification
   ElementStorage_ storage;
+  std::atomic<ElementStorageSnapshot *> published_storage{nullptr};
+  // previously published snapshots, which may still be read by fetch
+  ElementStorageSnapshot *retired_storages{nullptr};
+  // there are neither elements nor retired snapshots, so the purge can skip the shard
   std::atomic<bool> is_storage_empty{true};
 };
 
@@ -263,6 +289,9 @@ public:
   void global_init() {
     php_assert(!current_ && !context_);
     data_manager_.init(instance_cache_settings.total_memory_limit);
+    void *reading_epochs_mem = mmap(nullptr, sizeof(*reading_epochs_), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
+    php_assert(reading_epochs_mem);
+    reading_epochs_ = new(reading_epochs_mem) InterProcessEpochControl{};
   }
 
   void refresh() {
@@ -280,9 +309,10 @@ public:
     php_assert(current_ && context_);
     sync_delayed();
 
-    // request_cache_ and storing_delayed_ use a script memory
-    storing_delayed_.clear();
-    request_cache_.clear();
+    // request_cache_ and storing_delayed_ use a script memory, which is dropped entirely after the request,
+    // they don't own anything outside of it, so there is no need to destroy their elements one by one
+    hard_reset_var(storing_delayed_);
+    hard_reset_var(request_cache_);
     // used_elements use a heap memory
     used_elements_.clear();
 
@@ -356,9 +386,12 @@ public:
     bool element_logically_expired = false;
     {
       auto &data = current_->get_data(key);
-      std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
-      auto it = data.storage.find(key);
-      if (it == data.storage.end()) {
+      // the snapshot with all its elements is kept by writers until the reading is finished;
+      // the reading mustn't be interrupted by a timeout, otherwise the epoch of this worker stays announced
+      dl::CriticalSectionGuard critical_section;
+      auto reading_guard = reading_epochs_->reading_guard();
+      const StoredElement *stored_element = find_published_element(data, key);
+      if (!stored_element) {
         ic_debug("can't fetch '%s' because it is absent\n", key.c_str());
         context_->stats.elements_missed.fetch_add(1, std::memory_order_relaxed);
         return nullptr;
@@ -367,15 +400,16 @@ public:
       update_now();
       // if more than EARLY_EXPIRATION_ELEMENT_RATIO time is passed out of the expected element lifetime,
       // return null to the next worker process so it knows that the value needs to be updated in advance
-      if (!it->second->early_fetch_performed &&
-          it->second->freshness_ratio(now_) >= EARLY_EXPIRATION_ELEMENT_RATIO) {
-        it->second->early_fetch_performed = true;
+      auto &early_fetch_performed = stored_element->element->early_fetch_performed;
+      if (!early_fetch_performed.load(std::memory_order_relaxed) &&
+          stored_element->time_points.freshness_ratio(now_) >= EARLY_EXPIRATION_ELEMENT_RATIO &&
+          !early_fetch_performed.exchange(true)) {
         context_->stats.elements_missed_earlier.fetch_add(1, std::memory_order_relaxed);
         ic_debug("can't fetch '%s' because less than %f of total time is left\n",
                  key.c_str(), EARLY_EXPIRATION_ELEMENT_RATIO);
         return nullptr;
       }
-      element_logically_expired = it->second->expiring_at <= now_;
+      element_logically_expired = stored_element->time_points.expiring_at <= now_;
       if (element_logically_expired) {
         if (even_if_expired) {
           context_->stats.elements_logically_expired_but_fetched.fetch_add(1, std::memory_order_relaxed);
@@ -390,7 +424,7 @@ public:
         ic_debug("fetch '%s' from inter process cache\n", key.c_str());
       }
 
-      element = it->second;
+      element = stored_element->element;
     }
 
     // don't cache logically expired elements
@@ -416,16 +450,11 @@ public:
       delayed_instance->get()->ttl = ttl;
     }
 
-    auto &data = current_->get_data(key);
     update_now();
-    std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
-    auto it = data.storage.find(key);
-    if (it == data.storage.end()) {
-      return false;
-    }
-
-    it->second->update_time_points(now_, ttl);
-    return true;
+    return update_time_points(current_->get_data(key), key, [this, ttl](StoredElement &stored_element) {
+      stored_element.time_points = ElementTimePoints{now_, ttl, stored_element.time_points.stored_at};
+      stored_element.element->early_fetch_performed = false;
+    });
   }
 
   bool del(const string &key) {
@@ -435,25 +464,23 @@ public:
     // request_cache_ and storing_delayed_ use a script memory
     storing_delayed_.unset(key);
     request_cache_.unset(key);
-    auto &data = current_->get_data(key);
     update_now();
-    std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
-    auto it = data.storage.find(key);
-    if (it == data.storage.end()) {
-      return false;
-    }
-
-    // calculate expiring_at in a way that the next fetch returns false
-    constexpr double SCALE = 1.0 / EARLY_EXPIRATION_ELEMENT_RATIO;
-    auto new_element_ttl = std::chrono::duration_cast<std::chrono::nanoseconds>((now_ - it->second->stored_at) * SCALE);
-    auto new_expiring_at = std::chrono::duration_cast<std::chrono::nanoseconds>(it->second->stored_at + new_element_ttl);
-    new_expiring_at = std::min(new_expiring_at, now_ + DELETED_ELEMENT_LIFETIME_LIMIT);
-    it->second->expiring_at = std::max(new_expiring_at, it->second->stored_at);
-    return true;
+    return update_time_points(current_->get_data(key), key, [this](StoredElement &stored_element) {
+      // calculate expiring_at in a way that the next fetch returns false
+      constexpr double SCALE = 1.0 / EARLY_EXPIRATION_ELEMENT_RATIO;
+      const std::chrono::nanoseconds stored_at = stored_element.time_points.stored_at;
+      auto new_element_ttl = std::chrono::duration_cast<std::chrono::nanoseconds>((now_ - stored_at) * SCALE);
+      auto new_expiring_at = std::chrono::duration_cast<std::chrono::nanoseconds>(stored_at + new_element_ttl);
+      new_expiring_at = std::min(new_expiring_at, now_ + DELETED_ELEMENT_LIFETIME_LIMIT);
+      stored_element.time_points.expiring_at = std::max(new_expiring_at, stored_at);
+    });
   }
 
   void force_release_all_resources() {
     data_manager_.force_release_all_resources();
+    if (reading_epochs_) {
+      reading_epochs_->force_leave_reading();
+    }
   }
 
   // this function should be called only from master
@@ -477,9 +504,10 @@ public:
       }
       {
         std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
-        if (std::none_of(data_shard.storage.begin(), data_shard.storage.end(),
+        if (!data_shard.retired_storages &&
+            std::none_of(data_shard.storage.begin(), data_shard.storage.end(),
                          [now_with_delay](const auto &stored_element) {
-                           return stored_element.second->expiring_at <= now_with_delay;
+                           return stored_element.second.time_points.expiring_at <= now_with_delay;
                          })) {
           continue;
         }
@@ -488,19 +516,28 @@ public:
       // lock in this very order and do not move allocator_lock anywhere below, otherwise it will result in a deadlock!
       std::lock_guard<inter_process_mutex> allocator_lock{context.allocator_mutex};
       std::lock_guard<inter_process_mutex> shared_data_lock{data_shard.storage_mutex};
-      for (auto it = data_shard.storage.begin(); it != data_shard.storage.end();) {
-        if (it->second->expiring_at <= now_with_delay) {
-          ic_debug("purge '%s'\n", it->first.c_str());
-          string removing_key = it->first;
-          it = data_shard.storage.erase(it);
-          DeepDestroyFromCacheVisitor{}.process(removing_key);
+      reclaim_retired_storages(context, data_shard);
+      bool storage_updated = false;
+      // the published snapshot is identical to the storage, but it isn't changed by erasing
+      if (const auto *published_storage = data_shard.published_storage.load()) {
+        for (const auto &stored_element : published_storage->storage) {
+          if (stored_element.second.time_points.expiring_at > now_with_delay) {
+            continue;
+          }
+          if (unlikely(!context.memory_resource.is_enough_memory_for(get_storage_modification_memory_usage()))) {
+            break;
+          }
+          ic_debug("purge '%s'\n", stored_element.first.c_str());
+          data_shard.storage.erase(stored_element.first);
+          storage_updated = true;
           context.stats.elements_expired.fetch_add(1, std::memory_order_relaxed);
           context.stats.elements_cached.fetch_sub(1, std::memory_order_relaxed);
-        } else {
-          ++it;
         }
       }
-      data_shard.is_storage_empty.store(data_shard.storage.empty(), std::memory_order_relaxed);
+      if (storage_updated) {
+        publish_storage(context, data_shard);
+      }
+      data_shard.is_storage_empty.store(data_shard.storage.empty() && !data_shard.retired_storages, std::memory_order_relaxed);
     }
 
     purge_shard_offset_ = (purge_shard_offset_ + 1) % SHARDS_PURGE_PERIOD;
@@ -539,8 +576,8 @@ private:
     auto it = data.storage.find(key);
     // allow to skip the insertion of the element if it was inserted by another process recently enough
     if (it != data.storage.end() &&
-        it->second->freshness_ratio(now_) < FRESHNESS_ELEMENT_RATIO &&
-        it->second->inserted_by_process != getpid()) {
+        it->second.time_points.freshness_ratio(now_) < FRESHNESS_ELEMENT_RATIO &&
+        it->second.element->inserted_by_process != getpid()) {
       ic_debug("skip '%s' because it was recently updated\n", key.c_str());
       context_->stats.elements_storing_skipped_due_recent_update.fetch_add(1, std::memory_order_relaxed);
       return true;
@@ -606,38 +643,104 @@ private:
     // moving an instance into a shared memory
     if (auto cached_instance_wrapper = instance_wrapper.clone_and_detach_shared_ref(detach_processor)) {
       if (void *mem = detach_processor.prepare_raw_memory(sizeof(ElementHolder))) {
-        vk::intrusive_ptr<ElementHolder> element{new(mem) ElementHolder{now_, ttl, std::move(cached_instance_wrapper), *context_}};
+        vk::intrusive_ptr<ElementHolder> element{new(mem) ElementHolder{std::move(cached_instance_wrapper), *context_}};
         std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
-        auto it = data.storage.find(key_in_script_memory);
-        if (it == data.storage.end()) {
-          string key_in_shared_memory = key_in_script_memory;
-          if (unlikely(!detach_processor.process(key_in_shared_memory))) {
-            return nullptr;
-          }
-          constexpr auto node_max_size = ElementStorage_::allocator_type::max_value_type_size();
-          if (unlikely(!detach_processor.is_enough_memory_for(node_max_size))) {
-            DeepDestroyFromCacheVisitor{}.process(key_in_shared_memory);
-            return nullptr;
-          }
+        reclaim_retired_storages(*context_, data);
+        const size_t required_memory = key_in_script_memory.estimate_memory_usage() + get_storage_modification_memory_usage();
+        if (unlikely(!detach_processor.is_enough_memory_for(required_memory))) {
+          return nullptr;
+        }
 
-          it = data.storage.emplace(std::move(key_in_shared_memory), vk::intrusive_ptr<ElementHolder>{}).first;
+        auto *stored_element = data.storage.find_for_update(key_in_script_memory);
+        if (!stored_element) {
+          // the key is shared by the copies of the storage nodes, so it has a regular reference counter
+          stored_element = data.storage.try_emplace(key_in_script_memory.copy_and_make_not_shared()).first;
           data.is_storage_empty.store(false, std::memory_order_relaxed);
           context_->stats.elements_cached.fetch_add(1, std::memory_order_relaxed);
         }
         // replace element and save previous element into used_elements_;
         // it'll make it possible to free it without taking a storage_mutex lock
-        it->second.swap(element);
+        stored_element->second.element.swap(element);
+        stored_element->second.time_points = ElementTimePoints{now_, ttl};
         if (element) {
           // used_elements_ uses heap memory for its internal allocations
           used_elements_.emplace(std::move(element));
         }
-        used_elements_.emplace(it->second);
-        return it->second.get();
+        used_elements_.emplace(stored_element->second.element);
+        publish_storage(*context_, data);
+        return stored_element->second.element.get();
       }
     }
     return nullptr;
   }
 
+  static const StoredElement *find_published_element(const SharedDataStorages &data, const string &key) noexcept {
+    const auto *published_storage = data.published_storage.load();
+    if (!published_storage) {
+      return nullptr;
+    }
+    auto it = published_storage->storage.find(key);
+    return it != published_storage->storage.end() ? &it->second : nullptr;
+  }
+
+  // modifies the stored element in a copied storage node and publishes the storage, returns false if there is no such key
+  template<class F>
+  bool update_time_points(SharedDataStorages &data, const string &key, const F &update) noexcept {
+    // swap the allocator, the copied nodes and the snapshot are allocated in the shared memory
+    auto shared_memory_guard = context_->memory_replacement_guard();
+    // locking strictly before the storage_mutex to avoid a deadlock
+    std::lock_guard<inter_process_mutex> allocator_lock{context_->allocator_mutex};
+    auto clear_garbage = vk::finally([this] { context_->clear_garbage(); });
+
+    std::lock_guard<inter_process_mutex> shared_data_lock{data.storage_mutex};
+    reclaim_retired_storages(*context_, data);
+    if (data.storage.find(key) == data.storage.end()) {
+      return false;
+    }
+    if (unlikely(!context_->memory_resource.is_enough_memory_for(get_storage_modification_memory_usage()))) {
+      php_warning("Memory limit exceeded on updating the instance cache element '%s'", key.c_str());
+      context_->memory_swap_required = true;
+      return false;
+    }
+    update(data.storage.find_for_update(key)->second);
+    publish_storage(*context_, data);
+    return true;
+  }
+
+  static constexpr size_t get_storage_modification_memory_usage() noexcept {
+    return ElementStorage_::max_modification_memory_usage() + sizeof(ElementStorageSnapshot);
+  }
+
+  // should be called under the allocator_mutex and the storage_mutex with the replaced script allocator
+  void publish_storage(CacheContext &context, SharedDataStorages &data) noexcept {
+    void *mem = context.memory_resource.allocate(sizeof(ElementStorageSnapshot));
+    php_assert(mem);
+    auto *previous_storage = data.published_storage.exchange(new(mem) ElementStorageSnapshot{data.storage});
+    if (previous_storage) {
+      previous_storage->retired_at_epoch = reading_epochs_->retire();
+      previous_storage->next_retired = data.retired_storages;
+      data.retired_storages = previous_storage;
+    }
+  }
+
+  // should be called under the allocator_mutex and the storage_mutex with the replaced script allocator
+  void reclaim_retired_storages(CacheContext &context, SharedDataStorages &data) noexcept {
+    if (!data.retired_storages) {
+      return;
+    }
+    const uint64_t oldest_reading_epoch = reading_epochs_->get_oldest_reading_epoch();
+    for (ElementStorageSnapshot **retired = &data.retired_storages; *retired;) {
+      ElementStorageSnapshot *snapshot = *retired;
+      if (snapshot->retired_at_epoch < oldest_reading_epoch) {
+        *retired = snapshot->next_retired;
+        snapshot->~ElementStorageSnapshot();
+        context.memory_resource.deallocate(snapshot, sizeof(ElementStorageSnapshot));
+      } else {
+        retired = &snapshot->next_retired;
+      }
+    }
+  }
+
   void fire_warning(const DeepMoveFromScriptToCacheVisitor &detach_processor, const char *class_name) noexcept {
     if (detach_processor.is_depth_limit_exceeded()) {
       php_warning("Depth limit exceeded on cloning instance of class '%s' into cache", class_name);
@@ -651,6 +754,8 @@ private:
   SharedMemoryData *current_{nullptr};
   CacheContext *context_{nullptr};
   InterProcessResourceManager<SharedMemoryData, 2> data_manager_;
+  // placed into a shared memory, makes fetch possible without taking a storage_mutex lock
+  InterProcessEpochControl *reading_epochs_{nullptr};
 
 
   struct IntrusivePtrHash {
@@ -12,7 +12,10 @@
 //    therefore the reference counter of cached strings and arrays is ExtraRefCnt::for_instance_cache or ExtraRefCnt::for_global_const;
 //  3) On fetch, all strings and arrays are returned as is;
 //  4) On store, all instances (and sub instances) are deeply cloned into instance cache;
-//  5) On fetch, all instances (and sub instances) are deeply cloned from instance cache;
+//  5) On fetch, instances are never cloned: only immutable classes can be fetched (check is_immutable_class),
+//    therefore they are returned as references into instance cache; as well as for strings and arrays,
+//    the reference counter ExtraRefCnt::for_instance_cache is greater than ExtraRefCnt::for_global_const,
+//    so the script never changes or releases it;
 //  6) All instances (with all members) are destroyed strictly before or after request,
 //    and shouldn't be destroyed while request.
 
@@ -267,6 +270,7 @@ public:
     return make_unique_on_script_memory<InstanceWrapper<class_instance<I>>>(instance_);
   }
 
+  // the instance isn't copied, it points into the instance cache (or into the script memory if the storing is delayed)
   class_instance<I> get_instance() const noexcept {
     return instance_;
   }
@@ -344,6 +348,8 @@ bool f$instance_cache_store(const string &key, const ClassInstanceType &instance
 template<typename ClassInstanceType>
 ClassInstanceType f$instance_cache_fetch(const string &class_name, const string &key, bool even_if_expired = false) {
   static_assert(is_class_instance<ClassInstanceType>::value, "class_instance<> type expected");
+  static_assert(is_immutable_class<typename ClassInstanceType::ClassType>::value,
+                "only instances of immutable classes can be fetched, they are shared with the instance cache");
   if (const auto *base_wrapper = ic_impl_::instance_cache_fetch_wrapper(key, even_if_expired)) {
     // do not use first parameter (class name) for verifying type,
     // because different classes from separated libs may have same names
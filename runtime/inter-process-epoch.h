@@ -0,0 +1,74 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "common/cacheline.h"
+#include "common/containers/final_action.h"
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/php_assert.h"
+#include "server/php-engine-vars.h"
+
+// Epoch based reclamation of the data shared between processes:
+// readers announce the epoch they read in and never wait for anything;
+// a writer unpublishes the data, retires it with the current epoch,
+// and frees it when all readers have left the epochs in which the data could be seen.
+// Should be placed into a shared memory.
+class InterProcessEpochControl : vk::not_copyable {
+public:
+  void enter_reading() noexcept {
+    auto &reader_epoch = readers_[get_reader_index()].epoch;
+    php_assert(!reader_epoch.load(std::memory_order_relaxed));
+    reader_epoch.store(current_epoch_.load());
+  }
+
+  void leave_reading() noexcept {
+    readers_[get_reader_index()].epoch.store(0, std::memory_order_release);
+  }
+
+  auto reading_guard() noexcept {
+    enter_reading();
+    return vk::finally([this] { leave_reading(); });
+  }
+
+  // returns the epoch of the retiring data, should be called strictly after the data has been unpublished
+  uint64_t retire() noexcept {
+    return current_epoch_.fetch_add(1);
+  }
+
+  // the data retired in the epochs before the returned one can be freed;
+  // all the slots are scanned, since the reader index isn't bounded by the current workers number
+  uint64_t get_oldest_reading_epoch() const noexcept {
+    uint64_t oldest_epoch = current_epoch_.load();
+    for (const auto &reader : readers_) {
+      const uint64_t reader_epoch = reader.epoch.load();
+      if (reader_epoch && reader_epoch < oldest_epoch) {
+        oldest_epoch = reader_epoch;
+      }
+    }
+    return oldest_epoch;
+  }
+
+  // the process may have been killed while reading, the new one with the same index continues from scratch
+  void force_leave_reading() noexcept {
+    leave_reading();
+  }
+
+private:
+  static size_t get_reader_index() noexcept {
+    php_assert(logname_id >= 0 && logname_id < MAX_WORKERS);
+    return static_cast<size_t>(logname_id);
+  }
+
+  struct alignas(KDB_CACHELINE_SIZE) ReaderEpoch {
+    std::atomic<uint64_t> epoch{0};
+  };
+
+  std::atomic<uint64_t> current_epoch_{1};
+  std::array<ReaderEpoch, MAX_WORKERS> readers_;
+};
@@ -25,6 +25,7 @@
 #include "runtime/datetime.h"
 #include "runtime/exception.h"
 #include "runtime/files.h"
+#include "runtime/http-compression.h"
 #include "runtime/instance_cache.h"
 #include "runtime/kphp-backtrace.h"
 #include "runtime/math_functions.h"
@@ -42,7 +43,6 @@
 #include "runtime/typed_rpc.h"
 #include "runtime/udp.h"
 #include "runtime/url.h"
-#include "runtime/zlib.h"
 #include "server/json-logger.h"
 #include "server/php-engine-vars.h"
 #include "server/php-queries.h"
@@ -55,6 +55,8 @@ static enum {
   QUERY_TYPE_RPC
 } query_type;
 static bool is_head_query;
+// the headers and a part of the body are sent already by flush, the rest of the body will be sent in chunks
+static bool http_streaming;
 
 static const string HTTP_DATE("D, d M Y H:i:s \\G\\M\\T", 21);
 
@@ -118,6 +120,9 @@ void f$ob_flush() {
   --ob_cur_buffer;
   coub = &oub[ob_cur_buffer];
   print(oub[ob_cur_buffer + 1]);
+  if (ob_cur_buffer == 0 && http_streaming) {
+    f$flush();
+  }
   ++ob_cur_buffer;
   coub = &oub[ob_cur_buffer];
   f$ob_clean();
@@ -222,7 +227,16 @@ static bool check_status_line(const char *str, int str_len) {
   return true;
 }
 
+// ob_start('ob_gzhandler') has been called, the response is compressed with the best encoding accepted by the client
+static HttpEncoding get_http_response_encoding() {
+  return (http_need_gzip & 4) ? choose_http_encoding(http_need_gzip) : HttpEncoding::identity;
+}
+
 static void header(const char *str, int str_len, bool replace = true, int http_response_code = 0) {
+  if (http_streaming) {
+    php_warning("Cannot modify header information - headers already sent");
+    return;
+  }
   if (dl::query_num != header_last_query_num) {
     new(headers_storage) array<string>();
     header_last_query_num = dl::query_num;
@@ -410,12 +424,13 @@ static inline const char *http_get_error_msg_text(int *code) {
   return "Extension Code";
 }
 
+// the negative content_length means that the length is unknown, the body will be streamed
 static const string_buffer *get_headers(int content_length) {//can't use static_SB, returns pointer to static_SB_spare
   string date = f$gmdate(HTTP_DATE);
   static_SB_spare.clean() << "Date: " << date;
   header(static_SB_spare.c_str(), (int)static_SB_spare.size());
 
-  if (!is_head_query) {
+  if (!is_head_query && content_length >= 0) {
     static_SB_spare.clean() << "Content-Length: " << content_length;
     header(static_SB_spare.c_str(), (int)static_SB_spare.size());
   }
@@ -481,20 +496,26 @@ void f$fastcgi_finish_request(int64_t exit_code) {
       break;
     }
     case QUERY_TYPE_HTTP: {
+      const HttpEncoding encoding = get_http_response_encoding();
+      if (http_streaming) {
+        const string_buffer *last_part = &oub[first_not_empty_buffer];
+        if (encoding != HttpEncoding::identity) {
+          last_part = http_stream_compress(last_part->buffer(), last_part->size(), true);
+        }
+        http_set_result(nullptr, 0, last_part->buffer(), last_part->size(), static_cast<int32_t>(exit_code));
+        break;
+      }
+
       const string_buffer *compressed;
       if (is_head_query) {
         oub[first_not_empty_buffer].clean();
         compressed = &oub[first_not_empty_buffer];
+      } else if (encoding != HttpEncoding::identity) {
+        const char *content_encoding = get_http_content_encoding_header(encoding);
+        header(content_encoding, static_cast<int>(strlen(content_encoding)), true);
+        compressed = http_compress(encoding, oub[first_not_empty_buffer].c_str(), oub[first_not_empty_buffer].size());
       } else {
-        if ((http_need_gzip & 5) == 5) {
-          header("Content-Encoding: gzip", 22, true);
-          compressed = zlib_encode(oub[first_not_empty_buffer].c_str(), oub[first_not_empty_buffer].size(), 6, ZLIB_ENCODE);
-        } else if ((http_need_gzip & 6) == 6) {
-          header("Content-Encoding: deflate", 25, true);
-          compressed = zlib_encode(oub[first_not_empty_buffer].c_str(), oub[first_not_empty_buffer].size(), 6, ZLIB_COMPRESS);
-        } else {
-          compressed = &oub[first_not_empty_buffer];
-        }
+        compressed = &oub[first_not_empty_buffer];
       }
 
       const string_buffer *headers = get_headers(compressed->size());
@@ -517,6 +538,34 @@ void f$fastcgi_finish_request(int64_t exit_code) {
   coub->clean();
 }
 
+void f$flush() {
+  // the response to HEAD is sent at once in the end of the script
+  if (query_type != QUERY_TYPE_HTTP || flushed || is_head_query) {
+    return;
+  }
+
+  const HttpEncoding encoding = get_http_response_encoding();
+  const string_buffer *headers = nullptr;
+  if (!http_streaming) {
+    if (encoding != HttpEncoding::identity) {
+      const char *content_encoding = get_http_content_encoding_header(encoding);
+      header(content_encoding, static_cast<int>(strlen(content_encoding)), true);
+      http_stream_compression_start(encoding);
+    }
+    headers = get_headers(-1);
+    http_streaming = true;
+  }
+
+  const string_buffer *body = &oub[0];
+  if (encoding != HttpEncoding::identity && oub[0].size()) {
+    body = http_stream_compress(oub[0].buffer(), oub[0].size(), false);
+  }
+  if (headers || body->size()) {
+    http_send_chunk(headers ? headers->buffer() : nullptr, headers ? headers->size() : 0, body->buffer(), body->size());
+  }
+  oub[0].clean();
+}
+
 void f$register_shutdown_function(const shutdown_function_type &f) {
   if (shutdown_functions_count == MAX_SHUTDOWN_FUNCTIONS) {
     php_warning("Too many shutdown functions registered, ignore next one\n");
@@ -1414,12 +1463,7 @@ static void init_superglobals(const http_query_data &http_data, const rpc_query_
       header_value = f$trim(header_value);
 
       if (!strcmp(header_name.c_str(), "accept-encoding")) {
-        if (strstr(header_value.c_str(), "gzip") != nullptr) {
-          http_need_gzip |= 1;
-        }
-        if (strstr(header_value.c_str(), "deflate") != nullptr) {
-          http_need_gzip |= 2;
-        }
+        http_need_gzip |= parse_http_accept_encoding(header_value.c_str());
       } else if (!strcmp(header_name.c_str(), "cookie")) {
         array<string> cookie = explode(';', header_value);
         for (int t = 0; t < (int)cookie.count(); t++) {
@@ -2106,6 +2150,7 @@ static void init_runtime_libs() {
   shutdown_functions_count = 0;
   finished = false;
   flushed = false;
+  http_streaming = false;
 
   php_warning_level = std::max(2, php_warning_minimum_level);
   php_disable_warnings = 0;
@@ -2148,6 +2193,7 @@ static void free_runtime_libs() {
   free_typed_rpc_lib();
   free_streams_lib();
   free_udp_lib();
+  free_http_compression_lib();
   OnKphpWarningCallback::get().reset();
   vk::singleton<JsonLogger>::get().reset_buffers();
 
@@ -2191,6 +2237,9 @@ void init_runtime_environment(php_query_data *data, void *mem, size_t mem_size)
   init_superglobals(data);
 }
 
+// The script memory is dropped entirely after the request, therefore the variables which own only the script memory
+// are reset with hard_reset_var without calling their destructors, only the resources with external side effects
+// (files, sockets, shared memory, heap memory) are released one by one
 void free_runtime_environment() {
   reset_superglobals();
   free_runtime_libs();
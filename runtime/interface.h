@@ -47,6 +47,8 @@ void f$register_shutdown_function(const shutdown_function_type &f);
 
 void f$fastcgi_finish_request(int64_t exit_code = 0);
 
+void f$flush();
+
 __attribute__((noreturn))
 void finish(int64_t exit_code);
 
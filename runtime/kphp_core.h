@@ -1355,6 +1355,7 @@ array<int64_t> f$memory_get_detailed_stats() {
       std::make_pair(string{"defragmentation_calls"}, static_cast<int64_t>(stats.defragmentation_calls)),
       std::make_pair(string{"huge_memory_pieces"}, static_cast<int64_t>(stats.huge_memory_pieces)),
       std::make_pair(string{"small_memory_pieces"}, static_cast<int64_t>(stats.small_memory_pieces)),
+      std::make_pair(string{"memory_slabs"}, static_cast<int64_t>(stats.memory_slabs)),
       std::make_pair(string{"heap_memory_used"}, static_cast<int64_t>(dl::get_heap_memory_used()))
     });
 }
@@ -40,6 +40,17 @@ template<typename T>
 struct is_class_instance<class_instance<T>> : std::true_type {
 };
 
+// The compiler marks the classes annotated with @kphp-immutable-class by 'using immutable_class_tag = <the class itself>;',
+// the tag inherited from an immutable base doesn't make a derived class immutable
+template<typename T, typename = void>
+struct is_immutable_class : std::false_type {
+};
+
+template<typename T>
+struct is_immutable_class<T, std::enable_if_t<std::is_class<typename T::immutable_class_tag>{}>> :
+  std::is_same<typename T::immutable_class_tag, T> {
+};
+
 template<typename T>
 struct is_class_instance_inside : is_class_instance<T> {
 };
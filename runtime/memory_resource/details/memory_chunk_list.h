@@ -27,6 +27,10 @@ public:
     next_ = new(block) memory_chunk_list{next_};
   }
 
+  bool empty() const noexcept {
+    return !next_;
+  }
+
 private:
   explicit memory_chunk_list(memory_chunk_list *next) noexcept :
     next_(next) {
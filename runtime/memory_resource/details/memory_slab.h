@@ -0,0 +1,100 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "common/mixin/not_copyable.h"
+
+#include "runtime/memory_resource/details/memory_chunk_list.h"
+#include "runtime/php_assert.h"
+
+namespace memory_resource {
+namespace details {
+
+// A slab is a piece of SIZE bytes, which is split into the pieces of the same size.
+// The header with the free pieces bitmap is placed at the beginning of the slab,
+// the slabs are aligned by SIZE relative to the beginning of the memory buffer,
+// therefore the slab of a piece can be found by its address.
+class memory_slab : vk::not_copyable {
+public:
+  static constexpr size_t SIZE{16u * 1024u};
+  static constexpr size_t MAX_PIECE_SIZE{512u};
+
+  static memory_slab *create(void *mem, size_t piece_size) noexcept {
+    return new(mem) memory_slab{piece_size};
+  }
+
+  static memory_slab *of_piece(void *piece, char *memory_begin) noexcept {
+    const auto offset = static_cast<size_t>(static_cast<char *>(piece) - memory_begin);
+    return reinterpret_cast<memory_slab *>(memory_begin + (offset & ~(SIZE - 1)));
+  }
+
+  static bool is_aligned(void *mem, char *memory_begin) noexcept {
+    return !(static_cast<size_t>(static_cast<char *>(mem) - memory_begin) & (SIZE - 1));
+  }
+
+  void *allocate() noexcept {
+    php_assert(free_pieces_);
+    while (!free_bits_[first_free_word_]) {
+      ++first_free_word_;
+    }
+    uint64_t &word = free_bits_[first_free_word_];
+    const auto bit = static_cast<size_t>(__builtin_ctzll(word));
+    word &= word - 1;
+    --free_pieces_;
+    return pieces_begin() + (first_free_word_ * 64 + bit) * piece_size_;
+  }
+
+  void deallocate(void *piece) noexcept {
+    const auto index = static_cast<size_t>(static_cast<char *>(piece) - pieces_begin()) / piece_size_;
+    const size_t word_index = index / 64;
+    const uint64_t bit = uint64_t{1} << (index % 64);
+    php_assert(word_index < free_bits_.size() && !(free_bits_[word_index] & bit));
+    free_bits_[word_index] |= bit;
+    first_free_word_ = std::min(first_free_word_, word_index);
+    ++free_pieces_;
+  }
+
+  size_t piece_size() const noexcept { return piece_size_; }
+  bool is_full() const noexcept { return !free_pieces_; }
+  bool is_empty() const noexcept { return free_pieces_ == pieces_count_; }
+
+  // the slabs with free pieces of the same size are linked into a list
+  memory_slab *prev{nullptr};
+  memory_slab *next{nullptr};
+
+private:
+  explicit memory_slab(size_t piece_size) noexcept:
+    piece_size_(static_cast<uint32_t>(piece_size)),
+    pieces_count_(static_cast<uint32_t>((SIZE - sizeof(memory_slab)) / piece_size)),
+    free_pieces_(pieces_count_) {
+    php_assert(piece_size && piece_size <= MAX_PIECE_SIZE && align_for_chunk(piece_size) == piece_size);
+    const size_t full_words = pieces_count_ / 64;
+    std::fill(free_bits_.begin(), free_bits_.begin() + full_words, ~uint64_t{0});
+    if (const size_t rest = pieces_count_ % 64) {
+      free_bits_[full_words] = (uint64_t{1} << rest) - 1;
+    }
+  }
+
+  char *pieces_begin() noexcept {
+    return reinterpret_cast<char *>(this) + sizeof(memory_slab);
+  }
+
+  const uint32_t piece_size_{0};
+  const uint32_t pieces_count_{0};
+  uint32_t free_pieces_{0};
+  size_t first_free_word_{0};
+  // the set bit means that the piece is free
+  std::array<uint64_t, SIZE / 8 / 64> free_bits_{};
+};
+
+static_assert(sizeof(memory_slab) % 8 == 0, "the pieces of the slab should be aligned as chunks");
+static_assert(sizeof(memory_slab) + memory_slab::MAX_PIECE_SIZE <= memory_slab::SIZE, "the slab should contain at least one piece");
+
+} // namespace details
+} // namespace memory_resource
@@ -0,0 +1,394 @@
+// Compiler for PHP (aka KPHP)
+// Copyright (c) 2020 LLC «V Kontakte»
+// Distributed under the GPL v3 License, see LICENSE.notice.txt
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "runtime/memory_resource/resource_allocator.h"
+#include "runtime/php_assert.h"
+
+namespace memory_resource {
+
+// An ordered map with structural sharing (AVL tree with path copying).
+// A copy of the map takes O(1) and shares all the nodes with the origin;
+// a modification copies only the nodes on the path from the root, i.e. O(log N) nodes.
+// Nodes are reference counted, but the counters are not atomic: only the owner, which holds the write lock,
+// copies, modifies and destroys the maps. Other processes may read a published copy without any locks,
+// so the owner must keep the copy with all its nodes until the readers leave it (e.g. with InterProcessEpochControl).
+template<class Key, class Value, class Resource, class Cmp = std::less<Key>>
+class persistent_map {
+  struct node;
+
+  // AVL tree with 48 levels contains at least F(50) - 1 > 10^10 nodes
+  static constexpr size_t MAX_HEIGHT_ = 48;
+
+public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<const Key, Value>;
+  using allocator_type = resource_allocator<value_type, Resource>;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = persistent_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    const value_type &operator*() const noexcept { return path_[depth_ - 1]->data; }
+    const value_type *operator->() const noexcept { return &path_[depth_ - 1]->data; }
+
+    const_iterator &operator++() noexcept {
+      const node *current = path_[--depth_];
+      for (const node *n = current->right; n; n = n->left) {
+        push(n);
+      }
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return depth_ == other.depth_ && (!depth_ || path_[depth_ - 1] == other.path_[other.depth_ - 1]);
+    }
+
+    bool operator!=(const const_iterator &other) const noexcept {
+      return !(*this == other);
+    }
+
+  private:
+    friend class persistent_map;
+
+    void push(const node *n) noexcept {
+      php_assert(depth_ < path_.size());
+      path_[depth_++] = n;
+    }
+
+    // the current node is on the top, below are the ancestors, which haven't been visited yet
+    std::array<const node *, MAX_HEIGHT_> path_;
+    size_t depth_{0};
+  };
+
+  explicit persistent_map(const allocator_type &allocator) noexcept:
+    allocator_(allocator) {
+  }
+
+  persistent_map(const persistent_map &other) noexcept:
+    allocator_(other.allocator_),
+    root_(acquire(other.root_)),
+    size_(other.size_) {
+  }
+
+  persistent_map(persistent_map &&other) noexcept:
+    allocator_(other.allocator_),
+    root_(other.root_),
+    size_(other.size_) {
+    other.root_ = nullptr;
+    other.size_ = 0;
+  }
+
+  persistent_map &operator=(const persistent_map &other) noexcept {
+    if (this != &other) {
+      node *other_root = acquire(other.root_);
+      clear();
+      root_ = other_root;
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  persistent_map &operator=(persistent_map &&other) noexcept {
+    if (this != &other) {
+      clear();
+      std::swap(root_, other.root_);
+      std::swap(size_, other.size_);
+    }
+    return *this;
+  }
+
+  ~persistent_map() noexcept {
+    clear();
+  }
+
+  size_t size() const noexcept { return size_; }
+  bool empty() const noexcept { return !size_; }
+
+  const_iterator begin() const noexcept {
+    const_iterator it;
+    for (const node *n = root_; n; n = n->left) {
+      it.push(n);
+    }
+    return it;
+  }
+
+  const_iterator end() const noexcept { return {}; }
+
+  template<class K>
+  const_iterator lower_bound(const K &key) const noexcept {
+    const_iterator it;
+    for (const node *n = root_; n;) {
+      if (cmp_(n->data.first, key)) {
+        n = n->right;
+      } else {
+        it.push(n);
+        n = n->left;
+      }
+    }
+    return it;
+  }
+
+  template<class K>
+  const_iterator find(const K &key) const noexcept {
+    auto it = lower_bound(key);
+    return it != end() && !cmp_(key, it->first) ? it : end();
+  }
+
+  // Returns the element for modification or nullptr if there is no such key.
+  // The path to the element is copied, so the other copies of the map stay untouched.
+  template<class K>
+  value_type *find_for_update(const K &key) noexcept {
+    if (find(key) == end()) {
+      return nullptr;
+    }
+    node **n = &root_;
+    while (true) {
+      *n = make_unique(*n);
+      if (cmp_(key, (*n)->data.first)) {
+        n = &(*n)->left;
+      } else if (cmp_((*n)->data.first, key)) {
+        n = &(*n)->right;
+      } else {
+        return &(*n)->data;
+      }
+    }
+  }
+
+  // Inserts the element if there is no such key, returns the element for modification in any case
+  template<class K, class... Args>
+  std::pair<value_type *, bool> try_emplace(K &&key, Args &&... args) noexcept {
+    std::pair<value_type *, bool> result{nullptr, false};
+    root_ = insert(root_, result, std::forward<K>(key), std::forward<Args>(args)...);
+    size_ += result.second;
+    return result;
+  }
+
+  Value &operator[](const Key &key) noexcept {
+    return try_emplace(key).first->second;
+  }
+
+  template<class K>
+  bool erase(const K &key) noexcept {
+    if (find(key) == end()) {
+      return false;
+    }
+    root_ = remove(root_, key);
+    --size_;
+    return true;
+  }
+
+  void clear() noexcept {
+    release(root_);
+    root_ = nullptr;
+    size_ = 0;
+  }
+
+  // An upper bound of the memory allocated by a single modification of the map
+  static constexpr size_t max_modification_memory_usage() noexcept {
+    return sizeof(node) * MAX_HEIGHT_;
+  }
+
+  // Visits the elements, which are owned only by this copy of the map (i.e. created or modified after the last copying).
+  // The elements shared with other copies are skipped with their whole subtrees.
+  template<class F>
+  void for_each_not_shared(const F &f) noexcept {
+    if (root_ && root_->ref_cnt == 1) {
+      visit_not_shared(root_, f);
+    }
+  }
+
+private:
+  struct node {
+    template<class K, class... Args>
+    explicit node(K &&key, Args &&... args) noexcept:
+      data(std::piecewise_construct,
+           std::forward_as_tuple(std::forward<K>(key)),
+           std::forward_as_tuple(std::forward<Args>(args)...)) {
+    }
+
+    explicit node(const node &other) noexcept:
+      data(other.data),
+      left(other.left),
+      right(other.right),
+      height(other.height) {
+    }
+
+    value_type data;
+    node *left{nullptr};
+    node *right{nullptr};
+    uint32_t ref_cnt{1};
+    int32_t height{1};
+  };
+
+  using node_allocator_type = resource_allocator<node, Resource>;
+
+  template<class... Args>
+  node *create_node(Args &&... args) noexcept {
+    return new(node_allocator_type{allocator_}.allocate(1)) node{std::forward<Args>(args)...};
+  }
+
+  static node *acquire(node *n) noexcept {
+    if (n) {
+      ++n->ref_cnt;
+    }
+    return n;
+  }
+
+  void release(node *n) noexcept {
+    if (n && --n->ref_cnt == 0) {
+      release(n->left);
+      release(n->right);
+      n->~node();
+      node_allocator_type{allocator_}.deallocate(n, 1);
+    }
+  }
+
+  // Returns a node owned only by the caller, the ownership of n is passed to this function
+  node *make_unique(node *n) noexcept {
+    if (n->ref_cnt == 1) {
+      return n;
+    }
+    const node &origin = *n;
+    node *copy = create_node(origin);
+    acquire(copy->left);
+    acquire(copy->right);
+    --n->ref_cnt;
+    return copy;
+  }
+
+  template<class F>
+  static void visit_not_shared(node *n, const F &f) noexcept {
+    f(n->data);
+    if (n->left && n->left->ref_cnt == 1) {
+      visit_not_shared(n->left, f);
+    }
+    if (n->right && n->right->ref_cnt == 1) {
+      visit_not_shared(n->right, f);
+    }
+  }
+
+  static int32_t height(const node *n) noexcept { return n ? n->height : 0; }
+
+  static void update_height(node *n) noexcept {
+    n->height = std::max(height(n->left), height(n->right)) + 1;
+  }
+
+  // n must be unique
+  node *rotate_right(node *n) noexcept {
+    node *l = make_unique(n->left);
+    n->left = l->right;
+    l->right = n;
+    update_height(n);
+    update_height(l);
+    return l;
+  }
+
+  // n must be unique
+  node *rotate_left(node *n) noexcept {
+    node *r = make_unique(n->right);
+    n->right = r->left;
+    r->left = n;
+    update_height(n);
+    update_height(r);
+    return r;
+  }
+
+  // n must be unique
+  node *balance(node *n) noexcept {
+    update_height(n);
+    const int32_t diff = height(n->left) - height(n->right);
+    if (diff > 1) {
+      if (height(n->left->left) < height(n->left->right)) {
+        n->left = rotate_left(make_unique(n->left));
+      }
+      return rotate_right(n);
+    }
+    if (diff < -1) {
+      if (height(n->right->right) < height(n->right->left)) {
+        n->right = rotate_right(make_unique(n->right));
+      }
+      return rotate_left(n);
+    }
+    return n;
+  }
+
+  template<class K, class... Args>
+  node *insert(node *n, std::pair<value_type *, bool> &result, K &&key, Args &&... args) noexcept {
+    if (!n) {
+      n = create_node(std::forward<K>(key), std::forward<Args>(args)...);
+      result = {&n->data, true};
+      return n;
+    }
+    n = make_unique(n);
+    if (cmp_(key, n->data.first)) {
+      n->left = insert(n->left, result, std::forward<K>(key), std::forward<Args>(args)...);
+    } else if (cmp_(n->data.first, key)) {
+      n->right = insert(n->right, result, std::forward<K>(key), std::forward<Args>(args)...);
+    } else {
+      result = {&n->data, false};
+      return n;
+    }
+    return balance(n);
+  }
+
+  node *remove_min(node *n, node *&min) noexcept {
+    n = make_unique(n);
+    if (!n->left) {
+      min = n;
+      node *right = n->right;
+      n->right = nullptr;
+      return right;
+    }
+    n->left = remove_min(n->left, min);
+    return balance(n);
+  }
+
+  template<class K>
+  node *remove(node *n, const K &key) noexcept {
+    php_assert(n);
+    n = make_unique(n);
+    if (cmp_(key, n->data.first)) {
+      n->left = remove(n->left, key);
+      return balance(n);
+    }
+    if (cmp_(n->data.first, key)) {
+      n->right = remove(n->right, key);
+      return balance(n);
+    }
+
+    node *left = n->left;
+    node *right = n->right;
+    n->left = n->right = nullptr;
+    release(n);
+    if (!right) {
+      return left;
+    }
+    node *min = nullptr;
+    right = remove_min(right, min);
+    min->left = left;
+    min->right = right;
+    return balance(min);
+  }
+
+  allocator_type allocator_;
+  node *root_{nullptr};
+  size_t size_{0};
+  Cmp cmp_;
+};
+
+} // namespace memory_resource
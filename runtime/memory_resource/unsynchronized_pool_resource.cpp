@@ -4,6 +4,8 @@
 
 #include "runtime/memory_resource/unsynchronized_pool_resource.h"
 
+#include <csignal>
+
 #include "common/wrappers/likely.h"
 
 #include "runtime/memory_resource/details/memory_ordered_chunk_list.h"
@@ -12,12 +14,16 @@ namespace memory_resource {
 
 constexpr size_t unsynchronized_pool_resource::MAX_CHUNK_BLOCK_SIZE_;
 
-void unsynchronized_pool_resource::init(void *buffer, size_t buffer_size) noexcept {
+void unsynchronized_pool_resource::init(void *buffer, size_t buffer_size, bool slab_mode) noexcept {
   monotonic_buffer_resource::init(buffer, buffer_size);
 
   huge_pieces_.hard_reset();
   fallback_resource_.init(nullptr, 0);
   free_chunks_.fill(details::memory_chunk_list{});
+
+  slab_mode_ = slab_mode;
+  free_slabs_ = details::memory_chunk_list{};
+  partial_slabs_.fill(nullptr);
 }
 
 void unsynchronized_pool_resource::perform_defragmentation() noexcept {
@@ -38,6 +44,10 @@ void unsynchronized_pool_resource::perform_defragmentation() noexcept {
       mem_list.add_memory(slot_mem, chunk_size);
     }
   }
+  // the slabs with allocated pieces stay where they are, only the empty ones are merged
+  for (void *slab_mem = free_slabs_.get_mem(); slab_mem; slab_mem = free_slabs_.get_mem()) {
+    mem_list.add_memory(slab_mem, details::memory_slab::SIZE);
+  }
 
   stats_.small_memory_pieces = 0;
   stats_.huge_memory_pieces = 0;
@@ -77,6 +87,57 @@ void *unsynchronized_pool_resource::allocate_small_piece_from_fallback_resource(
   return fallback_resource_.get_from_pool(aligned_size);
 }
 
+details::memory_slab *unsynchronized_pool_resource::acquire_slab(size_t aligned_size) noexcept {
+  void *mem = get_aligned_slab_memory();
+  if (!mem) {
+    perform_defragmentation();
+    mem = get_aligned_slab_memory();
+  }
+  if (unlikely(!mem)) {
+    php_out_of_memory_warning("Can't allocate slab for %zu bytes pieces", aligned_size);
+    raise(SIGUSR2);
+    return nullptr;
+  }
+  ++stats_.memory_slabs;
+  details::memory_slab *slab = details::memory_slab::create(mem, aligned_size);
+  link_partial_slab(slab);
+  memory_debug("allocate slab for %zu bytes pieces at %p\n", aligned_size, mem);
+  return slab;
+}
+
+void *unsynchronized_pool_resource::get_aligned_slab_memory() noexcept {
+  constexpr size_t slab_size = details::memory_slab::SIZE;
+  if (void *mem = free_slabs_.get_mem()) {
+    return mem;
+  }
+
+  // the slab is cut from the pool or from a huge piece, the unaligned margins are put back
+  auto cut_aligned_slab = [this](char *piece, size_t piece_size) {
+    const size_t head_size = (slab_size - static_cast<size_t>(piece - memory_begin_) % slab_size) % slab_size;
+    char *slab = piece + head_size;
+    if (head_size) {
+      put_memory_back(piece, head_size);
+    }
+    if (const size_t tail_size = piece_size - head_size - slab_size) {
+      put_memory_back(slab + slab_size, tail_size);
+    }
+    return slab;
+  };
+
+  const size_t pool_head_size = (slab_size - static_cast<size_t>(memory_current_ - memory_begin_) % slab_size) % slab_size;
+  if (char *piece = static_cast<char *>(get_from_pool(pool_head_size + slab_size, true))) {
+    return cut_aligned_slab(piece, pool_head_size + slab_size);
+  }
+
+  // any piece of this size contains an aligned slab
+  constexpr size_t huge_piece_size = 2 * slab_size - details::align_for_chunk(1);
+  if (details::memory_chunk_tree::tree_node *piece = huge_pieces_.extract(huge_piece_size)) {
+    --stats_.huge_memory_pieces;
+    return cut_aligned_slab(reinterpret_cast<char *>(piece), details::memory_chunk_tree::get_chunk_size(piece));
+  }
+  return nullptr;
+}
+
 void *unsynchronized_pool_resource::perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept {
   // the body of this function is moved to the cpp file intentionally, so it doesn't get inlined into the allocate method
   perform_defragmentation();
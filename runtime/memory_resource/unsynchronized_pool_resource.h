@@ -8,6 +8,7 @@
 
 #include "runtime/memory_resource/details/memory_chunk_list.h"
 #include "runtime/memory_resource/details/memory_chunk_tree.h"
+#include "runtime/memory_resource/details/memory_slab.h"
 #include "runtime/memory_resource/details/universal_reallocate.h"
 #include "runtime/memory_resource/monotonic_buffer_resource.h"
 #include "runtime/memory_resource/resource_allocator.h"
@@ -17,16 +18,18 @@ namespace memory_resource {
 
 class unsynchronized_pool_resource : private monotonic_buffer_resource {
 public:
-  using monotonic_buffer_resource::try_expand;
   using monotonic_buffer_resource::get_memory_stats;
   using monotonic_buffer_resource::memory_begin;
 
-  void init(void *buffer, size_t buffer_size) noexcept;
+  // in the slab mode the small pieces are allocated from the slabs (check details::memory_slab)
+  void init(void *buffer, size_t buffer_size, bool slab_mode = false) noexcept;
 
   void *allocate(size_t size) noexcept {
     void *mem = nullptr;
     const auto aligned_size = details::align_for_chunk(size);
-    if (aligned_size < MAX_CHUNK_BLOCK_SIZE_) {
+    if (slab_mode_ && aligned_size <= details::memory_slab::MAX_PIECE_SIZE) {
+      mem = allocate_piece_from_slab(aligned_size);
+    } else if (aligned_size < MAX_CHUNK_BLOCK_SIZE_) {
       mem = try_allocate_small_piece(aligned_size);
       if (!mem) {
         mem = allocate_small_piece_from_fallback_resource(aligned_size);
@@ -50,6 +53,14 @@ public:
     return mem;
   }
 
+  void *try_expand(void *mem, size_t new_size, size_t old_size) noexcept {
+    // the pieces of slabs can't be expanded, and the expanded pieces can't become the pieces of slabs
+    if (slab_mode_ && std::min(new_size, old_size) <= details::memory_slab::MAX_PIECE_SIZE) {
+      return nullptr;
+    }
+    return monotonic_buffer_resource::try_expand(mem, new_size, old_size);
+  }
+
   void *reallocate(void *mem, size_t new_size, size_t old_size) noexcept {
     const auto aligned_old_size = details::align_for_chunk(old_size);
     const auto aligned_new_size = details::align_for_chunk(new_size);
@@ -59,7 +70,11 @@ public:
   void deallocate(void *mem, size_t size) noexcept {
     memory_debug("deallocate %zu at %p\n", size, mem);
     const auto aligned_size = details::align_for_chunk(size);
-    put_memory_back(mem, aligned_size);
+    if (slab_mode_ && aligned_size <= details::memory_slab::MAX_PIECE_SIZE) {
+      put_piece_back_to_slab(mem);
+    } else {
+      put_memory_back(mem, aligned_size);
+    }
     register_deallocation(aligned_size);
   }
 
@@ -67,6 +82,10 @@ public:
 
   bool is_enough_memory_for(size_t size) const noexcept {
     const auto aligned_size = details::align_for_chunk(size);
+    if (slab_mode_ && aligned_size <= details::memory_slab::MAX_PIECE_SIZE) {
+      return partial_slabs_[details::get_chunk_id(aligned_size)] || !free_slabs_.empty() ||
+             is_enough_memory_for(2 * details::memory_slab::SIZE);
+    }
     // not using free_chunks_ here as the real size can be smaller
     return static_cast<size_t>(memory_end_ - memory_current_) >= aligned_size || huge_pieces_.has_memory_for(aligned_size);
   }
@@ -102,6 +121,68 @@ private:
     return mem;
   }
 
+  void *allocate_piece_from_slab(size_t aligned_size) noexcept {
+    details::memory_slab *slab = partial_slabs_[details::get_chunk_id(aligned_size)];
+    if (unlikely(!slab)) {
+      slab = acquire_slab(aligned_size);
+      if (!slab) {
+        return nullptr;
+      }
+    }
+    void *mem = slab->allocate();
+    if (slab->is_full()) {
+      unlink_partial_slab(slab);
+    }
+    memory_debug("allocate %zu, allocated address from slab %p\n", aligned_size, mem);
+    return mem;
+  }
+
+  void put_piece_back_to_slab(void *mem) noexcept {
+    if (unlikely(!check_memory_piece(mem, sizeof(void *)))) {
+      critical_dump(mem, sizeof(void *));
+    }
+    details::memory_slab *slab = details::memory_slab::of_piece(mem, memory_begin_);
+    const bool was_full = slab->is_full();
+    slab->deallocate(mem);
+    if (was_full) {
+      link_partial_slab(slab);
+    } else if (slab->is_empty() && (slab->prev || slab->next)) {
+      // keep at least one slab of each size to avoid creating and releasing it again and again
+      unlink_partial_slab(slab);
+      release_slab(slab);
+    }
+  }
+
+  void link_partial_slab(details::memory_slab *slab) noexcept {
+    details::memory_slab *&head = partial_slabs_[details::get_chunk_id(slab->piece_size())];
+    slab->prev = nullptr;
+    slab->next = head;
+    if (head) {
+      head->prev = slab;
+    }
+    head = slab;
+  }
+
+  void unlink_partial_slab(details::memory_slab *slab) noexcept {
+    if (slab->prev) {
+      slab->prev->next = slab->next;
+    } else {
+      partial_slabs_[details::get_chunk_id(slab->piece_size())] = slab->next;
+    }
+    if (slab->next) {
+      slab->next->prev = slab->prev;
+    }
+    slab->prev = slab->next = nullptr;
+  }
+
+  void release_slab(details::memory_slab *slab) noexcept {
+    slab->~memory_slab();
+    free_slabs_.put_mem(slab);
+    --stats_.memory_slabs;
+  }
+
+  details::memory_slab *acquire_slab(size_t aligned_size) noexcept;
+  void *get_aligned_slab_memory() noexcept;
   void *allocate_small_piece_from_fallback_resource(size_t aligned_size) noexcept;
   void *perform_defragmentation_and_allocate_huge_piece(size_t aligned_size) noexcept;
 
@@ -123,6 +204,11 @@ private:
 
   static constexpr size_t MAX_CHUNK_BLOCK_SIZE_{16u * 1024u};
   std::array<details::memory_chunk_list, details::get_chunk_id(MAX_CHUNK_BLOCK_SIZE_)> free_chunks_;
+
+  bool slab_mode_{false};
+  // the empty slabs, they are aligned and can be reused for any size
+  details::memory_chunk_list free_slabs_;
+  std::array<details::memory_slab *, details::get_chunk_id(details::memory_slab::MAX_PIECE_SIZE) + 1> partial_slabs_{};
 };
 
 } // namespace memory_resource
@@ -11,6 +11,8 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#include "common/algorithms/simd-byte-class.h"
+
 #include "runtime/critical_section.h"
 #include "runtime/datetime.h"
 #include "runtime/exception.h"
@@ -800,8 +802,24 @@ static bool do_json_encode_string_php(const char *s, int len, int64_t options) {
 #define CHECK(x) if (!(x)) {php_warning ("Not a valid utf-8 character at pos %d in function json_encode", pos); ERROR}
 #define APPEND_CHAR(x) CHECK(json_append_char (x))
 
+  // the other bytes are copied as is, so they are appended in bulk
+  static const vk::byte_class special_bytes = [] {
+    vk::byte_class bytes{"\"\\/"};
+    bytes.add_range(0, 31);
+    bytes.add_range(128, 255);
+    return bytes;
+  }();
+
   int a, b, c, d;
   for (int pos = 0; pos < len; pos++) {
+    const int plain_len = static_cast<int>(special_bytes.find_first_of(s + pos, s + len) - (s + pos));
+    if (plain_len) {
+      static_SB.append_unsafe(s + pos, plain_len);
+      pos += plain_len;
+      if (pos == len) {
+        break;
+      }
+    }
     switch (s[pos]) {
       case '"':
         static_SB.append_char('\\');
@@ -909,7 +927,21 @@ static bool do_json_encode_string_vkext(const char *s, int len) {
 
   static_SB.append_char('"');
 
+  static const vk::byte_class special_bytes = [] {
+    vk::byte_class bytes{"\"\\/"};
+    bytes.add_range(0, 31);
+    return bytes;
+  }();
+
   for (int pos = 0; pos < len; pos++) {
+    const int plain_len = static_cast<int>(special_bytes.find_first_of(s + pos, s + len) - (s + pos));
+    if (plain_len) {
+      static_SB.append_unsafe(s + pos, plain_len);
+      pos += plain_len;
+      if (pos == len) {
+        break;
+      }
+    }
     char c = s[pos];
     if (unlikely ((unsigned int)c < 32u)) {
       switch (c) {
@@ -1068,13 +1100,13 @@ string f$vk_json_encode_safe(const mixed &v, bool simple_encode) {
 }
 
 
-static void json_skip_blanks(const char *s, int &i) {
+void json_skip_blanks(const char *s, int &i) {
   while (s[i] == ' ' || s[i] == '\t' || s[i] == '\r' || s[i] == '\n') {
     i++;
   }
 }
 
-static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
+bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
   if (!v.is_null()) {
     v.destroy();
   }
@@ -1108,14 +1140,16 @@ static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
       }
       break;
     case '"': {
+      static const vk::byte_class quote_or_slash{"\"\\"};
       int j = i + 1;
       int slashes = 0;
-      while (j < s_len && s[j] != '"') {
-        if (s[j] == '\\') {
-          slashes++;
-          j++;
+      while (j < s_len) {
+        j = static_cast<int>(quote_or_slash.find_first_of(s + j, s + s_len) - s);
+        if (j == s_len || s[j] == '"') {
+          break;
         }
-        j++;
+        slashes++;
+        j += 2;
       }
       if (j < s_len) {
         int len = j - i - 1 - slashes;
@@ -1125,6 +1159,16 @@ static bool do_json_decode(const char *s, int s_len, int &i, mixed &v) {
         i++;
         int l;
         for (l = 0; l < len && i < j; l++) {
+          // the parts without escapes are copied in bulk
+          const int plain_len = static_cast<int>(quote_or_slash.find_first_of(s + i, s + j) - (s + i));
+          if (plain_len) {
+            memcpy(value.buffer() + l, s + i, plain_len);
+            l += plain_len;
+            i += plain_len;
+            if (i == j) {
+              break;
+            }
+          }
           char c = s[i];
           if (c == '\\') {
             i++;
@@ -54,6 +54,11 @@ string f$vk_json_encode_safe(const mixed &v, bool simple_encode = true);
 
 mixed f$json_decode(const string &v, bool assoc = false);
 
+// the json parts are written into static_SB
+bool do_json_encode(const mixed &v, int64_t options, bool simple_encode);
+void json_skip_blanks(const char *s, int &i);
+bool do_json_decode(const char *s, int s_len, int &i, mixed &v);
+
 string f$print_r(const mixed &v, bool buffered = false);
 
 template<class T>
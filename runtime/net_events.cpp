@@ -39,7 +39,7 @@ static bool process_net_event(net_event_t *e) {
   }
 
   if (e->type == ne_rpc_answer) {
-    process_rpc_answer(e->slot_id, e->result, e->result_len);
+    process_rpc_answer(e->slot_id, e);
   } else if (e->type == ne_rpc_error) {
     process_rpc_error(e->slot_id, e->error_code, e->error_message);
   } else {
@@ -5,9 +5,14 @@
 #include "runtime/regexp.h"
 
 #include <cstddef>
+#include <list>
+#include <memory>
 #include <re2/re2.h>
+#include <unordered_map>
 
 #include "common/containers/final_action.h"
+#include "common/re2-compatibility.h"
+#include "common/wrappers/string_view.h"
 
 #include "runtime/critical_section.h"
 
@@ -21,6 +26,88 @@ static re2::StringPiece RE2_submatch[MAX_SUBPATTERNS];
 int32_t regexp::submatch[3 * MAX_SUBPATTERNS];
 pcre_extra regexp::extra;
 
+static size_t regexp_cache_size_limit = DEFAULT_REGEXP_CACHE_SIZE_LIMIT;
+
+static pcre_jit_stack *get_pcre_jit_stack() noexcept {
+  static pcre_jit_stack *jit_stack = pcre_jit_stack_alloc(32 * 1024, 1024 * 1024);
+  return jit_stack;
+}
+
+// Compiled regexps that live on heap and survive between requests of the same worker.
+// Patterns are evicted in the LRU order, but never during the request they were used in,
+// as regexps of the current request keep raw pointers to the compiled pcre and RE2 objects.
+// If all the cached patterns are used by the current request, new ones aren't cached
+// and are compiled into the script memory, so the cache never grows past its limit.
+class RegexpCache : vk::not_copyable {
+public:
+  static RegexpCache &get() noexcept {
+    static RegexpCache cache;
+    return cache;
+  }
+
+  bool is_enabled() const noexcept {
+    return regexp_cache_size_limit != 0;
+  }
+
+  // returns nullptr if the pattern can't be cached
+  const regexp *get_compiled(const string &regexp_string, const char *function, const char *file) noexcept {
+    dl::CriticalSectionGuard critical_section;
+    auto it = index_.find(vk::string_view{regexp_string.c_str(), regexp_string.size()});
+    if (it != index_.end()) {
+      stats_.hits++;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      it->second->last_used_query_num = dl::query_num;
+      it->second->compiled.check_pattern_compilation_warning();
+      return &it->second->compiled;
+    }
+
+    stats_.misses++;
+    evict_unused();
+    if (lru_.size() >= regexp_cache_size_limit) {
+      stats_.uncached++;
+      return nullptr;
+    }
+
+    lru_.emplace_front(regexp_string.c_str(), regexp_string.size());
+    CachedRegexp &cached = lru_.front();
+    index_.emplace(vk::string_view{cached.pattern}, lru_.begin());
+    stats_.size = static_cast<int64_t>(lru_.size());
+
+    cached.compiled.use_heap_memory = true;
+    cached.compiled.compile(cached.pattern.c_str(), cached.pattern.size(), false, function, file);
+    return &cached.compiled;
+  }
+
+  const RegexpCacheStats &get_stats() const noexcept {
+    return stats_;
+  }
+
+private:
+  struct CachedRegexp : vk::not_copyable {
+    CachedRegexp(const char *str, size_t len) :
+      pattern(str, len) {}
+
+    std::string pattern;
+    regexp compiled;
+    long long last_used_query_num{dl::query_num};
+  };
+
+  RegexpCache() = default;
+
+  void evict_unused() noexcept {
+    while (lru_.size() >= regexp_cache_size_limit && lru_.back().last_used_query_num != dl::query_num) {
+      index_.erase(vk::string_view{lru_.back().pattern});
+      lru_.pop_back();
+      stats_.evictions++;
+    }
+    stats_.size = static_cast<int64_t>(lru_.size());
+  }
+
+  std::list<CachedRegexp> lru_;
+  std::unordered_map<vk::string_view, std::list<CachedRegexp>::iterator> index_;
+  RegexpCacheStats stats_;
+};
+
 
 regexp::regexp(const string &regexp_string) {
   init(regexp_string);
@@ -57,411 +144,145 @@ void regexp::check_pattern_compilation_warning() const noexcept {
 }
 
 bool regexp::is_valid_RE2_regexp(const char *regexp_string, int64_t regexp_len, bool is_utf8, const char *function, const char *file) noexcept {
-//  return false;
-  int64_t brackets_depth = 0;
-  bool prev_is_group = false;
-
-  for (int64_t i = 0; i < regexp_len; i++) {
-    switch (regexp_string[i]) {
-      case -128 ... -1:
-      case 1 ... 35:
-      case 37 ... 39:
-      case ',' ... '>':
-      case '@':
-      case 'A' ... 'Z':
-      case ']':
-      case '_':
-      case '`':
-      case 'a' ... 'z':
-      case '}' ... 127:
-        prev_is_group = true;
-        break;
-      case '$':
-      case '^':
-      case '|':
-        prev_is_group = false;
-        break;
-      case 0:
-        pattern_compilation_warning(function, file, "Regexp contains symbol with code 0 after %s", regexp_string);
-        return false;
-      case '(':
-        brackets_depth++;
-
-        if (regexp_string[i + 1] == '*') {
-          return false;
-        }
-
-        if (regexp_string[i + 1] == '?') {
-          if (regexp_string[i + 2] == ':') {
-            i += 2;
-            break;
-          }
-          if (regexp_string[i + 2] == ':') {
-            i += 2;
-            break;
-          }
-          return false;
-        }
-        prev_is_group = false;
-        break;
-      case ')':
-        brackets_depth--;
-        if (brackets_depth < 0) {
-          return false;
-        }
-        prev_is_group = true;
-        break;
-      case '+':
-      case '*':
-        if (!prev_is_group) {
-          return false;
-        }
-
-        prev_is_group = false;
-        break;
-      case '?':
-        if (!prev_is_group && (i == 0 || (regexp_string[i - 1] != '+' && regexp_string[i - 1] != '*' && regexp_string[i - 1] != '?'))) {
-          return false;
-        }
-
-        prev_is_group = false;
-        break;
-      case '{': {
-        if (!prev_is_group) {
-          return false;
-        }
-
-        i++;
-        int64_t k = 0;
-        while ('0' <= regexp_string[i] && regexp_string[i] <= '9') {
-          i++;
-          k++;
-        }
-
-        if (k > 2) {
-          return false;
-        }
-
-        if (regexp_string[i] == ',') {
-          i++;
-        }
-
-        k = 0;
-        while ('0' <= regexp_string[i] && regexp_string[i] <= '9') {
-          k++;
-          i++;
-        }
-
-        if (k > 2) {
-          return false;
-        }
+  switch (vk::check_RE2_compatibility(regexp_string, regexp_len, is_utf8)) {
+    case vk::RE2Compatibility::compatible:
+      return true;
+    case vk::RE2Compatibility::incompatible:
+      return false;
+    case vk::RE2Compatibility::zero_symbol:
+      pattern_compilation_warning(function, file, "Regexp contains symbol with code 0 after %s", regexp_string);
+      return false;
+    case vk::RE2Compatibility::wrong_repetition:
+      pattern_compilation_warning(function, file, "Wrong regexp %s", regexp_string);
+      return false;
+    case vk::RE2Compatibility::brackets_mismatch:
+      pattern_compilation_warning(function, file, "Brackets mismatch in regexp %s", regexp_string);
+      return false;
+  }
+  __builtin_unreachable();
+}
 
-        if (regexp_string[i] != '}') {
-          pattern_compilation_warning(function, file, "Wrong regexp %s", regexp_string);
-          return false;
-        }
+void regexp::copy_compiled_state(const regexp &other) noexcept {
+  subpatterns_count = other.subpatterns_count;
+  named_subpatterns_count = other.named_subpatterns_count;
+  is_utf8 = other.is_utf8;
+  use_heap_memory = other.use_heap_memory;
+  is_cached = other.is_cached;
 
-        prev_is_group = false;
-        break;
-      }
-      case '[':
-        if (regexp_string[i + 1] == '^') {
-          i++;
-        }
-        if (regexp_string[i + 1] == ']') {
-          i++;
-        }
-        while (true) {
-          while (++i < regexp_len && regexp_string[i] != '\\' && regexp_string[i] != ']' && regexp_string[i] != '[') {
-          }
+  subpattern_names = other.subpattern_names;
 
-          if (i == regexp_len) {
-            return false;
-          }
+  pcre_regexp = other.pcre_regexp;
+  pcre_study_extra = other.pcre_study_extra;
+  RE2_regexp = other.RE2_regexp;
+}
 
-          if (regexp_string[i] == '\\') {
-            switch (regexp_string[i + 1]) {
-              case 'x':
-                if (isxdigit(regexp_string[i + 2]) &&
-                    isxdigit(regexp_string[i + 3])) {
-                  i += 3;
-                  continue;
-                }
-                return false;
-              case '0':
-                if ('0' <= regexp_string[i + 2] && regexp_string[i + 2] <= '7' &&
-                    '0' <= regexp_string[i + 3] && regexp_string[i + 3] <= '7') {
-                  i += 3;
-                  continue;
-                }
-                return false;
-              case 'a':
-              case 'f':
-              case 'n':
-              case 'r':
-              case 't':
-              case -128 ... '/':
-              case ':' ... '@':
-              case '[' ... '`':
-              case '{' ... 127:
-                i++;
-                continue;
-              case 'd':
-              case 'D':
-              case 's':
-              case 'S':
-              case 'w':
-              case 'W':
-                if (!is_utf8) {
-                  i++;
-                  continue;
-                }
-                return false;
-              default:
-                return false;
-            }
-          } else if (regexp_string[i] == '[') {
-            if (regexp_string[i + 1] == ':') {
-              return false;
-            }
-          } else if (regexp_string[i] == ']') {
-            break;
-          }
-        }
-        prev_is_group = true;
-        break;
-      case '\\':
-        switch (regexp_string[i + 1]) {
-          case 'x':
-            if (isxdigit(regexp_string[i + 2]) &&
-                isxdigit(regexp_string[i + 3])) {
-              i += 3;
-              break;
-            }
-            return false;
-          case '0':
-            if ('0' <= regexp_string[i + 2] && regexp_string[i + 2] <= '7' &&
-                '0' <= regexp_string[i + 3] && regexp_string[i + 3] <= '7') {
-              i += 3;
-              break;
-            }
-            return false;
-          case 'a':
-          case 'f':
-          case 'n':
-          case 'r':
-          case 't':
-          case -128 ... '/':
-          case ':' ... '@':
-          case '[' ... '`':
-          case '{' ... 127:
-            i++;
-            break;
-          case 'b':
-          case 'B':
-          case 'd':
-          case 'D':
-          case 's':
-          case 'S':
-          case 'w':
-          case 'W':
-            if (!is_utf8) {
-              i++;
-              continue;
-            }
-            return false;
-          default:
-            return false;
-        }
+void regexp::use_cached(const regexp &cached, const char *function, const char *file) {
+  copy_compiled_state(cached);
+  is_cached = true;
 
-        prev_is_group = true;
-        break;
-      default: php_critical_error ("wrong char range assumed");
-    }
+  if (named_subpatterns_count > 0) {
+    // subpattern names are stored in script memory, as they can be shallow copied into the script arrays
+    auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator();
+    init_subpattern_names(function, file);
   }
-  if (brackets_depth != 0) {
-    pattern_compilation_warning(function, file, "Brackets mismatch in regexp %s", regexp_string);
-    return false;
-  }
-
-  return true;
 }
 
-void regexp::init(const string &regexp_string, const char *function, const char *file) {
+void regexp::init(const string &regexp_string, const char *function, const char *file, RegexpEngine engine) {
   static char regexp_cache_storage[sizeof(array<regexp *>)];
   static array<regexp *> *regexp_cache = (array<regexp *> *)regexp_cache_storage;
   static long long regexp_last_query_num = -1;
 
   use_heap_memory = (dl::get_script_memory_stats().memory_limit == 0);
 
-  if (!use_heap_memory) {
-    if (dl::query_num != regexp_last_query_num) {
-      new(regexp_cache_storage) array<regexp *>();
-      regexp_last_query_num = dl::query_num;
-    }
-
-    regexp *re = regexp_cache->get_value(regexp_string);
-    if (re != nullptr) {
-      php_assert (!re->use_heap_memory);
-
-      subpatterns_count = re->subpatterns_count;
-      named_subpatterns_count = re->named_subpatterns_count;
-      is_utf8 = re->is_utf8;
-      use_heap_memory = re->use_heap_memory;
-
-      subpattern_names = re->subpattern_names;
-
-      pcre_regexp = re->pcre_regexp;
-      RE2_regexp = re->RE2_regexp;
-
-      return;
-    }
+  if (use_heap_memory) {
+    compile(regexp_string.c_str(), regexp_string.size(), true, function, file, engine);
+    return;
   }
 
-  init(regexp_string.c_str(), regexp_string.size(), function, file);
-
-  if (!use_heap_memory) {
-    regexp *re = static_cast <regexp *> (dl::allocate(sizeof(regexp)));
-    new(re) regexp();
+  if (dl::query_num != regexp_last_query_num) {
+    new(regexp_cache_storage) array<regexp *>();
+    regexp_last_query_num = dl::query_num;
+  }
 
-    re->subpatterns_count = subpatterns_count;
-    re->named_subpatterns_count = named_subpatterns_count;
-    re->is_utf8 = is_utf8;
-    re->use_heap_memory = use_heap_memory;
+  regexp *re = regexp_cache->get_value(regexp_string);
+  if (re != nullptr) {
+    php_assert (!re->use_heap_memory || re->is_cached);
+    copy_compiled_state(*re);
+    return;
+  }
 
-    re->subpattern_names = subpattern_names;
+  auto &worker_regexp_cache = RegexpCache::get();
+  const regexp *cached = worker_regexp_cache.is_enabled() ? worker_regexp_cache.get_compiled(regexp_string, function, file) : nullptr;
+  if (cached) {
+    use_cached(*cached, function, file);
+  } else {
+    compile(regexp_string.c_str(), regexp_string.size(), true, function, file);
+  }
 
-    re->pcre_regexp = pcre_regexp;
-    re->RE2_regexp = RE2_regexp;
+  re = static_cast <regexp *> (dl::allocate(sizeof(regexp)));
+  new(re) regexp();
+  re->copy_compiled_state(*this);
 
-    regexp_cache->set_value(regexp_string, re);
-  }
+  regexp_cache->set_value(regexp_string, re);
 }
 
 void regexp::init(const char *regexp_string, int64_t regexp_len, const char *function, const char *file) {
-  if (regexp_len == 0) {
-    pattern_compilation_warning(function, file, "Empty regular expression");
-    return;
-  }
+  use_heap_memory = (dl::get_script_memory_stats().memory_limit == 0);
+  compile(regexp_string, regexp_len, true, function, file);
+}
 
-  char start_delimiter = regexp_string[0], end_delimiter;
-  switch (start_delimiter) {
-    case '(':
-      end_delimiter = ')';
-      break;
-    case '[':
-      end_delimiter = ']';
-      break;
-    case '{':
-      end_delimiter = '}';
-      break;
-    case '>':
-      end_delimiter = '>';
-      break;
-    case '!' ... '\'':
-    case '*' ... '/':
-    case ':':
-    case ';':
-    case '=':
-    case '?':
-    case '@':
-    case '^':
-    case '_':
-    case '`':
-    case '|':
-    case '~':
-      end_delimiter = start_delimiter;
+void regexp::compile(const char *regexp_string, int64_t regexp_len, bool with_subpattern_names, const char *function, const char *file,
+                     RegexpEngine engine) {
+  vk::RegexpPattern pattern;
+  const auto parse_error = vk::parse_regexp_pattern(regexp_string, regexp_len, pattern);
+  if (pattern.study) {
+    pattern_compilation_warning(function, file, "Study doesn't supported");
+  }
+  switch (parse_error) {
+    case vk::RegexpPatternError::no_error:
+    case vk::RegexpPatternError::not_utf8:
       break;
-    default:
+    case vk::RegexpPatternError::empty:
+      pattern_compilation_warning(function, file, "Empty regular expression");
+      return;
+    case vk::RegexpPatternError::wrong_start_delimiter:
       pattern_compilation_warning(function, file, "Wrong start delimiter in regular expression \"%s\"", regexp_string);
       return;
+    case vk::RegexpPatternError::no_end_delimiter:
+      pattern_compilation_warning(function, file, "No ending matching delimiter '%c' found in regexp: %s", pattern.end_delimiter, regexp_string);
+      return;
+    case vk::RegexpPatternError::unknown_modifier:
+      pattern_compilation_warning(function, file, "Unknown modifier '%c' found", pattern.unknown_modifier);
+      clean();
+      return;
   }
 
-  int64_t regexp_end = regexp_len - 1;
-  while (regexp_end > 0 && regexp_string[regexp_end] != end_delimiter) {
-    regexp_end--;
-  }
+  static_SB.clean().append(pattern.body, static_cast<size_t>(pattern.body_len));
 
-  if (regexp_end == 0) {
-    pattern_compilation_warning(function, file, "No ending matching delimiter '%c' found in regexp: %s", end_delimiter, regexp_string);
+  if (parse_error == vk::RegexpPatternError::not_utf8) {
+    pattern_compilation_warning(function, file, "Regexp \"%s\" contains not UTF-8 symbols", static_SB.c_str());
+    clean();
     return;
   }
 
-  static_SB.clean().append(regexp_string + 1, static_cast<size_t>(regexp_end - 1));
-
-  use_heap_memory = (dl::get_script_memory_stats().memory_limit == 0);
-
   auto malloc_replacement_guard = make_malloc_replacement_with_script_allocator(!use_heap_memory);
 
-  is_utf8 = false;
-  int32_t pcre_options = 0;
+  is_utf8 = pattern.is_utf8;
+  const int32_t pcre_options = pattern.pcre_options;
   RE2::Options RE2_options(RE2::Latin1);
   RE2_options.set_log_errors(false);
-  bool can_use_RE2 = true;
-
-  for (int64_t i = regexp_end + 1; i < regexp_len; i++) {
-    switch (regexp_string[i]) {
-      case 'i':
-        pcre_options |= PCRE_CASELESS;
-        RE2_options.set_case_sensitive(false);
-        break;
-      case 'm':
-        pcre_options |= PCRE_MULTILINE;
-        RE2_options.set_one_line(false);
-        can_use_RE2 = false;//supported by RE2::Regexp but disabled in an interface while not using posix_syntax
-        break;
-      case 's':
-        pcre_options |= PCRE_DOTALL;
-        RE2_options.set_dot_nl(true);
-        break;
-      case 'x':
-        pcre_options |= PCRE_EXTENDED;
-        can_use_RE2 = false;
-        break;
-
-      case 'A':
-        pcre_options |= PCRE_ANCHORED;
-        can_use_RE2 = false;
-        break;
-      case 'D':
-        pcre_options |= PCRE_DOLLAR_ENDONLY;
-        can_use_RE2 = false;
-        break;
-      case 'S':
-        pattern_compilation_warning(function, file, "Study doesn't supported");
-        break;
-      case 'U':
-        pcre_options |= PCRE_UNGREEDY;
-        can_use_RE2 = false;//supported by RE2::Regexp but there is no such an option
-        break;
-      case 'X':
-        pcre_options |= PCRE_EXTRA;
-        break;
-      case 'u':
-        pcre_options |= PCRE_UTF8;
-#ifdef PCRE_UCP
-        pcre_options |= PCRE_UCP;
-#endif
-        RE2_options.set_encoding(RE2::Options::EncodingUTF8);
-        is_utf8 = true;
-        break;
-
-      default:
-        pattern_compilation_warning(function, file, "Unknown modifier '%c' found", regexp_string[i]);
-        clean();
-        return;
-    }
+  RE2_options.set_case_sensitive(!pattern.caseless);
+  RE2_options.set_dot_nl(pattern.dot_all);
+  if (is_utf8) {
+    RE2_options.set_encoding(RE2::Options::EncodingUTF8);
   }
+  bool can_use_RE2 = engine != RegexpEngine::PCRE && pattern.can_use_RE2;
 
-  can_use_RE2 = can_use_RE2 && is_valid_RE2_regexp(static_SB.c_str(), static_SB.size(), is_utf8, function, file);
-
-  if (is_utf8 && !mb_UTF8_check(static_SB.c_str())) {
-    pattern_compilation_warning(function, file, "Regexp \"%s\" contains not UTF-8 symbols", static_SB.c_str());
-    clean();
-    return;
+  if (engine == RegexpEngine::auto_detect) {
+    can_use_RE2 = can_use_RE2 && is_valid_RE2_regexp(static_SB.c_str(), static_SB.size(), is_utf8, function, file);
   }
 
-  bool need_pcre = false;
+  bool need_pcre = engine == RegexpEngine::RE2_with_PCRE;
   if (can_use_RE2) {
     RE2_regexp = new RE2(re2::StringPiece(static_SB.c_str(), static_SB.size()), RE2_options);
     if (!RE2_regexp->ok()) {
@@ -470,7 +291,7 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
 
       delete RE2_regexp;
       RE2_regexp = nullptr;
-    } else {
+    } else if (engine == RegexpEngine::auto_detect) {
       std::string min_str;
       std::string max_str;
 
@@ -493,6 +314,18 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
       clean();
       return;
     }
+
+    // JIT code is kept only for the long-living heap regexps, script memory is not executable
+    if (use_heap_memory) {
+      const char *study_error = nullptr;
+      pcre_study_extra = pcre_study(pcre_regexp, PCRE_STUDY_JIT_COMPILE, &study_error);
+      if (pcre_study_extra) {
+        pcre_study_extra->flags |= PCRE_EXTRA_MATCH_LIMIT | PCRE_EXTRA_MATCH_LIMIT_RECURSION;
+        pcre_study_extra->match_limit = PCRE_BACKTRACK_LIMIT;
+        pcre_study_extra->match_limit_recursion = PCRE_RECURSION_LIMIT;
+        pcre_assign_jit_stack(pcre_study_extra, nullptr, get_pcre_jit_stack());
+      }
+    }
   }
 
   //compile has finished
@@ -505,32 +338,6 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
 
     if (subpatterns_count) {
       php_assert (pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_NAMECOUNT, &named_subpatterns_count) == 0);
-
-      if (named_subpatterns_count > 0) {
-        subpattern_names = new string[subpatterns_count + 1];
-
-        int32_t name_entry_size = 0;
-        php_assert (pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_NAMEENTRYSIZE, &name_entry_size) == 0);
-
-        char *name_table;
-        php_assert (pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_NAMETABLE, &name_table) == 0);
-
-        for (int64_t i = 0; i < named_subpatterns_count; i++) {
-          int64_t name_id = (((unsigned char)name_table[0]) << 8) + (unsigned char)name_table[1];
-          string name(name_table + 2);
-
-          if (use_heap_memory) {
-            name.set_reference_counter_to(ExtraRefCnt::for_global_const);
-          }
-
-          if (name.is_int()) {
-            pattern_compilation_warning(function, file, "Numeric named subpatterns are not allowed");
-          } else {
-            subpattern_names[name_id] = name;
-          }
-          name_table += name_entry_size;
-        }
-      }
     }
   }
   subpatterns_count++;
@@ -538,20 +345,49 @@ void regexp::init(const char *regexp_string, int64_t regexp_len, const char *fun
   if (subpatterns_count > MAX_SUBPATTERNS) {
     pattern_compilation_warning(function, file, "Maximum number of subpatterns %d exceeded, %d subpatterns found", MAX_SUBPATTERNS, subpatterns_count);
     subpatterns_count = 0;
+    named_subpatterns_count = 0;
 
     delete RE2_regexp;
     RE2_regexp = nullptr;
-
-    delete[] subpattern_names;
-    subpattern_names = nullptr;
     clean();
     return;
   }
+
+  if (with_subpattern_names && named_subpatterns_count > 0) {
+    init_subpattern_names(function, file);
+  }
+}
+
+void regexp::init_subpattern_names(const char *function, const char *file) {
+  php_assert (pcre_regexp && named_subpatterns_count > 0);
+  subpattern_names = new string[subpatterns_count];
+
+  int32_t name_entry_size = 0;
+  php_assert (pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_NAMEENTRYSIZE, &name_entry_size) == 0);
+
+  char *name_table;
+  php_assert (pcre_fullinfo(pcre_regexp, nullptr, PCRE_INFO_NAMETABLE, &name_table) == 0);
+
+  for (int64_t i = 0; i < named_subpatterns_count; i++) {
+    int64_t name_id = (((unsigned char)name_table[0]) << 8) + (unsigned char)name_table[1];
+    string name(name_table + 2);
+
+    if (use_heap_memory && !is_cached) {
+      name.set_reference_counter_to(ExtraRefCnt::for_global_const);
+    }
+
+    if (name.is_int()) {
+      pattern_compilation_warning(function, file, "Numeric named subpatterns are not allowed");
+    } else {
+      subpattern_names[name_id] = name;
+    }
+    name_table += name_entry_size;
+  }
 }
 
 void regexp::clean() {
-  if (!use_heap_memory) {
-    // Regexp is stored inside a static cache, see regexp_cache_storage
+  if (!use_heap_memory || is_cached) {
+    // Regexp is stored inside a static cache, see regexp_cache_storage and RegexpCache
     return;
   }
 
@@ -562,6 +398,11 @@ void regexp::clean() {
   is_utf8 = false;
   use_heap_memory = false;
 
+  if (pcre_study_extra != nullptr) {
+    pcre_free_study(pcre_study_extra);
+    pcre_study_extra = nullptr;
+  }
+
   if (pcre_regexp != nullptr) {
     pcre_free(pcre_regexp);
     pcre_regexp = nullptr;
@@ -615,7 +456,7 @@ int64_t regexp::exec(const string &subject, int64_t offset, bool second_try) con
 
   int32_t options = second_try ? PCRE_NO_UTF8_CHECK | PCRE_NOTEMPTY_ATSTART : PCRE_NO_UTF8_CHECK;
   dl::enter_critical_section();//OK
-  int64_t count = pcre_exec(pcre_regexp, &extra, subject.c_str(), subject.size(),
+  int64_t count = pcre_exec(pcre_regexp, pcre_study_extra ? pcre_study_extra : &extra, subject.c_str(), subject.size(),
                             static_cast<int32_t>(offset), options, submatch, 3 * subpatterns_count);
   dl::leave_critical_section();
 
@@ -1002,6 +843,7 @@ int64_t regexp::last_error() {
     case PCRE_ERROR_MATCHLIMIT:
       return PHP_PCRE_BACKTRACK_LIMIT_ERROR;
     case PCRE_ERROR_RECURSIONLIMIT:
+    case PCRE_ERROR_JIT_STACKLIMIT:
       return PHP_PCRE_RECURSION_LIMIT_ERROR;
     case PCRE_ERROR_BADUTF8:
       return PHP_PCRE_BAD_UTF8_ERROR;
@@ -1070,3 +912,11 @@ void global_init_regexp_lib() {
   regexp::global_init();
 }
 
+void set_regexp_cache_size_limit(size_t limit) noexcept {
+  regexp_cache_size_limit = limit;
+}
+
+const RegexpCacheStats &regexp_cache_get_stats() noexcept {
+  return RegexpCache::get().get_stats();
+}
+
@@ -7,6 +7,7 @@
 #include <pcre.h>
 
 #include "common/mixin/not_copyable.h"
+#include "common/regexp-pattern.h"
 
 #include "runtime/kphp_core.h"
 #include "runtime/mbstring.h"
@@ -32,6 +33,9 @@ constexpr int64_t PCRE_BACKTRACK_LIMIT = 1000000;
 
 constexpr int32_t MAX_SUBPATTERNS = 512;
 
+// default upper bound of compiled regexps kept by each worker between requests
+constexpr size_t DEFAULT_REGEXP_CACHE_SIZE_LIMIT = 4096;
+
 enum {
   PHP_PCRE_NO_ERROR = 0,
   PHP_PCRE_INTERNAL_ERROR,
@@ -40,22 +44,49 @@ enum {
   PHP_PCRE_BAD_UTF8_ERROR,
 };
 
+using vk::RegexpEngine;
+
+struct RegexpCacheStats {
+  int64_t hits{0};
+  int64_t misses{0};
+  int64_t evictions{0};
+  // misses that weren't cached, because all the cached patterns were used by the current request
+  int64_t uncached{0};
+  int64_t size{0};
+};
+
+class RegexpCache;
+
 class regexp : vk::not_copyable {
 private:
   int32_t subpatterns_count{0};
   int32_t named_subpatterns_count{0};
   bool is_utf8{false};
   bool use_heap_memory{false};
+  // compiled pcre and RE2 objects are owned by the worker regexp cache, see RegexpCache
+  bool is_cached{false};
 
   string *subpattern_names{nullptr};
 
   pcre *pcre_regexp{nullptr};
+  pcre_extra *pcre_study_extra{nullptr};
   re2::RE2 *RE2_regexp{nullptr};
 
   char *regex_compilation_warning{nullptr};
 
+  friend class RegexpCache;
+
   void clean();
 
+  void compile(const char *regexp_string, int64_t regexp_len, bool with_subpattern_names, const char *function, const char *file,
+               RegexpEngine engine = RegexpEngine::auto_detect);
+
+  void init_subpattern_names(const char *function, const char *file);
+
+  void copy_compiled_state(const regexp &other) noexcept;
+
+  void use_cached(const regexp &cached, const char *function, const char *file);
+
   int64_t exec(const string &subject, int64_t offset, bool second_try) const;
 
   bool is_valid_RE2_regexp(const char *regexp_string, int64_t regexp_len, bool is_utf8, const char *function, const char *file) noexcept;
@@ -79,7 +110,7 @@ public:
   explicit regexp(const string &regexp_string);
   regexp(const char *regexp_string, int64_t regexp_len);
 
-  void init(const string &regexp_string, const char *function = nullptr, const char *file = nullptr);
+  void init(const string &regexp_string, const char *function = nullptr, const char *file = nullptr, RegexpEngine engine = RegexpEngine::auto_detect);
   void init(const char *regexp_string, int64_t regexp_len, const char *function = nullptr, const char *file = nullptr);
 
 
@@ -102,6 +133,11 @@ public:
 
 void global_init_regexp_lib();
 
+// this function should be called from master before workers are started
+void set_regexp_cache_size_limit(size_t limit) noexcept;
+// stats of the current worker regexp cache
+const RegexpCacheStats &regexp_cache_get_stats() noexcept;
+
 inline void preg_add_match(array<mixed> &v, const mixed &match, const string &name);
 inline void preg_add_match(array<string> &v, const string &match, const string &name);
 
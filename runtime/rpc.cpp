@@ -193,6 +193,34 @@ int32_t rpc_fetch_int() {
   return *rpc_data++;
 }
 
+bool rpc_check_fetch_len(int32_t x4_bytes_length) {
+  CHECK_EXCEPTION(return false);
+  if (rpc_data_len < x4_bytes_length) {
+    THROW_EXCEPTION(new_Exception(rpc_filename, __LINE__, string("Not enough data to fetch", 24), -1));
+    return false;
+  }
+  return true;
+}
+
+int32_t rpc_fetch_int_unchecked() {
+  rpc_data_len--;
+  return *rpc_data++;
+}
+
+int64_t rpc_fetch_long_unchecked() {
+  rpc_data_len -= 2;
+  int64_t result = *reinterpret_cast<const int64_t *>(rpc_data);
+  rpc_data += 2;
+  return result;
+}
+
+double rpc_fetch_double_unchecked() {
+  rpc_data_len -= 2;
+  double result = *reinterpret_cast<const double *>(rpc_data);
+  rpc_data += 2;
+  return result;
+}
+
 int64_t f$fetch_int() {
   return rpc_fetch_int();
 }
@@ -232,6 +260,22 @@ double f$fetch_float() {
   return result;
 }
 
+void f$fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems) {
+  TRY_CALL_VOID(void, (check_rpc_data_len(n_elems)));
+  // int32 values are widened, so they can't be copied with memcpy
+  for (int64_t i = 0; i < n_elems; ++i) {
+    out.push_back(rpc_data[i]);
+  }
+  rpc_data += n_elems;
+}
+
+void f$fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems) {
+  int64_t rpc_data_buf_offset = static_cast<int64_t>(sizeof(int64_t) * n_elems / 4);
+  TRY_CALL_VOID(void, (check_rpc_data_len(rpc_data_buf_offset)));
+  out.memcpy_vector(n_elems, rpc_data);
+  rpc_data += rpc_data_buf_offset;
+}
+
 void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems) {
   int64_t rpc_data_buf_offset = static_cast<int64_t>(sizeof(double) * n_elems / 4);
   TRY_CALL_VOID(void, (check_rpc_data_len(rpc_data_buf_offset)));
@@ -617,9 +661,9 @@ protected:
 
 /*
     if (request->resumable_id == -1) {
-      int len = *reinterpret_cast <int *>(request->answer - 12);
+      int len = *reinterpret_cast <int *>(request->answer - STRING_RAW_HEADER_SIZE);
       fprintf (stderr, "Receive  string of len %d at %p\n", len, request->answer);
-      for (int i = -12; i <= len; i++) {
+      for (int i = -STRING_RAW_HEADER_SIZE; i <= len; i++) {
         fprintf (stderr, "%d: %x(%d)\t%c\n", i, request->answer[i], request->answer[i], request->answer[i] >= 32 ? request->answer[i] : '.');
       }
     }
@@ -788,15 +832,21 @@ int64_t f$rpc_send_noflush(const class_instance<C$RpcConnection> &conn, double t
 }
 
 
-void process_rpc_answer(int32_t request_id, char *result, int32_t result_len __attribute__((unused))) {
+void process_rpc_answer(int32_t request_id, net_event_t *answer) {
   rpc_request *request = get_rpc_request(request_id);
 
   if (request->resumable_id < 0) {
-    php_assert (result != nullptr);
-    dl::deallocate(result - 12, result_len + 13);
+    // nobody waits for the answer (ignored or timed out query), so it is never copied into the script memory
+    free_rpc_answer_event(answer);
     php_assert (request->resumable_id != -1);
     return;
   }
+  char *answer_data = fetch_rpc_answer_event(answer);
+  if (answer_data == nullptr) {
+    // the answer doesn't fit into the script memory, the query fails instead of the whole script
+    process_rpc_error(request_id, TL_ERROR_OUT_OF_MEMORY, "Memory limit exceeded on rpc answer");
+    return;
+  }
   int64_t resumable_id = request->resumable_id;
   request->resumable_id = -1;
 
@@ -804,9 +854,7 @@ void process_rpc_answer(int32_t request_id, char *result, int32_t result_len __a
     remove_event_timer(request->timer);
   }
 
-  php_assert (result != nullptr);
-  request->answer = result;
-//  fprintf (stderr, "answer_len = %d\n", result_len);
+  request->answer = answer_data;
 
   php_assert (resumable_id > 0);
   resumable_run_ready(resumable_id);
@@ -870,7 +918,7 @@ protected:
       php_assert (res.resumable_id == -1);
 
       string result;
-      result.assign_raw(res.answer - 12);
+      result.assign_raw(res.answer - STRING_RAW_HEADER_SIZE);
       RETURN(result);
     RESUMABLE_END
   }
@@ -943,7 +991,7 @@ protected:
       php_assert (res.resumable_id == -1);
 
       string result;
-      result.assign_raw(res.answer - 12);
+      result.assign_raw(res.answer - STRING_RAW_HEADER_SIZE);
       bool parse_result = f$rpc_parse(result);
       php_assert(parse_result);
 
@@ -9,6 +9,8 @@
 #include "runtime/kphp_core.h"
 #include "runtime/resumable.h"
 
+struct net_event_t;
+
 extern long long rpc_tl_results_last_query_num;
 
 extern const string tl_str_;
@@ -22,7 +24,7 @@ extern const int64_t tl_str_result_hash;
 
 extern bool fail_rpc_on_int32_overflow;
 
-void process_rpc_answer(int32_t request_id, char *result, int32_t result_len);
+void process_rpc_answer(int32_t request_id, net_event_t *answer);
 
 void process_rpc_error(int32_t request_id, int32_t error_code, const char *error_message);
 
@@ -50,6 +52,12 @@ int32_t rpc_lookup_int();
 
 int32_t rpc_fetch_int();
 
+// the fixed size parts of TL combinators are fetched with the unchecked functions after a single bounds check
+bool rpc_check_fetch_len(int32_t x4_bytes_length);
+int32_t rpc_fetch_int_unchecked();
+int64_t rpc_fetch_long_unchecked();
+double rpc_fetch_double_unchecked();
+
 int64_t f$fetch_int();
 
 int64_t f$fetch_lookup_int();
@@ -71,6 +79,10 @@ bool f$fetch_eof();
 
 bool f$fetch_end();
 
+void f$fetch_raw_vector_int(array<int64_t> &out, int64_t n_elems);
+
+void f$fetch_raw_vector_long(array<int64_t> &out, int64_t n_elems);
+
 void f$fetch_raw_vector_double(array<double> &out, int64_t n_elems);
 
 void estimate_and_flush_overflow(size_t &bytes_sent);
@@ -9,6 +9,7 @@ prepend(KPHP_RUNTIME_MEMORY_RESOURCE_SOURCES memory_resource/
 
 prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         ${KPHP_RUNTIME_MEMORY_RESOURCE_SOURCES}
+        aho-corasick.cpp
         allocator.cpp
         array_functions.cpp
         bcmath.cpp
@@ -20,6 +21,7 @@ prepend(KPHP_RUNTIME_SOURCES ${BASE_DIR}/runtime/
         datetime.cpp
         exception.cpp
         files.cpp
+        http-compression.cpp
         instance_cache.cpp
         inter-process-mutex.cpp
         interface.cpp
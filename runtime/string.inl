@@ -18,6 +18,7 @@ void string::string_inner::set_length_and_sharable(size_type n) {
 //  fprintf (stderr, "inc ref cnt %d %s\n", 0, ref_data());
   ref_count = 0;
   size = n;
+  hash = STRING_HASH_UNKNOWN;
   ref_data()[n] = '\0';
 }
 
@@ -50,6 +51,7 @@ string::string_inner *string::string_inner::create(size_type requested_capacity,
   size_type new_size = (size_type)(sizeof(string_inner) + (capacity + 1));
   string_inner *p = (string_inner *)dl::allocate(new_size);
   p->capacity = capacity;
+  p->hash = STRING_HASH_UNKNOWN;
   return p;
 }
 
@@ -308,6 +310,9 @@ string::size_type string::capacity() const {
 void string::make_not_shared() {
   if (inner()->is_shared()) {
     force_reserve(size());
+  } else {
+    // the caller is going to modify the string inplace
+    inner()->hash = STRING_HASH_UNKNOWN;
   }
 }
 
@@ -326,8 +331,12 @@ void string::force_reserve(size_type res) {
 string &string::reserve_at_least(size_type res) {
   if (inner()->is_shared()) {
     force_reserve(res);
-  } else if (res > capacity()) {
-    p = inner()->reserve(res);
+  } else {
+    if (res > capacity()) {
+      p = inner()->reserve(res);
+    }
+    // it is followed by inplace appends
+    inner()->hash = STRING_HASH_UNKNOWN;
   }
   return *this;
 }
@@ -550,6 +559,7 @@ string &string::append_unsafe(const mixed &v) {
 
 string &string::finish_append() {
   php_assert (inner()->size <= inner()->capacity);
+  inner()->hash = STRING_HASH_UNKNOWN;
   p[inner()->size] = '\0';
   return *this;
 }
@@ -627,7 +637,7 @@ string &string::assign(size_type n, bool b __attribute__((unused))) {
 
 
 void string::assign_raw(const char *s) {
-  static_assert (sizeof(string_inner) == 12u, "need 12 bytes");
+  static_assert (sizeof(string_inner) == STRING_RAW_HEADER_SIZE, "string_inner should match the raw string header");
   p = const_cast <char *> (s + sizeof(string_inner));
 }
 
@@ -639,6 +649,7 @@ void string::swap(string &s) {
 }
 
 char *string::buffer() {
+  inner()->hash = STRING_HASH_UNKNOWN;
   return p;
 }
 
@@ -838,7 +849,17 @@ bool string::is_numeric() const {
 }
 
 int64_t string::hash() const {
-  return string_hash(p, size());
+  string_inner *s = inner();
+  if (s->hash != STRING_HASH_UNKNOWN) {
+    return s->hash;
+  }
+  const int64_t result = string_hash(p, size());
+  // strings with extra reference counters can be read only or shared between processes,
+  // their hash is precomputed in set_reference_counter_to()
+  if (s->ref_count < ExtraRefCnt::for_global_const) {
+    s->hash = result;
+  }
+  return result;
 }
 
 
@@ -934,6 +955,7 @@ bool string::is_reference_counter(ExtraRefCnt ref_cnt_value) const noexcept {
 void string::set_reference_counter_to(ExtraRefCnt ref_cnt_value) noexcept {
   // some const arrays are placed in read only memory and can't be modified
   if (inner()->ref_count != ref_cnt_value) {
+    inner()->hash = string_hash(p, size());
     inner()->ref_count = ref_cnt_value;
   }
 }
@@ -954,7 +976,7 @@ inline string::size_type string::estimate_memory_usage() const {
 
 inline string string::make_const_string_on_memory(const char *str, size_type len, void *memory, size_t memory_size) {
   php_assert(len + inner_sizeof() + 1 <= memory_size);
-  auto *inner = new (memory) string_inner {len, len, ExtraRefCnt::for_global_const};
+  auto *inner = new (memory) string_inner {len, len, ExtraRefCnt::for_global_const, string_hash(str, len)};
   memcpy(inner->ref_data(), str, len);
   inner->ref_data()[len] = '\0';
   string result;
@@ -13,10 +13,15 @@ private:
   char *p;
 
 private:
+  // keeps string_inner 4-byte aligned, so the header occupies STRING_RAW_HEADER_SIZE bytes without padding
+  typedef int64_t hash_type __attribute__ ((aligned (4)));
+
   struct string_inner {
     size_type size;
     size_type capacity;
     int ref_count;
+    // lazily computed string::hash(), it is reset on every modification of the string
+    hash_type hash{STRING_HASH_UNKNOWN};
 
     inline bool is_shared() const;
     inline void set_length_and_sharable(size_type n);
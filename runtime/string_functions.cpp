@@ -7,6 +7,7 @@
 #include <clocale>
 #include <endian.h>
 
+#include "common/algorithms/simd-byte-class.h"
 #include "common/unicode/unicode-utils.h"
 
 #include "runtime/interface.h"
@@ -28,20 +29,19 @@ const char uhex_digits[17] = "0123456789ABCDEF";
 
 int64_t str_replace_count_dummy;
 
-static inline const char *get_mask(const string &what) {
-  static char mask[256];
-  memset(mask, 0, 256);
+static vk::byte_class get_mask(const string &what) {
+  vk::byte_class mask;
 
   int len = what.size();
   for (int i = 0; i < len; i++) {
     unsigned char c = what[i];
     if (what[i + 1] == '.' && what[i + 2] == '.' && (unsigned char)what[i + 3] >= c) {
-      memset(mask + c, 1, (unsigned char)what[i + 3] - c + 1);
+      mask.add_range(c, (unsigned char)what[i + 3]);
       i += 3;
     } else if (c == '.' && what[i + 1] == '.') {
       php_warning("Invalid '..'-range in string \"%s\" at position %d.", what.c_str(), i);
     } else {
-      mask[c] = 1;
+      mask.add(c);
     }
   }
 
@@ -49,14 +49,14 @@ static inline const char *get_mask(const string &what) {
 }
 
 string f$addcslashes(const string &str, const string &what) {
-  const char *mask = get_mask(what);
+  const vk::byte_class mask = get_mask(what);
 
   int len = str.size();
   static_SB.clean().reserve(4 * len);
 
   for (int i = 0; i < len; i++) {
     unsigned char c = str[i];
-    if (mask[c]) {
+    if (mask.contains(c)) {
       static_SB.append_char('\\');
       if (c < 32 || c > 126) {
         switch (c) {
@@ -97,24 +97,24 @@ string f$addcslashes(const string &str, const string &what) {
 }
 
 string f$addslashes(const string &str) {
-  int len = str.size();
+  static const vk::byte_class escaped_chars{vk::string_view{"\0'\"\\", 4}};
 
-  static_SB.clean().reserve(2 * len);
-  for (int i = 0; i < len; i++) {
-    switch (str[i]) {
-      case '\0':
-        static_SB.append_char('\\');
-        static_SB.append_char('0');
-        break;
-      case '\'':
-      case '\"':
-      case '\\':
-        static_SB.append_char('\\');
-        /* fallthrough */
-      default:
-        static_SB.append_char(str[i]);
-    }
+  const char *piece = str.c_str();
+  const char *str_end = str.c_str() + str.size();
+  const char *escaped = escaped_chars.find_first_of(piece, str_end);
+  if (escaped == str_end) {
+    return str;
   }
+
+  static_SB.clean().reserve(2 * str.size());
+  do {
+    static_SB.append(piece, escaped - piece);
+    static_SB.append_char('\\');
+    static_SB.append_char(*escaped == '\0' ? '0' : *escaped);
+    piece = escaped + 1;
+    escaped = escaped_chars.find_first_of(piece, str_end);
+  } while (escaped != str_end);
+  static_SB.append(piece, str_end - piece);
   return static_SB.str();
 }
 
@@ -458,63 +458,47 @@ string f$html_entity_decode(const string &str, int64_t flags, const string &enco
 }
 
 string f$htmlspecialchars(const string &str, int64_t flags) {
-  if (flags >= 3) {
+  if (flags < 0 || flags >= 3) {
     php_critical_error ("unsupported parameter flags = %ld in function htmlspecialchars", flags);
   }
 
-  const string::size_type len = str.size();
-  static_SB.clean().reserve(6 * len);
+  // indexed by flags: ENT_COMPAT, ENT_QUOTES, ENT_NOQUOTES
+  static const vk::byte_class special_chars[3] = {vk::byte_class{"&\"<>"}, vk::byte_class{"&\"'<>"}, vk::byte_class{"&<>"}};
+  const vk::byte_class &escaped_chars = special_chars[flags];
 
-  for (string::size_type i = 0; i < len; i++) {
-    switch (str[i]) {
+  const char *piece = str.c_str();
+  const char *str_end = str.c_str() + str.size();
+  const char *escaped = escaped_chars.find_first_of(piece, str_end);
+  if (escaped == str_end) {
+    return str;
+  }
+
+  static_SB.clean().reserve(6 * str.size());
+  do {
+    static_SB.append(piece, escaped - piece);
+    switch (*escaped) {
       case '&':
-        static_SB.append_char('&');
-        static_SB.append_char('a');
-        static_SB.append_char('m');
-        static_SB.append_char('p');
-        static_SB.append_char(';');
+        static_SB.append("&amp;", 5);
         break;
       case '"':
-        if (!(flags & ENT_NOQUOTES)) {
-          static_SB.append_char('&');
-          static_SB.append_char('q');
-          static_SB.append_char('u');
-          static_SB.append_char('o');
-          static_SB.append_char('t');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('"');
-        }
+        static_SB.append("&quot;", 6);
         break;
       case '\'':
-        if (flags & ENT_QUOTES) {
-          static_SB.append_char('&');
-          static_SB.append_char('#');
-          static_SB.append_char('0');
-          static_SB.append_char('3');
-          static_SB.append_char('9');
-          static_SB.append_char(';');
-        } else {
-          static_SB.append_char('\'');
-        }
+        static_SB.append("&#039;", 6);
         break;
       case '<':
-        static_SB.append_char('&');
-        static_SB.append_char('l');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append("&lt;", 4);
         break;
       case '>':
-        static_SB.append_char('&');
-        static_SB.append_char('g');
-        static_SB.append_char('t');
-        static_SB.append_char(';');
+        static_SB.append("&gt;", 4);
         break;
       default:
-        static_SB.append_char(str[i]);
+        php_assert(0);
     }
-  }
-
+    piece = escaped + 1;
+    escaped = escaped_chars.find_first_of(piece, str_end);
+  } while (escaped != str_end);
+  static_SB.append(piece, str_end - piece);
   return static_SB.str();
 }
 
@@ -612,18 +596,15 @@ int64_t f$levenshtein(const string &str1, const string &str2) {
 }
 
 string f$ltrim(const string &s, const string &what) {
-  const char *mask = get_mask(what);
+  const vk::byte_class mask = get_mask(what);
 
   int len = (int)s.size();
-  if (len == 0 || !mask[(unsigned char)s[0]]) {
+  if (len == 0 || !mask.contains(s[0])) {
     return s;
   }
 
-  int l = 1;
-  while (l < len && mask[(unsigned char)s[l]]) {
-    l++;
-  }
-  return string(s.c_str() + l, len - l);
+  const char *l = mask.find_first_not_of(s.c_str() + 1, s.c_str() + len);
+  return string(l, static_cast<string::size_type>(s.c_str() + len - l));
 }
 
 string f$mysql_escape_string(const string &str) {
@@ -954,18 +935,15 @@ int64_t f$printf(const string &format, const array<mixed> &a) {
 }
 
 string f$rtrim(const string &s, const string &what) {
-  const char *mask = get_mask(what);
+  const vk::byte_class mask = get_mask(what);
 
   int len = (int)s.size() - 1;
-  if (len == -1 || !mask[(unsigned char)s[len]]) {
+  if (len == -1 || !mask.contains(s[len])) {
     return s;
   }
 
-  while (len > 0 && mask[(unsigned char)s[len - 1]]) {
-    len--;
-  }
-
-  return string(s.c_str(), len);
+  const char *r = mask.find_last_not_of(s.c_str(), s.c_str() + len);
+  return string(s.c_str(), static_cast<string::size_type>(r - s.c_str()));
 }
 
 Optional<string> f$setlocale(int64_t category, const string &locale) {
@@ -1834,16 +1812,34 @@ string f$strtoupper(const string &str) {
 }
 
 string f$strtr(const string &subject, const string &from, const string &to) {
-  int n = subject.size();
-  string result(n, false);
-  for (int i = 0; i < n; i++) {
-    const char *p = static_cast <const char *> (memchr(static_cast <const void *> (from.c_str()), (int)(unsigned char)subject[i], (size_t)from.size()));
-    if (p == nullptr || static_cast<string::size_type>(p - from.c_str()) >= to.size()) {
-      result[i] = subject[i];
-    } else {
-      result[i] = to[static_cast<string::size_type>(p - from.c_str())];
+  // the first occurrence of a byte in from is used
+  std::array<char, 256> translation;
+  for (size_t c = 0; c < translation.size(); ++c) {
+    translation[c] = static_cast<char>(c);
+  }
+  for (string::size_type i = from.size(); i-- > 0;) {
+    translation[static_cast<unsigned char>(from[i])] = i < to.size() ? to[i] : from[i];
+  }
+  vk::byte_class translated;
+  for (string::size_type i = 0; i < from.size() && i < to.size(); ++i) {
+    const auto c = static_cast<unsigned char>(from[i]);
+    if (translation[c] != from[i]) {
+      translated.add(c);
     }
   }
+
+  const char *subject_end = subject.c_str() + subject.size();
+  const char *first_translated = translated.find_first_of(subject.c_str(), subject_end);
+  if (first_translated == subject_end) {
+    return subject;
+  }
+
+  string result(subject.size(), false);
+  const auto prefix_len = static_cast<string::size_type>(first_translated - subject.c_str());
+  memcpy(result.buffer(), subject.c_str(), prefix_len);
+  for (string::size_type i = prefix_len; i < subject.size(); i++) {
+    result[i] = translation[static_cast<unsigned char>(subject[i])];
+  }
   return result;
 }
 
@@ -2027,16 +2023,41 @@ string str_replace_string(const mixed &search, const mixed &replace, const strin
   if (search.is_array() && replace.is_array()) {
     return str_replace_string_array(search.as_array(""), replace.as_array(""), subject, replace_count);
   } else if (search.is_array()) {
-    string result = subject;
+    const array<mixed> &search_array = search.as_array("");
     const string &replace_value = replace.to_string();
-
-    for (array<mixed>::const_iterator it = search.begin(); it != search.end(); ++it) {
-      const string &search_string = f$strval(it.get_value());
+    auto replace_one = [&replace_value, &replace_count](const string &search_string, string &result) {
       if (search_string.size() >= replace_value.size()) {
         str_replace_inplace(search_string, replace_value, result, replace_count);
       } else {
         result = str_replace(search_string, replace_value, result, replace_count);
       }
+    };
+
+    if (search_array.count() >= STR_REPLACE_AHO_CORASICK_MIN_SEARCH_COUNT) {
+      AhoCorasickPatterns patterns;
+      patterns.search.reserve(search_array.count(), 0, true);
+      patterns.replace.reserve(search_array.count(), 0, true);
+      for (array<mixed>::const_iterator it = search_array.begin(); it != search_array.end(); ++it) {
+        patterns.add(f$strval(it.get_value()), replace_value);
+      }
+      string result;
+      if (aho_corasick_replace(subject, result, replace_count, true, nullptr, nullptr,
+                               [&patterns]() -> const AhoCorasickPatterns & { return patterns; })) {
+        return result;
+      }
+
+      // the search values are already converted for the automaton
+      result = subject;
+      for (int64_t i = 0; i < patterns.search.count(); ++i) {
+        replace_one(patterns.search.get_value(i), result);
+      }
+      return result;
+    }
+
+    string result = subject;
+
+    for (array<mixed>::const_iterator it = search.begin(); it != search.end(); ++it) {
+      replace_one(f$strval(it.get_value()), result);
     }
     return result;
   } else {
@@ -2245,26 +2266,20 @@ Optional<int64_t> f$substr_compare(const string &main_str, const string &str, in
 }
 
 string f$trim(const string &s, const string &what) {
-  const char *mask = get_mask(what);
+  const vk::byte_class mask = get_mask(what);
 
   int len = (int)s.size();
-  if (len == 0 || (!mask[(unsigned char)s[len - 1]] && !mask[(unsigned char)s[0]])) {
+  if (len == 0 || (!mask.contains(s[len - 1]) && !mask.contains(s[0]))) {
     return s;
   }
 
-  while (len > 0 && mask[(unsigned char)s[len - 1]]) {
-    len--;
-  }
-
-  if (len == 0) {
+  const char *r = mask.find_last_not_of(s.c_str(), s.c_str() + len);
+  if (r == s.c_str()) {
     return string();
   }
 
-  int l = 0;
-  while (mask[(unsigned char)s[l]]) {
-    l++;
-  }
-  return string(s.c_str() + l, len - l);
+  const char *l = mask.find_first_not_of(s.c_str(), r);
+  return string(l, static_cast<string::size_type>(r - l));
 }
 
 string f$ucfirst(const string &str) {
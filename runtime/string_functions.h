@@ -5,6 +5,8 @@
 #pragma once
 
 #include <type_traits>
+
+#include "runtime/aho-corasick.h"
 #include "runtime/kphp_core.h"
 
 extern const string COLON;
@@ -165,9 +167,62 @@ string f$str_replace(const string &search, const string &replace, const string &
 void str_replace_inplace(const string &search, const string &replace, string &subject, int64_t &replace_count);
 string str_replace(const string &search, const string &replace, const string &subject, int64_t &replace_count);
 
+// str_replace with fewer search strings is faster with memmem passes than with building an automaton
+constexpr int64_t STR_REPLACE_AHO_CORASICK_MIN_SEARCH_COUNT = 8;
+
+// the automatons are cached only for the constant arrays, as their addresses don't change
+template<class T>
+const void *get_aho_corasick_cache_key(const array<T> &arr) noexcept {
+  return arr.is_reference_counter(ExtraRefCnt::for_global_const) ? arr.get_inner_pointer() : nullptr;
+}
+
 template<typename T1, typename T2>
 string str_replace_string_array(const array<T1> &search, const array<T2> &replace, const string &subject, int64_t &replace_count) {
+  AhoCorasickPatterns patterns;
+  auto get_patterns = [&search, &replace, &patterns]() -> const AhoCorasickPatterns & {
+    if (!patterns.is_filled) {
+      patterns.search.reserve(search.count(), 0, true);
+      patterns.replace.reserve(search.count(), 0, true);
+      typename array<T2>::const_iterator cur_replace_val = replace.begin();
+      for (typename array<T1>::const_iterator it = search.begin(); it != search.end(); ++it) {
+        string replace_value;
+        if (cur_replace_val != replace.end()) {
+          replace_value = f$strval(cur_replace_val.get_value());
+          ++cur_replace_val;
+        }
+        patterns.add(f$strval(it.get_value()), replace_value);
+      }
+      patterns.is_filled = true;
+    }
+    return patterns;
+  };
+
+  const void *search_key = get_aho_corasick_cache_key(search);
+  const void *replace_key = get_aho_corasick_cache_key(replace);
+  const bool is_cacheable = search_key && replace_key;
+  if (is_cacheable || search.count() >= STR_REPLACE_AHO_CORASICK_MIN_SEARCH_COUNT) {
+    string result;
+    if (aho_corasick_replace(subject, result, replace_count, true, is_cacheable ? search_key : nullptr, is_cacheable ? replace_key : nullptr, get_patterns)) {
+      return result;
+    }
+  }
+
   string result = subject;
+  auto replace_one = [&result, &replace_count](const string &search_string, const string &replace_value) {
+    if (search_string.size() >= replace_value.size()) {
+      str_replace_inplace(search_string, replace_value, result, replace_count);
+    } else {
+      result = str_replace(search_string, replace_value, result, replace_count);
+    }
+  };
+
+  // the values converted for the automaton aren't converted again
+  if (patterns.is_filled) {
+    for (int64_t i = 0; i < patterns.search.count(); ++i) {
+      replace_one(patterns.search.get_value(i), patterns.replace.get_value(i));
+    }
+    return result;
+  }
 
   string replace_value;
   typename array<T2>::const_iterator cur_replace_val;
@@ -181,12 +236,7 @@ string str_replace_string_array(const array<T1> &search, const array<T2> &replac
       replace_value = string();
     }
 
-    const string &search_string = f$strval(it.get_value());
-    if (search_string.size() >= replace_value.size()) {
-      str_replace_inplace(search_string, replace_value, result, replace_count);
-    } else {
-      result = str_replace(search_string, replace_value, result, replace_count);
-    }
+    replace_one(f$strval(it.get_value()), replace_value);
   }
 
   return result;
@@ -347,6 +397,21 @@ Optional<string> f$strstr(const string &haystack, const mixed &needle, bool befo
 
 template<class T>
 string f$strtr(const string &subject, const array<T> &replace_pairs) {
+  if (replace_pairs.count() > 1) {
+    string result;
+    int64_t replace_count = 0;
+    AhoCorasickPatterns patterns;
+    aho_corasick_replace(subject, result, replace_count, false, get_aho_corasick_cache_key(replace_pairs), nullptr, [&replace_pairs, &patterns]() -> const AhoCorasickPatterns & {
+      patterns.search.reserve(replace_pairs.count(), 0, true);
+      patterns.replace.reserve(replace_pairs.count(), 0, true);
+      for (typename array<T>::const_iterator p = replace_pairs.begin(); p != replace_pairs.end(); ++p) {
+        patterns.add(f$strval(p.get_key()), f$strval(p.get_value()));
+      }
+      return patterns;
+    });
+    return result;
+  }
+
   const char *piece = subject.c_str(), *piece_end = subject.c_str() + subject.size();
   string result;
   while (1) {
@@ -76,15 +76,14 @@ inline void fetch_magic_if_not_bare(unsigned int inner_magic, const char *error_
   }
 }
 
+// the bare vectors of the fixed size TL types are fetched with a single bounds check instead of per element fetching
 template<class T>
-inline void fetch_raw_vector_T(array<T> &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
-  php_assert(0 && "never called in runtime");
-}
-
-template<>
-inline void fetch_raw_vector_T<double>(array<double> &out, int64_t n_elems) {
-  f$fetch_raw_vector_double(out, n_elems);
-}
+struct tl_raw_vector_fetcher : std::false_type {
+  template<class PhpType>
+  static void fetch_to(array<PhpType> &out __attribute__ ((unused)), int64_t n_elems __attribute__ ((unused))) {
+    php_assert(0 && "never called in runtime");
+  }
+};
 
 template<class T>
 inline void store_raw_vector_T(const array<T> &v __attribute__ ((unused))) {
@@ -161,6 +160,15 @@ struct t_Int {
     out = rpc_fetch_int();
   }
 
+  // must be called only after rpc_check_fetch_len()
+  int fetch_unchecked() {
+    return rpc_fetch_int_unchecked();
+  }
+
+  void typed_fetch_unchecked_to(PhpType &out) {
+    out = rpc_fetch_int_unchecked();
+  }
+
   static int32_t prepare_int_for_storing(int64_t v) {
     auto v32 = static_cast<int32_t>(v);
     if (unlikely(is_int32_overflow(v))) {
@@ -195,6 +203,14 @@ struct t_Long {
     CHECK_EXCEPTION(return);
     out = f$fetch_long();
   }
+
+  mixed fetch_unchecked() {
+    return rpc_fetch_long_unchecked();
+  }
+
+  void typed_fetch_unchecked_to(PhpType &out) {
+    out = rpc_fetch_long_unchecked();
+  }
 };
 
 struct t_Double {
@@ -217,6 +233,14 @@ struct t_Double {
     CHECK_EXCEPTION(return);
     out = f$fetch_double();
   }
+
+  double fetch_unchecked() {
+    return rpc_fetch_double_unchecked();
+  }
+
+  void typed_fetch_unchecked_to(PhpType &out) {
+    out = rpc_fetch_double_unchecked();
+  }
 };
 
 struct t_Float {
@@ -241,6 +265,27 @@ struct t_Float {
   }
 };
 
+template<>
+struct tl_raw_vector_fetcher<t_Int> : std::true_type {
+  static void fetch_to(array<int64_t> &out, int64_t n_elems) {
+    f$fetch_raw_vector_int(out, n_elems);
+  }
+};
+
+template<>
+struct tl_raw_vector_fetcher<t_Long> : std::true_type {
+  static void fetch_to(array<int64_t> &out, int64_t n_elems) {
+    f$fetch_raw_vector_long(out, n_elems);
+  }
+};
+
+template<>
+struct tl_raw_vector_fetcher<t_Double> : std::true_type {
+  static void fetch_to(array<double> &out, int64_t n_elems) {
+    f$fetch_raw_vector_double(out, n_elems);
+  }
+};
+
 struct t_String {
   void store(const mixed &tl_object) {
     f$store_string(f$strval(tl_object));
@@ -390,8 +435,8 @@ struct t_Vector {
     }
     out.reserve(n, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, n);
+    if (tl_raw_vector_fetcher<T>{} && inner_magic == 0) {
+      tl_raw_vector_fetcher<T>::fetch_to(out, n);
       return;
     }
 
@@ -624,8 +669,8 @@ struct t_Tuple {
     CHECK_EXCEPTION(return);
     out.reserve(size, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if (tl_raw_vector_fetcher<T>{} && inner_magic == 0) {
+      tl_raw_vector_fetcher<T>::fetch_to(out, size);
       return;
     }
 
@@ -697,8 +742,8 @@ struct tl_array {
     CHECK_EXCEPTION(return);
     out.reserve(size, 0, true);
 
-    if (std::is_same<T, t_Double>{} && inner_magic == 0) {
-      fetch_raw_vector_T<typename T::PhpType>(out, size);
+    if (tl_raw_vector_fetcher<T>{} && inner_magic == 0) {
+      tl_raw_vector_fetcher<T>::fetch_to(out, size);
       return;
     }
 
@@ -157,7 +157,8 @@ public:
   };
 
   ConfdataUpdateResult finish_confdata_update() noexcept {
-    for (auto &confdata_section: *updating_confdata_storage_) {
+    // the sections shared with the previous confdata are already marked
+    updating_confdata_storage_->for_each_not_shared([this](confdata_sample_storage::value_type &confdata_section) {
       // save into the separate variable to avoid the const_cast
       string key = confdata_section.first;
       mark_string_as_confdata_const(key);
@@ -166,7 +167,7 @@ public:
       } else if (confdata_section.second.is_string()) {
         mark_string_as_confdata_const(confdata_section.second.as_string());
       }
-    }
+    });
 
     ConfdataUpdateResult result{
       std::move(*updating_confdata_storage_),
@@ -185,6 +186,7 @@ public:
     if (!confdata_has_any_updates_) {
       assert(garbage_from_previous_confdata_sample_.empty());
       if (updating_confdata_storage_->empty()) {
+        // the storages share all sections, they will be copied on the first modification
         *updating_confdata_storage_ = previous_confdata_storage;
       } else {
         // strictly speaking, they should be identical, but it's too hard to verify
@@ -221,6 +223,10 @@ public:
     return event_counters_;
   }
 
+  const ConfdataStats::ElementsCounters &get_elements_counters() const noexcept {
+    return elements_counters_;
+  }
+
 private:
   ConfdataBinlogReplayer() noexcept:
     key_blacklist_(ConfdataGlobalManager::get().get_key_blacklist()),
@@ -359,16 +365,21 @@ private:
       // move deleted element key and value to garbage
       put_confdata_element_value_into_garbage(first_key_it->second);
       put_confdata_var_into_garbage(first_key_it->first, ConfdataGarbageDestroyWay::shallow_first);
-      updating_confdata_storage_->erase(first_key_it);
+      elements_counters_.on_section_removed(first_key_it->first, first_key_it->second, predefined_wildcards_);
+      updating_confdata_storage_->erase(processing_key_.get_first_key());
       return OperationStatus::full_update;
     }
 
     assert(first_key_it->second.is_array());
-    auto &array_for_second_key = first_key_it->second.as_array();
-    if (!array_for_second_key.has_key(processing_key_.get_second_key())) {
+    if (!first_key_it->second.as_array().has_key(processing_key_.get_second_key())) {
       return OperationStatus::no_update;
     }
 
+    // copy the path to the section, the previous confdata keeps the original one
+    auto *section = updating_confdata_storage_->find_for_update(processing_key_.get_first_key());
+    elements_counters_.on_section_removed(section->first, section->second, predefined_wildcards_);
+    auto &array_for_second_key = section->second.as_array();
+
     // move deleted element data to garbage; it will be a copy with RC detachment
     put_confdata_var_into_garbage(array_for_second_key, ConfdataGarbageDestroyWay::shallow_first);
 
@@ -386,8 +397,10 @@ private:
     array_for_second_key.unset(processing_key_.get_second_key());
     if (array_for_second_key.empty()) {
       // name is moved to garbage, the section itself will be removed due to RC detachment (see above)
-      put_confdata_var_into_garbage(first_key_it->first, ConfdataGarbageDestroyWay::shallow_first);
-      updating_confdata_storage_->erase(first_key_it);
+      put_confdata_var_into_garbage(section->first, ConfdataGarbageDestroyWay::shallow_first);
+      updating_confdata_storage_->erase(processing_key_.get_first_key());
+    } else {
+      elements_counters_.on_section_added(section->first, section->second, predefined_wildcards_);
     }
     return OperationStatus::full_update;
   }
@@ -413,11 +426,15 @@ private:
   template<class BASE, int OPERATION>
   OperationStatus store_processing_element(const lev_confdata_store_wrapper<BASE, OPERATION> &E) noexcept {
     auto first_key_it = updating_confdata_storage_->find(processing_key_.get_first_key());
-    bool element_exists = true;
-    if (first_key_it == updating_confdata_storage_->end()) {
-      element_exists = false;
-      // during the snapshot loading all keys are already sorted, so it makes sense to push it back
-      first_key_it = updating_confdata_storage_->emplace_hint(first_key_it, processing_key_.make_first_key_copy(), mixed{});
+    const bool element_exists = first_key_it != updating_confdata_storage_->end();
+    if (!element_exists) {
+      auto *section = updating_confdata_storage_->try_emplace(processing_key_.make_first_key_copy()).first;
+      // null is inserted by the default
+      if (processing_key_.get_first_key_type() != ConfdataFirstKeyType::simple_key) {
+        section->second = prepare_array_for(vk::string_view{section->first.c_str(), section->first.size()});
+      }
+      elements_counters_.on_section_added(section->first, section->second, predefined_wildcards_);
+      first_key_it = updating_confdata_storage_->find(processing_key_.get_first_key());
     }
 
     // for keys without '.'
@@ -427,36 +444,38 @@ private:
       }
 
       if (is_new_value(E, first_key_it->second)) {
+        // copy the path to the section, the previous confdata keeps the original one
+        auto *section = updating_confdata_storage_->find_for_update(processing_key_.get_first_key());
+        elements_counters_.on_section_removed(section->first, section->second, predefined_wildcards_);
         // put the previous value to garbage and overwrite it with a new value
-        put_confdata_element_value_into_garbage(first_key_it->second);
-        first_key_it->second = get_processing_value(E);
+        put_confdata_element_value_into_garbage(section->second);
+        section->second = get_processing_value(E);
+        elements_counters_.on_section_added(section->first, section->second, predefined_wildcards_);
         return OperationStatus::full_update;
       }
       return OperationStatus::ttl_update_only;
     }
 
-    // null is inserted by the default
-    if (first_key_it->second.is_null()) {
-      first_key_it->second = prepare_array_for(vk::string_view{first_key_it->first.c_str(), first_key_it->first.size()});
-    }
     assert(first_key_it->second.is_array());
-    auto &array_for_second_key = first_key_it->second.as_array();
-    const auto *prev_value = element_exists ? array_for_second_key.find_value(processing_key_.get_second_key()) : nullptr;
+    const auto *prev_value = element_exists ? first_key_it->second.as_array().find_value(processing_key_.get_second_key()) : nullptr;
     if (!can_element_be_saved(E, prev_value != nullptr)) {
       return OperationStatus::no_update;
     }
+    if (prev_value && !is_new_value(E, *prev_value)) {
+      return OperationStatus::ttl_update_only;
+    }
 
+    // copy the path to the section, the previous confdata keeps the original one
+    auto *section = updating_confdata_storage_->find_for_update(processing_key_.get_first_key());
+    elements_counters_.on_section_removed(section->first, section->second, predefined_wildcards_);
+    auto &array_for_second_key = section->second.as_array();
+    // move old element data to garbage; it will be a copy with RC detachment
+    put_confdata_var_into_garbage(array_for_second_key, ConfdataGarbageDestroyWay::shallow_first);
     if (!prev_value) {
-      // move old element data to garbage; it will be a copy with RC detachment
-      put_confdata_var_into_garbage(array_for_second_key, ConfdataGarbageDestroyWay::shallow_first);
       array_for_second_key.set_value(processing_key_.make_second_key_copy(), get_processing_value(E));
       // array insertion will detach the array RC
       assert(array_for_second_key.get_reference_counter() == 1);
-      return OperationStatus::full_update;
-    }
-    if (is_new_value(E, *prev_value)) {
-      // move old element data to garbage; it will be a copy with RC detachment
-      put_confdata_var_into_garbage(array_for_second_key, ConfdataGarbageDestroyWay::shallow_first);
+    } else {
       array_for_second_key.mutate_if_shared();
       auto second_key_it = array_for_second_key.find_no_mutate(processing_key_.get_second_key());
       assert(second_key_it != array_for_second_key.end());
@@ -465,9 +484,9 @@ private:
       // put the previous value to garbage and overwrite it with a new value
       put_confdata_element_value_into_garbage(second_key_it.get_value());
       second_key_it.get_value() = get_processing_value(E);
-      return OperationStatus::full_update;
     }
-    return OperationStatus::ttl_update_only;
+    elements_counters_.on_section_added(section->first, section->second, predefined_wildcards_);
+    return OperationStatus::full_update;
   }
 
   void put_confdata_element_value_into_garbage(const mixed &element) noexcept {
@@ -637,6 +656,7 @@ private:
   bool confdata_has_any_updates_{false};
   std::unordered_map<vk::string_view, array_size> size_hints_;
   ConfdataStats::EventCounters event_counters_;
+  ConfdataStats::ElementsCounters elements_counters_;
 
   ConfdataKeyMaker processing_key_;
   mixed processing_value_;
@@ -732,9 +752,8 @@ void init_confdata_binlog_reader() noexcept {
   auto loaded_confdata = confdata_binlog_replayer.finish_confdata_update();
   assert(loaded_confdata.previous_confdata_garbage.empty());
 
-  confdata_stats.on_update(loaded_confdata.new_confdata,
-                           loaded_confdata.previous_confdata_garbage_size,
-                           confdata_manager.get_predefined_wildcards());
+  confdata_stats.on_update(confdata_binlog_replayer.get_elements_counters(),
+                           loaded_confdata.previous_confdata_garbage_size);
   confdata_stats.initial_loading_time += confdata_stats.last_update_time_point.time_since_epoch();
 
   confdata_manager.get_current().reset(std::move(loaded_confdata.new_confdata));
@@ -765,9 +784,8 @@ void confdata_binlog_update_cron() noexcept {
   if (confdata_binlog_replayer.has_new_confdata()){
     if (confdata_manager.can_next_be_updated()) {
       auto updated_confdata = confdata_binlog_replayer.finish_confdata_update();
-      confdata_stats.on_update(updated_confdata.new_confdata,
-                               updated_confdata.previous_confdata_garbage_size,
-                               confdata_manager.get_predefined_wildcards());
+      confdata_stats.on_update(confdata_binlog_replayer.get_elements_counters(),
+                               updated_confdata.previous_confdata_garbage_size);
       previous_confdata_sample.save_garbage(std::move(updated_confdata.previous_confdata_garbage));
       const bool switched = confdata_manager.try_switch_to_next_sample(std::move(updated_confdata.new_confdata));
       assert(switched);
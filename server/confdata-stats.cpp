@@ -30,55 +30,63 @@ void write_event_stats(stats_t *stats, const char *name, const ConfdataStats::Ev
 
 } // namespace
 
-void ConfdataStats::on_update(const confdata_sample_storage &new_confdata,
-                              size_t previous_garbage_size,
-                              const ConfdataPredefinedWildcards &confdata_predefined_wildcards) noexcept {
-  last_garbage_size = previous_garbage_size;
-  garbage_statistic_[(total_updates++) % garbage_statistic_.size()] = last_garbage_size;
-
-  total_elements = 0;
-  simple_key_elements = 0;
-  one_dot_wildcards = 0;
-  one_dot_wildcard_elements = 0;
-  two_dots_wildcards = 0;
-  two_dots_wildcard_elements = 0;
-  predefined_wildcards = 0;
-  predefined_wildcard_elements = 0;
-  for (const auto &section: new_confdata) {
-    const vk::string_view first_key{section.first.c_str(), section.first.size()};
-    switch (confdata_predefined_wildcards.detect_first_key_type(first_key)) {
-      case ConfdataFirstKeyType::simple_key:
-        ++simple_key_elements;
-        ++total_elements;
-        break;
-      case ConfdataFirstKeyType::one_dot_wildcard: {
-        assert(section.second.is_array());
-        ++one_dot_wildcards;
-        one_dot_wildcard_elements += section.second.as_array().count();
-        if (!confdata_predefined_wildcards.has_wildcard_for_key(first_key)) {
-          total_elements += section.second.as_array().count();
-        }
-        break;
+template<class F>
+void ConfdataStats::ElementsCounters::update_by_section(const string &first_key, const mixed &section,
+                                                        const ConfdataPredefinedWildcards &confdata_predefined_wildcards,
+                                                        const F &update) noexcept {
+  const vk::string_view first_key_view{first_key.c_str(), first_key.size()};
+  switch (confdata_predefined_wildcards.detect_first_key_type(first_key_view)) {
+    case ConfdataFirstKeyType::simple_key:
+      update(simple_key_elements, 1);
+      update(total_elements, 1);
+      break;
+    case ConfdataFirstKeyType::one_dot_wildcard: {
+      assert(section.is_array());
+      update(one_dot_wildcards, 1);
+      update(one_dot_wildcard_elements, section.as_array().count());
+      if (!confdata_predefined_wildcards.has_wildcard_for_key(first_key_view)) {
+        update(total_elements, section.as_array().count());
       }
-      case ConfdataFirstKeyType::two_dots_wildcard:
-        assert(section.second.is_array());
-        ++two_dots_wildcards;
-        two_dots_wildcard_elements += section.second.as_array().count();
-        break;
-      case ConfdataFirstKeyType::predefined_wildcard: {
-        assert(section.second.is_array());
-        ++predefined_wildcards;
-        if (confdata_predefined_wildcards.is_most_common_predefined_wildcard(first_key)) {
-          predefined_wildcard_elements += section.second.as_array().count();
-          if (!vk::contains(first_key, ".")) {
-            total_elements += section.second.as_array().count();  
-          }
+      break;
+    }
+    case ConfdataFirstKeyType::two_dots_wildcard:
+      assert(section.is_array());
+      update(two_dots_wildcards, 1);
+      update(two_dots_wildcard_elements, section.as_array().count());
+      break;
+    case ConfdataFirstKeyType::predefined_wildcard: {
+      assert(section.is_array());
+      update(predefined_wildcards, 1);
+      if (confdata_predefined_wildcards.is_most_common_predefined_wildcard(first_key_view)) {
+        update(predefined_wildcard_elements, section.as_array().count());
+        if (!vk::contains(first_key_view, ".")) {
+          update(total_elements, section.as_array().count());
         }
-        break;
       }
+      break;
     }
   }
+}
 
+void ConfdataStats::ElementsCounters::on_section_added(const string &first_key, const mixed &section,
+                                                       const ConfdataPredefinedWildcards &confdata_predefined_wildcards) noexcept {
+  update_by_section(first_key, section, confdata_predefined_wildcards, [](size_t &counter, int64_t elements) {
+    counter += elements;
+  });
+}
+
+void ConfdataStats::ElementsCounters::on_section_removed(const string &first_key, const mixed &section,
+                                                         const ConfdataPredefinedWildcards &confdata_predefined_wildcards) noexcept {
+  update_by_section(first_key, section, confdata_predefined_wildcards, [](size_t &counter, int64_t elements) {
+    assert(counter >= static_cast<size_t>(elements));
+    counter -= elements;
+  });
+}
+
+void ConfdataStats::on_update(const ElementsCounters &new_elements_counters, size_t previous_garbage_size) noexcept {
+  last_garbage_size = previous_garbage_size;
+  garbage_statistic_[(total_updates++) % garbage_statistic_.size()] = last_garbage_size;
+  elements_counters = new_elements_counters;
   last_update_time_point = std::chrono::steady_clock::now();
 }
 
@@ -93,16 +101,16 @@ void ConfdataStats::write_stats_to(stats_t *stats, const memory_resource::Memory
   add_histogram_stat_long(stats, "confdata.updates.ignored", ignored_updates);
   add_histogram_stat_long(stats, "confdata.updates.total", total_updates);
 
-  add_histogram_stat_long(stats, "confdata.elements.total", total_elements);
-  add_histogram_stat_long(stats, "confdata.elements.simple_key", simple_key_elements);
-  add_histogram_stat_long(stats, "confdata.elements.one_dot_wildcard", one_dot_wildcard_elements);
-  add_histogram_stat_long(stats, "confdata.elements.two_dots_wildcard", two_dots_wildcard_elements);
-  add_histogram_stat_long(stats, "confdata.elements.predefined_wildcard", predefined_wildcard_elements);
+  add_histogram_stat_long(stats, "confdata.elements.total", elements_counters.total_elements);
+  add_histogram_stat_long(stats, "confdata.elements.simple_key", elements_counters.simple_key_elements);
+  add_histogram_stat_long(stats, "confdata.elements.one_dot_wildcard", elements_counters.one_dot_wildcard_elements);
+  add_histogram_stat_long(stats, "confdata.elements.two_dots_wildcard", elements_counters.two_dots_wildcard_elements);
+  add_histogram_stat_long(stats, "confdata.elements.predefined_wildcard", elements_counters.predefined_wildcard_elements);
   add_histogram_stat_long(stats, "confdata.elements.with_delay", elements_with_delay);
 
-  add_histogram_stat_long(stats, "confdata.wildcards.one_dot", one_dot_wildcards);
-  add_histogram_stat_long(stats, "confdata.wildcards.two_dots", two_dots_wildcards);
-  add_histogram_stat_long(stats, "confdata.wildcards.predefined", predefined_wildcards);
+  add_histogram_stat_long(stats, "confdata.wildcards.one_dot", elements_counters.one_dot_wildcards);
+  add_histogram_stat_long(stats, "confdata.wildcards.two_dots", elements_counters.two_dots_wildcards);
+  add_histogram_stat_long(stats, "confdata.wildcards.predefined", elements_counters.predefined_wildcards);
 
   size_t last_100_garbage_max = 0;
   double last_100_garbage_avg = 0;
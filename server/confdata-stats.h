@@ -25,14 +25,28 @@ struct ConfdataStats : private vk::not_copyable {
   size_t last_garbage_size{0};
   std::array<size_t, 100> garbage_statistic_{{0}};
 
-  size_t total_elements{0};
-  size_t simple_key_elements{0};
-  size_t one_dot_wildcards{0};
-  size_t one_dot_wildcard_elements{0};
-  size_t two_dots_wildcards{0};
-  size_t two_dots_wildcard_elements{0};
-  size_t predefined_wildcards{0};
-  size_t predefined_wildcard_elements{0};
+  struct ElementsCounters {
+    size_t total_elements{0};
+    size_t simple_key_elements{0};
+    size_t one_dot_wildcards{0};
+    size_t one_dot_wildcard_elements{0};
+    size_t two_dots_wildcards{0};
+    size_t two_dots_wildcard_elements{0};
+    size_t predefined_wildcards{0};
+    size_t predefined_wildcard_elements{0};
+
+    // the counters are updated section by section, so the update doesn't depend on the confdata size
+    void on_section_added(const string &first_key, const mixed &section,
+                          const ConfdataPredefinedWildcards &confdata_predefined_wildcards) noexcept;
+    void on_section_removed(const string &first_key, const mixed &section,
+                            const ConfdataPredefinedWildcards &confdata_predefined_wildcards) noexcept;
+
+  private:
+    template<class F>
+    void update_by_section(const string &first_key, const mixed &section,
+                           const ConfdataPredefinedWildcards &confdata_predefined_wildcards, const F &update) noexcept;
+  } elements_counters;
+
   size_t elements_with_delay{0};
 
   struct EventCounters {
@@ -64,9 +78,7 @@ struct ConfdataStats : private vk::not_copyable {
     size_t unsupported_total_events{0};
   } event_counters;
 
-  void on_update(const confdata_sample_storage &new_confdata,
-                 size_t previous_garbage_size,
-                 const ConfdataPredefinedWildcards &predefined_wildcards) noexcept;
+  void on_update(const ElementsCounters &new_elements_counters, size_t previous_garbage_size) noexcept;
   void write_stats_to(stats_t *stats, const memory_resource::MemoryStats &memory_stats) noexcept;
 
 private:
@@ -51,6 +51,7 @@
 
 #include "runtime/interface.h"
 #include "runtime/profiler.h"
+#include "runtime/regexp.h"
 #include "server/confdata-binlog-replay.h"
 #include "server/json-logger.h"
 #include "server/lease-config-parser.h"
@@ -284,6 +285,18 @@ command_t *create_command_net_writer(const char *data, int data_len, command_t *
 #define run_once_count 1
 int queries_to_recreate_script = 100;
 
+// the warm-up requests are run before forking the workers, so they share the warmed state copy-on-write
+static const char *warmup_uri = nullptr;
+static int warmup_requests_count = 1;
+static int warmup_requests_left = 0;
+
+static http_query_data *create_warmup_http_query_data() {
+  const char *query = strchr(warmup_uri, '?');
+  const int uri_len = query ? static_cast<int>(query - warmup_uri) : static_cast<int>(strlen(warmup_uri));
+  const char *get = query ? query + 1 : "";
+  return http_query_data_create(warmup_uri, uri_len, get, static_cast<int>(strlen(get)), "", 0, "", 0, "GET", 0, 0, 0);
+}
+
 void *php_script;
 
 php_worker *active_worker = nullptr;
@@ -312,6 +325,9 @@ php_worker *php_worker_create(php_worker_mode_t mode, connection *c, http_query_
 
   worker->req_id = req_id;
 
+  worker->http_streaming = false;
+  worker->http_chunked = false;
+
   if (worker->conn->target) {
     worker->target_fd = static_cast<int>(worker->conn->target - Targets);
   } else {
@@ -655,6 +671,50 @@ void php_worker_http_load_post(php_worker *worker, php_query_http_load_post_t *q
   }
 }
 
+// The first part contains the headers, they are followed by the chunked body for HTTP/1.1 clients.
+// HTTP/1.0 clients don't support chunked encoding, they get the body until the connection is closed.
+static void php_worker_write_http_response_part(php_worker *worker, const char *headers, int headers_len, const char *body, int body_len, bool last) {
+  connection *c = worker->conn;
+  if (!worker->http_streaming) {
+    assert (headers_len >= 2);
+    hts_data *D = HTS_DATA(c);
+    worker->http_streaming = true;
+    worker->http_chunked = D->http_ver >= HTTP_V11;
+    if (worker->http_chunked) {
+      static const char transfer_encoding_header[] = "Transfer-Encoding: chunked\r\n\r\n";
+      write_out(&c->Out, headers, headers_len - 2);
+      write_out(&c->Out, transfer_encoding_header, sizeof(transfer_encoding_header) - 1);
+    } else {
+      write_out(&c->Out, headers, headers_len);
+      D->query_flags &= ~QF_KEEPALIVE;
+    }
+  }
+
+  if (body_len > 0) {
+    if (worker->http_chunked) {
+      char chunk_size[16];
+      write_out(&c->Out, chunk_size, snprintf(chunk_size, sizeof(chunk_size), "%x\r\n", body_len));
+      write_out(&c->Out, body, body_len);
+      write_out(&c->Out, "\r\n", 2);
+    } else {
+      write_out(&c->Out, body, body_len);
+    }
+  }
+  if (last && worker->http_chunked) {
+    write_out(&c->Out, "0\r\n\r\n", 5);
+  }
+}
+
+void php_worker_run_http_chunk_query(php_worker *worker, php_query_http_chunk_t *query) {
+  if (worker->mode == http_worker && worker->conn != nullptr && !worker->conn->error) {
+    vkprintf (2, "going to send %d bytes of http response [req_id = %016llx]\n", query->headers_len + query->body_len, worker->req_id);
+    php_worker_write_http_response_part(worker, query->headers, query->headers_len, query->body, query->body_len, false);
+    flush_connection_output(worker->conn);
+  }
+  php_script_query_readed(php_script);
+  php_script_query_answered(php_script);
+}
+
 void php_worker_answer_query(php_worker *worker, void *ans) {
   assert (worker != nullptr && ans != nullptr);
   auto q_base = (php_query_base_t *)php_script_get_query(php_script);
@@ -756,6 +816,10 @@ void php_worker_run_query(php_worker *worker) {
       query_stats.desc = "HTTP_LOAD_POST";
       php_worker_http_load_post(worker, (php_query_http_load_post_t *)q_base);
       break;
+    case PHPQ_HTTP_CHUNK:
+      query_stats.desc = "HTTP_CHUNK";
+      php_worker_run_http_chunk_query(worker, (php_query_http_chunk_t *)q_base);
+      break;
     default:
       assert ("unknown php_query type" && 0);
   }
@@ -816,6 +880,8 @@ void php_worker_set_result(php_worker *worker, script_result *res) {
     if (worker->mode == http_worker) {
       if (res == nullptr) {
         http_return(worker->conn, "OK", 2);
+      } else if (worker->http_streaming) {
+        php_worker_write_http_response_part(worker, nullptr, 0, res->body, res->body_len, true);
       } else {
         write_out(&worker->conn->Out, res->headers, res->headers_len);
         write_out(&worker->conn->Out, res->body, res->body_len);
@@ -892,7 +958,10 @@ void php_worker_run(php_worker *worker) {
         php_script_finish(php_script);
 
         if (worker->conn != nullptr) {
-          if (worker->mode == http_worker) {
+          if (worker->mode == http_worker && worker->http_streaming) {
+            // the response is incomplete, the client finds it out by the connection close
+            HTS_DATA(worker->conn)->query_flags &= ~QF_KEEPALIVE;
+          } else if (worker->mode == http_worker) {
             http_return(worker->conn, "ERROR", 5);
           } else if (worker->mode == rpc_worker) {
             if (!rpc_stored) {
@@ -941,6 +1010,8 @@ void php_worker_free_script(php_worker *worker) {
     if (!--left) {
       turn_sigterm_on();
     }
+  } else if (worker->mode == warmup_worker) {
+    --warmup_requests_left;
   }
   if (worked + waited > 1.0) {
     vkprintf (1, "ATTENTION php script [query worked = %.5lf] [query waited for start = %.5lf] [req_id = %016llx]\n", worked, waited, worker->req_id);
@@ -1596,11 +1667,14 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
       }
       assert(fetched_bytes == len);
       auto D = TCP_RPC_DATA(c);
-      rpc_query_data *rpc_data = rpc_query_data_create(std::move(header), reinterpret_cast<int *>(buf), len / static_cast<int>(sizeof(int)), D->remote_pid.ip,
-                                                       D->remote_pid.port, D->remote_pid.pid, D->remote_pid.utime);
-
-      php_worker *worker = php_worker_create(run_once ? once_worker : rpc_worker, c, nullptr, rpc_data,
-                                             actual_script_timeout, req_id);
+      php_worker *worker = nullptr;
+      if (warmup_requests_left > 0) {
+        worker = php_worker_create(warmup_worker, c, create_warmup_http_query_data(), nullptr, actual_script_timeout, req_id);
+      } else {
+        rpc_query_data *rpc_data = rpc_query_data_create(std::move(header), reinterpret_cast<int *>(buf), len / static_cast<int>(sizeof(int)), D->remote_pid.ip,
+                                                         D->remote_pid.port, D->remote_pid.pid, D->remote_pid.utime);
+        worker = php_worker_create(run_once ? once_worker : rpc_worker, c, nullptr, rpc_data, actual_script_timeout, req_id);
+      }
       D->extra = worker;
 
       c->status = conn_wait_net;
@@ -1610,15 +1684,12 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
     case TL_RPC_REQ_ERROR:
     case TL_RPC_REQ_RESULT: {
       // received either error or result from an engine
-      int result_len = raw->total_bytes - static_cast<int>(sizeof(int) + sizeof(long long));
-      assert(result_len >= 0);
-
-      tl_fetch_init_raw_message(raw);
-
-      auto op_from_tl = tl_fetch_int();
+      int op_from_tl = 0;
+      long long id = 0;
+      assert (rwm_fetch_data(raw, &op_from_tl, sizeof(int)) == sizeof(int));
       assert(op_from_tl == op);
+      assert (rwm_fetch_data(raw, &id, sizeof(long long)) == sizeof(long long));
 
-      auto id = tl_fetch_long();
       if (op == TL_RPC_REQ_ERROR) {
         //FIXME: error code, error string
         //almost never happens
@@ -1626,13 +1697,8 @@ int rpcx_execute(connection *c, int op, raw_message *raw) {
         break;
       }
 
-      net_event_t *event = nullptr;
-      event_status = create_rpc_answer_event(static_cast<slot_id_t>(id), result_len, &event);
-      if (event_status > 0) {
-        auto fetched_bytes = tl_fetch_data(event->result, result_len);
-        assert (fetched_bytes == result_len);
-      }
-
+      // the answer body is left in the network buffers, the script copies it out only if it still waits for it
+      event_status = create_rpc_answer_event(static_cast<slot_id_t>(id), raw, nullptr);
       break;
     }
     case TL_RPC_PONG:
@@ -1933,6 +1999,7 @@ void prepare_full_stats() {
 
   PhpWorkerStats::get_local().update_idle_time(epoll_total_idle_time(), get_uptime(),
                                                epoll_average_idle_time(), epoll_average_idle_quotient());
+  PhpWorkerStats::get_local().update_regexp_cache_stats(regexp_cache_get_stats());
   PhpWorkerStats::get_local().recalc_worker_percentiles();
   const int stats_size = PhpWorkerStats::get_local().write_into(s, s_left);
   s += stats_size;
@@ -2092,6 +2159,55 @@ void reopen_json_log() {
   }
 }
 
+static void run_warmup_requests() {
+  vkprintf (-1, "run %d warm-up requests of %s\n", warmup_requests_count, warmup_uri);
+  int pipe_fd[2];
+  dl_passert (pipe(pipe_fd) != -1, "failed to create a pipe for warm-up requests");
+  const int read_fd = pipe_fd[0];
+  const int write_fd = pipe_fd[1];
+
+  // the requests are passed as the fake rpc queries through the pipe, like in the run once mode
+  auto *rpc_ready = rpc_client_methods.rpc_ready;
+  rpc_client_methods.rpc_ready = nullptr;
+  epoll_insert_pipe(pipe_for_read, read_fd, &ct_php_rpc_client, &rpc_client_methods);
+
+  warmup_requests_left = warmup_requests_count;
+  int q[6];
+  const int qsize = 6 * sizeof(int);
+  q[2] = TL_RPC_INVOKE_REQ;
+  for (int i = 0; i < warmup_requests_count; i++) {
+    *reinterpret_cast<long long *>(q + 3) = i + 1;
+    prepare_rpc_query_raw(i, q, qsize, crc32c_partial);
+    dl_passert (write(write_fd, q, static_cast<size_t>(qsize)) == qsize, "failed to write a warm-up request");
+  }
+
+  get_utime_monotonic();
+  const double deadline = precise_now + script_timeout * warmup_requests_count + 1;
+  double next_create_outbound = 0;
+  while (warmup_requests_left > 0 && precise_now < deadline) {
+    epoll_work(57);
+    if (precise_now > next_create_outbound) {
+      create_all_outbound_connections();
+      next_create_outbound = precise_now + 0.03 + 0.02 * drand48();
+    }
+  }
+  if (warmup_requests_left > 0) {
+    vkprintf (-1, "%d warm-up requests are not finished in time\n", warmup_requests_left);
+  }
+  warmup_requests_left = 0;
+
+  close_all_connections_and_targets();
+  close(write_fd);
+  rpc_client_methods.rpc_ready = rpc_ready;
+
+  // the script memory would be rewritten by the first request of each worker, so sharing it is useless,
+  // the master only keeps its dirty pages
+  if (active_worker == nullptr) {
+    php_script_free(php_script);
+    php_script = nullptr;
+  }
+}
+
 void start_server() {
   int prev_time;
   double next_create_outbound = 0;
@@ -2115,6 +2231,9 @@ void start_server() {
   init_netbuffers();
 
   init_epoll();
+  if (warmup_uri && !run_once) {
+    run_warmup_requests();
+  }
   if (master_flag) {
     start_master(http_port > 0 ? &http_sfd : nullptr, &try_get_http_fd, http_port);
 
@@ -2272,6 +2391,8 @@ void start_server() {
 }
 
 void set_instance_cache_memory_limit(size_t limit);
+bool set_http_compression_levels(const char *encoding, const char *levels) noexcept;
+void set_http_compression_cache_size_limit(size_t limit) noexcept;
 void init_php_scripts() noexcept;
 void global_init_php_scripts() noexcept;
 const char *get_php_scripts_version() noexcept;
@@ -2589,6 +2710,53 @@ int main_args_handler(int i) {
       kprintf("couldn't set net-dc-mask '%s'\n", optarg);
       return -1;
     }
+    case 2013: {
+      const long long regexp_cache_size = atoll(optarg);
+      if (regexp_cache_size < 0) {
+        kprintf("couldn't parse regexp-cache-size argument\n");
+        return -1;
+      }
+      set_regexp_cache_size_limit(static_cast<size_t>(regexp_cache_size));
+      return 0;
+    }
+    case 2014: {
+      dl::set_script_allocator_slab_mode(true);
+      return 0;
+    }
+    case 2015:
+    case 2016: {
+      const char *encoding = i == 2015 ? "gzip" : "zstd";
+      if (set_http_compression_levels(encoding, optarg)) {
+        return 0;
+      }
+      kprintf("couldn't parse %s compression levels '%s'\n", encoding, optarg);
+      return -1;
+    }
+    case 2017: {
+      const long long cache_size = atoll(optarg);
+      if (cache_size < 0) {
+        kprintf("couldn't parse http-compression-cache-size argument\n");
+        return -1;
+      }
+      set_http_compression_cache_size_limit(static_cast<size_t>(cache_size));
+      return 0;
+    }
+    case 2018: {
+      if (*optarg != '/') {
+        kprintf("--warmup-uri has to start with '/'\n");
+        return -1;
+      }
+      warmup_uri = optarg;
+      return 0;
+    }
+    case 2019: {
+      warmup_requests_count = atoi(optarg);
+      if (warmup_requests_count <= 0) {
+        kprintf("--warmup-requests has to be positive\n");
+        return -1;
+      }
+      return 0;
+    }
 
     default:
       return -1;
@@ -2654,6 +2822,13 @@ void parse_main_args(int argc, char *argv[]) {
   parse_option("profiler-log-prefix", required_argument, 2010, "set profier log path perfix");
   parse_option("mysql-db-name", required_argument, 2011, "database name of MySQL to connect");
   parse_option("net-dc-mask", required_argument, 2012, "a string formatted like '8=1.2.3.4/12' to detect a datacenter by ipv4");
+  parse_option("regexp-cache-size", required_argument, 2013, "max number of compiled regexps kept by each worker between requests, 0 disables the cache (default: 4096)");
+  parse_option("script-memory-slabs", no_argument, 2014, "allocate small pieces of script memory from slabs, it avoids the defragmentation of script memory in long requests");
+  parse_option("http-gzip-levels", required_argument, 2015, "gzip and deflate levels of http responses by the body size, e.g. '6,65536:4,1048576:1' (default: 6)");
+  parse_option("http-zstd-levels", required_argument, 2016, "zstd levels of http responses by the body size, e.g. '3,1048576:1' (default: 3)");
+  parse_option("http-compression-cache-size", required_argument, 2017, "max total size in bytes of the compressed http responses kept by each worker to be reused for the identical bodies, 0 disables the cache (default: 0)");
+  parse_option("warmup-uri", required_argument, 2018, "run the script with this uri (with an optional query string) before starting the server and forking the workers, so the state initialized by it is shared by the workers copy-on-write");
+  parse_option("warmup-requests", required_argument, 2019, "number of the warm-up requests, see --warmup-uri (default: 1)");
   parse_engine_options_long(argc, argv, main_args_handler);
   parse_main_args_till_option(argc, argv);
 }
@@ -921,6 +921,27 @@ void clear_pipe_info(pipe_info_t *info) {
   info->reader = nullptr;
 }
 
+void close_all_connections_and_targets() {
+  for (int i = 0; i < allocated_targets; i++) {
+    while (Targets[i].refcnt > 0) {
+      destroy_target(&Targets[i]);
+    }
+  }
+
+  for (int i = 0; i < MAX_CONNECTIONS; i++) {
+    connection_t *conn = &Connections[i];
+    if (conn->status == conn_none) {
+      continue;
+    }
+    close(i);
+    clear_event(i);
+    force_clear_connection(conn);
+  }
+
+  active_outbound_connections = 0;
+  active_connections = 0;
+}
+
 int run_worker() {
   dl_block_all_signals();
 
@@ -969,24 +990,7 @@ int run_worker() {
 
     master_sfd = -1;
 
-    for (int i = 0; i < allocated_targets; i++) {
-      while (Targets[i].refcnt > 0) {
-        destroy_target(&Targets[i]);
-      }
-    }
-
-    for (int i = 0; i < MAX_CONNECTIONS; i++) {
-      connection_t *conn = &Connections[i];
-      if (conn->status == conn_none) {
-        continue;
-      }
-      close(i);
-      clear_event(i);
-      force_clear_connection(conn);
-    }
-
-    active_outbound_connections = 0;
-    active_connections = 0;
+    close_all_connections_and_targets();
 
     reset_PID();
     //TODO: fill other stats with zero
@@ -7,3 +7,6 @@
 #include "net/net-connections.h"
 
 void start_master(int *http_fd, int (*try_get_http_fd)(), int http_fd_port);
+
+// closes the inherited connections after fork, and the connections opened by the warm-up requests before it
+void close_all_connections_and_targets();
@@ -9,7 +9,9 @@
 #include <cstdio>
 #include <cstring>
 
+#include "common/php-functions.h"
 #include "common/precise-time.h"
+#include "net/net-msg.h"
 
 #include "runtime/allocator.h"
 #include "server/php-engine-vars.h"
@@ -782,24 +784,25 @@ void *dl_allocate_safe(size_t size) {
     return nullptr;
   }
 
-  assert (size <= (1u << 30) - 13);
-  void *dest = dl::allocate(size + 13);
+  assert (size <= (1u << 30) - STRING_RAW_HEADER_SIZE - 1);
+  // dl::allocate raises the memory limit error, but the caller wants to handle the lack of memory itself
+  if (!dl::is_enough_script_memory_for(size + STRING_RAW_HEADER_SIZE + 1)) {
+    return nullptr;
+  }
+  void *dest = dl::allocate(size + STRING_RAW_HEADER_SIZE + 1);
   if (dest == nullptr) {
     return nullptr;
   }
 
-  int *dest_int = static_cast <int *> (dest);
-  dest_int[0] = static_cast<int>(size);
-  dest_int[1] = static_cast<int>(size);
-  dest_int[2] = 0;
-  (static_cast <char *> (dest))[size + 12] = '\0';
+  string_raw_header(static_cast <char *> (dest), static_cast<int>(size), static_cast<int>(size), 0, STRING_HASH_UNKNOWN);
+  (static_cast <char *> (dest))[size + STRING_RAW_HEADER_SIZE] = '\0';
 
-//  fprintf (stderr, "Allocate string of len %d at %p\n", (int)size, (void *)(dest_int + 3));
-//  for (int i = 0; i < (int)size + 13; i++) {
-//    fprintf (stderr, "%d: %x(%d)\n", i - 12, static_cast <char *> (dest)[i], static_cast <char *> (dest)[i]);
+//  fprintf (stderr, "Allocate string of len %d at %p\n", (int)size, static_cast <char *> (dest) + STRING_RAW_HEADER_SIZE);
+//  for (int i = 0; i < (int)size + STRING_RAW_HEADER_SIZE + 1; i++) {
+//    fprintf (stderr, "%d: %x(%d)\n", i - STRING_RAW_HEADER_SIZE, static_cast <char *> (dest)[i], static_cast <char *> (dest)[i]);
 //  }
 
-  return (void *)(dest_int + 3);
+  return static_cast <char *> (dest) + STRING_RAW_HEADER_SIZE;
 }
 
 int alloc_net_event(slot_id_t slot_id, net_event_type_t type, net_event_t **res) {
@@ -835,29 +838,47 @@ int create_rpc_error_event(slot_id_t slot_id, int error_code, const char *error_
   return 1;
 }
 
-int create_rpc_answer_event(slot_id_t slot_id, int len, net_event_t **res) {
-  PhpQueriesStats::get_rpc_queries_stat().register_answer(len);
+int create_rpc_answer_event(slot_id_t slot_id, raw_message *result, net_event_t **res) {
+  PhpQueriesStats::get_rpc_queries_stat().register_answer(result->total_bytes);
   net_event_t *event;
   int status = alloc_net_event(slot_id, ne_rpc_answer, &event);
   if (status <= 0) {
     return status;
   }
-  if (len != 0) {
-    void *buf = dl_allocate_safe(len);
-    if (buf == nullptr) {
-      unalloc_net_event(event);
-      return -1;
-    }
-    event->result = static_cast <char *> (buf);
-  } else {
-    event->result = nullptr;
+  auto *answer = static_cast<raw_message *>(malloc(sizeof(raw_message)));
+  if (answer == nullptr) {
+    unalloc_net_event(event);
+    return -1;
+  }
+  rwm_steal(answer, result);
+  event->result = answer;
+  event->result_len = answer->total_bytes;
+  if (res != nullptr) {
+    *res = event;
   }
-  event->result_len = len;
-  assert (res != nullptr);
-  *res = event;
   return 1;
 }
 
+// the answer is copied out of the network buffers only here, straight into a script string
+char *fetch_rpc_answer_event(net_event_t *event) {
+  assert (event->type == ne_rpc_answer && event->result != nullptr);
+  auto *result = static_cast<char *>(dl_allocate_safe(event->result_len));
+  if (result != nullptr) {
+    assert (rwm_fetch_data(event->result, result, event->result_len) == event->result_len);
+  }
+  free_rpc_answer_event(event);
+  return result;
+}
+
+void free_rpc_answer_event(net_event_t *event) {
+  assert (event->type == ne_rpc_answer);
+  if (event->result != nullptr) {
+    rwm_free(event->result);
+    free(event->result);
+    event->result = nullptr;
+  }
+}
+
 int net_events_empty() {
   return net_events.empty();
 }
@@ -991,6 +1012,18 @@ void http_set_result(const char *headers, int headers_len, const char *body, int
   PHPScriptBase::current_script->set_script_result(&res);
 }
 
+void http_send_chunk(const char *headers, int headers_len, const char *body, int body_len) {
+  assert (PHPScriptBase::is_running);
+  php_query_http_chunk_t q;
+  q.base.type = PHPQ_HTTP_CHUNK;
+  q.headers = headers;
+  q.headers_len = headers_len;
+  q.body = body;
+  q.body_len = body_len;
+
+  PHPScriptBase::current_script->ask_query((void *)&q);
+}
+
 void rpc_set_result(const char *body, int body_len, int exit_code) {
   script_result res;
   res.exit_code = exit_code;
@@ -1054,6 +1087,11 @@ void php_queries_start() {
 void php_queries_finish() {
   qmem_clear();
   clear_slots();
+  while (net_event_t *event = net_events.pop()) {
+    if (event->type == ne_rpc_answer) {
+      free_rpc_answer_event(event);
+    }
+  }
   net_events.clear();
   net_queries.clear();
 }
@@ -6,6 +6,8 @@
 
 #include <cstddef>
 
+struct raw_message;
+
 using slot_id_t = int;
 
 enum net_event_type_t {
@@ -22,8 +24,8 @@ struct net_event_t {
   union {
     struct { //ne_rpc_answer
       int result_len;
-      //allocated via dl_malloc
-      char *result;
+      //stays in network buffers until the script takes it, allocated via malloc
+      raw_message *result;
     };
     struct { //ne_rpc_error
       int error_code;
@@ -85,6 +87,7 @@ struct chain_t {
 #define PHPQ_NETQ 0x3d780000
 #define PHPQ_WAIT 0x728a0000
 #define PHPQ_HTTP_LOAD_POST 0x5ac20000
+#define PHPQ_HTTP_CHUNK 0x6b310000
 #define NETQ_PACKET 1234
 
 #define PNETF_IMMEDIATE 16
@@ -150,6 +153,16 @@ struct php_query_http_load_post_t {
   int max_len;
 };
 
+/** send a part of http response query **/
+struct php_query_http_chunk_t {
+  php_query_base_t base;
+
+  const char *headers;
+  int headers_len;
+  const char *body;
+  int body_len;
+};
+
 
 /** net query **/
 struct data_reader_t {
@@ -330,7 +343,9 @@ net_query_t *pop_net_query();
 void free_net_query(net_query_t *query);
 
 int create_rpc_error_event(slot_id_t slot_id, int error_code, const char *error_message, net_event_t **res);
-int create_rpc_answer_event(slot_id_t slot_id, int len, net_event_t **res);
+int create_rpc_answer_event(slot_id_t slot_id, raw_message *result, net_event_t **res);
+char *fetch_rpc_answer_event(net_event_t *event);
+void free_rpc_answer_event(net_event_t *event);
 int net_events_empty();
 
 void php_queries_start();
@@ -351,6 +366,7 @@ int get_engine_uptime();
 const char *get_engine_version();
 int http_load_long_query(char *buf, int min_len, int max_len);
 void http_set_result(const char *headers, int headers_len, const char *body, int body_len, int exit_code);
+void http_send_chunk(const char *headers, int headers_len, const char *body, int body_len);
 void rpc_answer(const char *res, int res_len);
 void rpc_set_result(const char *body, int body_len, int exit_code);
 void script_error();
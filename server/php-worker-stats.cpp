@@ -8,6 +8,8 @@
 #include <cassert>
 #include <cstring>
 
+#include "runtime/regexp.h"
+
 namespace {
 const char *concat_stat(std::array<char, 256> &buffer, const char *prefix, const char *suffix) {
   int len = snprintf(buffer.data(), buffer.size() - 1, "%s%s", prefix, suffix);
@@ -84,6 +86,14 @@ void PhpWorkerStats::update_idle_time(double tot_idle_time, int uptime, double a
   internal_.a_idle_percent_ = average_idle_quotient > 0 ? average_idle_time / average_idle_quotient * 100 : 0;
 }
 
+void PhpWorkerStats::update_regexp_cache_stats(const RegexpCacheStats &regexp_cache_stats) noexcept {
+  internal_.regexp_cache_hits_ = regexp_cache_stats.hits;
+  internal_.regexp_cache_misses_ = regexp_cache_stats.misses;
+  internal_.regexp_cache_evictions_ = regexp_cache_stats.evictions;
+  internal_.regexp_cache_uncached_ = regexp_cache_stats.uncached;
+  internal_.regexp_cache_size_ = regexp_cache_stats.size;
+}
+
 void PhpWorkerStats::recalc_worker_percentiles() noexcept {
   const auto now_tp = std::chrono::steady_clock::now();
   internal_.working_time_percentiles_ = calc_timed_50_95_99_percentiles(working_time_samples_, samples_tp_, now_tp);
@@ -117,6 +127,11 @@ void PhpWorkerStats::add_from(const PhpWorkerStats &from) noexcept {
   internal_.a_idle_percent_ += from.internal_.a_idle_percent_;
   internal_.script_max_memory_used_ = std::max(internal_.script_max_memory_used_, from.internal_.script_max_memory_used_);
   internal_.script_max_real_memory_used_ = std::max(internal_.script_max_real_memory_used_, from.internal_.script_max_real_memory_used_);
+  internal_.regexp_cache_hits_ += from.internal_.regexp_cache_hits_;
+  internal_.regexp_cache_misses_ += from.internal_.regexp_cache_misses_;
+  internal_.regexp_cache_evictions_ += from.internal_.regexp_cache_evictions_;
+  internal_.regexp_cache_uncached_ += from.internal_.regexp_cache_uncached_;
+  internal_.regexp_cache_size_ += from.internal_.regexp_cache_size_;
 
   internal_.accumulated_stats_++;
   for (size_t i = 0; i < internal_.errors_.size(); ++i) {
@@ -160,6 +175,16 @@ std::string PhpWorkerStats::to_string(const std::string &pid_s) const noexcept {
   res += buf;
   sprintf(buf, "recent_idle_percent%s\t%.3lf%%\n", pid_s.c_str(), internal_.a_idle_percent_ / cnt);
   res += buf;
+  sprintf(buf, "regexp_cache_hits%s\t%ld\n", pid_s.c_str(), internal_.regexp_cache_hits_);
+  res += buf;
+  sprintf(buf, "regexp_cache_misses%s\t%ld\n", pid_s.c_str(), internal_.regexp_cache_misses_);
+  res += buf;
+  sprintf(buf, "regexp_cache_evictions%s\t%ld\n", pid_s.c_str(), internal_.regexp_cache_evictions_);
+  res += buf;
+  sprintf(buf, "regexp_cache_uncached%s\t%ld\n", pid_s.c_str(), internal_.regexp_cache_uncached_);
+  res += buf;
+  sprintf(buf, "regexp_cache_size%s\t%ld\n", pid_s.c_str(), internal_.regexp_cache_size_);
+  res += buf;
 
   return res;
 }
@@ -188,6 +213,12 @@ void PhpWorkerStats::to_stats(stats_t *stats) const noexcept {
   write_percentile(stats, "memory.script_usage", internal_.script_memory_used_percentiles_);
   add_histogram_stat_long(stats, "memory.script_real_usage.max", internal_.script_max_real_memory_used_);
   write_percentile(stats, "memory.script_real_usage", internal_.script_real_memory_used_percentiles_);
+
+  add_histogram_stat_long(stats, "regexp_cache.hits", internal_.regexp_cache_hits_);
+  add_histogram_stat_long(stats, "regexp_cache.misses", internal_.regexp_cache_misses_);
+  add_histogram_stat_long(stats, "regexp_cache.evictions", internal_.regexp_cache_evictions_);
+  add_histogram_stat_long(stats, "regexp_cache.uncached", internal_.regexp_cache_uncached_);
+  add_histogram_stat_long(stats, "regexp_cache.size", internal_.regexp_cache_size_);
 }
 
 int PhpWorkerStats::write_into(char *buffer, int buffer_len) const noexcept {
@@ -12,12 +12,15 @@
 
 #include "server/php-runner.h"
 
+struct RegexpCacheStats;
+
 class PhpWorkerStats {
 public:
   void add_stats(double script_time, double net_time, long script_queries,
                  long max_memory_used, long max_real_memory_used, script_error_t error) noexcept;
 
   void update_idle_time(double tot_idle_time, int uptime, double average_idle_time, double average_idle_quotient) noexcept;
+  void update_regexp_cache_stats(const RegexpCacheStats &regexp_cache_stats) noexcept;
   void recalc_worker_percentiles() noexcept;
   void recalc_master_percentiles() noexcept;
 
@@ -73,6 +76,12 @@ private:
     int64_t script_max_memory_used_{0};
     int64_t script_max_real_memory_used_{0};
 
+    int64_t regexp_cache_hits_{0};
+    int64_t regexp_cache_misses_{0};
+    int64_t regexp_cache_evictions_{0};
+    int64_t regexp_cache_uncached_{0};
+    int64_t regexp_cache_size_{0};
+
     uint32_t accumulated_stats_{0};
     std::array<uint32_t, static_cast<size_t>(script_error_t::errors_count)> errors_{{0}};
 
@@ -10,7 +10,8 @@
 enum php_worker_mode_t {
   http_worker,
   rpc_worker,
-  once_worker
+  once_worker,
+  warmup_worker
 };
 
 enum php_worker_state_t {
@@ -45,5 +46,10 @@ struct php_worker {
 
   long long req_id;
   int target_fd;
+
+  // the http response headers are sent and the body is being sent by parts
+  bool http_streaming;
+  // the body parts are sent with chunked transfer encoding, otherwise the end of the body is the connection close
+  bool http_chunked;
 };
 
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "common/tl/constants/common.h"
+
+#include "compiler/code-gen/files/tl2cpp/tl-combinator.h"
+
+namespace {
+
+class tl_combinator_test : public testing::Test {
+protected:
+  void SetUp() final {
+    add_type(TL_INT, "Int", "int");
+    add_type(TL_LONG, "Long", "long");
+    add_type(TL_DOUBLE, "Double", "double");
+    add_type(TL_STRING, "String", "string");
+    add_type(vk::tl::TL_SHARP_ID, "#", "#");
+    tl2cpp::tl = &scheme_;
+
+    combinator_.kind = vk::tl::combinator::combinator_type::CONSTRUCTOR;
+    combinator_.name = "test.stats";
+  }
+
+  void TearDown() final {
+    tl2cpp::tl = nullptr;
+  }
+
+  // bare types are written in lowercase in tl schemes: 'count:int', the boxed ones are not: 'count:Int'
+  void add_arg(const std::string &name, unsigned int type_id, int arg_flags = 0, int type_expr_flags = vk::tl::FLAG_BARE) {
+    auto type_expr = std::make_unique<vk::tl::type_expr>(static_cast<int>(type_id));
+    type_expr->flags = type_expr_flags;
+    auto arg = std::make_unique<vk::tl::arg>();
+    arg->flags = arg_flags;
+    arg->idx = static_cast<int>(combinator_.args.size());
+    arg->var_num = -1;
+    arg->type_expr = std::move(type_expr);
+    arg->name = name;
+    combinator_.args.emplace_back(std::move(arg));
+  }
+
+  void expect_block(const std::string &name, bool is_first, bool is_last, int x4_bytes_length) const {
+    const auto block = tl2cpp::get_fixed_fetch_block(&combinator_, find_arg(name));
+    EXPECT_EQ(block.is_first, is_first) << name;
+    EXPECT_EQ(block.is_last, is_last) << name;
+    EXPECT_EQ(block.x4_bytes_length, x4_bytes_length) << name;
+  }
+
+  void expect_no_block(const std::string &name) const {
+    expect_block(name, false, false, 0);
+  }
+
+private:
+  void add_type(unsigned int id, const std::string &name, const std::string &constructor_name) {
+    auto constructor = std::make_unique<vk::tl::combinator>();
+    constructor->kind = vk::tl::combinator::combinator_type::CONSTRUCTOR;
+    constructor->type_id = static_cast<int>(id);
+    constructor->name = constructor_name;
+
+    auto type = std::make_unique<vk::tl::type>();
+    type->id = static_cast<int>(id);
+    type->name = name;
+    type->constructors_num = 1;
+    type->constructors.emplace_back(std::move(constructor));
+    scheme_.types[type->id] = std::move(type);
+  }
+
+  const vk::tl::arg *find_arg(const std::string &name) const {
+    for (const auto &arg : combinator_.args) {
+      if (arg->name == name) {
+        return arg.get();
+      }
+    }
+    ADD_FAILURE() << "unknown arg " << name;
+    return nullptr;
+  }
+
+  vk::tl::tl_scheme scheme_;
+  vk::tl::combinator combinator_;
+};
+
+} // namespace
+
+// test.stats {n:#} count:int total:long avg:double fields_mask:# name:string min:int max:int
+//            extra:fields_mask.0?long last:long boxed:Int tail_int:int tail_double:double = test.Stats;
+TEST_F(tl_combinator_test, test_fixed_fetch_blocks) {
+  add_arg("n", vk::tl::TL_SHARP_ID, vk::tl::FLAG_OPT_VAR);
+  add_arg("count", TL_INT);
+  add_arg("total", TL_LONG);
+  add_arg("avg", TL_DOUBLE);
+  add_arg("fields_mask", vk::tl::TL_SHARP_ID);
+  add_arg("name", TL_STRING);
+  add_arg("min", TL_INT);
+  add_arg("max", TL_INT);
+  add_arg("extra", TL_LONG, vk::tl::FLAG_OPT_FIELD);
+  add_arg("last", TL_LONG);
+  add_arg("boxed", TL_INT, 0, 0);
+  add_arg("tail_int", TL_INT);
+  add_arg("tail_double", TL_DOUBLE);
+
+  // the mixed block: 1 + 2 + 2 + 1 ints
+  expect_block("count", true, false, 6);
+  expect_block("total", false, false, 6);
+  expect_block("avg", false, false, 6);
+  expect_block("fields_mask", false, true, 6);
+
+  expect_no_block("n");
+  expect_no_block("name");
+
+  expect_block("min", true, false, 2);
+  expect_block("max", false, true, 2);
+
+  // the optional field breaks the block, a single arg is fetched as before, and so is the boxed one
+  expect_no_block("extra");
+  expect_no_block("last");
+  expect_no_block("boxed");
+
+  // the block is closed by the end of args
+  expect_block("tail_int", true, false, 3);
+  expect_block("tail_double", false, true, 3);
+}
+
+TEST_F(tl_combinator_test, test_implicit_args_dont_break_blocks) {
+  add_arg("count", TL_INT);
+  add_arg("n", vk::tl::TL_SHARP_ID, vk::tl::FLAG_OPT_VAR);
+  add_arg("total", TL_LONG);
+
+  expect_block("count", true, false, 3);
+  expect_no_block("n");
+  expect_block("total", false, true, 3);
+}
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+
+#include "runtime/interface.h"
+#include "server/php-engine-vars.h"
+
+// The benchmarks run in the script memory of a single request, like the php scripts do
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  pid = 0;
+  logname_id = 0;
+  workers_n = 1;
+
+  global_init_runtime_libs();
+  global_init_script_allocator();
+
+  constexpr size_t script_memory_size = 512 * 1024 * 1024;
+  auto script_memory = std::make_unique<uint8_t[]>(script_memory_size);
+  init_runtime_environment(nullptr, script_memory.get(), script_memory_size);
+
+  php_disable_warnings = true;
+  php_warning_level = 0;
+
+  benchmark::RunSpecifiedBenchmarks();
+
+  free_runtime_environment();
+  return 0;
+}
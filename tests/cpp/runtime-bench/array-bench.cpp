@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/array_functions.h"
+#include "runtime/kphp_core.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_array_vector_push_back(benchmark::State &state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    array<int64_t> arr;
+    for (int64_t i = 0; i < count; ++i) {
+      arr.push_back(i);
+    }
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_array_vector_push_back)->Range(8, 1 << 16);
+
+static void BM_array_vector_iterate(benchmark::State &state) {
+  array<int64_t> arr;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    arr.push_back(i);
+  }
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto &it : arr) {
+      sum += it.get_value();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * arr.count());
+}
+BENCHMARK(BM_array_vector_iterate)->Range(8, 1 << 16);
+
+static void BM_array_map_int_keys_set(benchmark::State &state) {
+  const int64_t count = state.range(0);
+  for (auto _ : state) {
+    array<int64_t> arr;
+    for (int64_t i = 0; i < count; ++i) {
+      arr.set_value(i * 7919, i);
+    }
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_array_map_int_keys_set)->Range(8, 1 << 16);
+
+static void BM_array_map_string_keys_set(benchmark::State &state) {
+  array<string> keys;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    keys.push_back(bench_data::random_word(4, 16));
+  }
+  for (auto _ : state) {
+    array<int64_t> arr;
+    for (const auto &key : keys) {
+      arr.set_value(key.get_value(), 1);
+    }
+    benchmark::DoNotOptimize(arr);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.count());
+}
+BENCHMARK(BM_array_map_string_keys_set)->Range(8, 1 << 16);
+
+static void BM_array_map_string_keys_get(benchmark::State &state) {
+  array<string> keys;
+  array<int64_t> arr;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    keys.push_back(bench_data::random_word(4, 16));
+    arr.set_value(keys[i], i);
+  }
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (const auto &key : keys) {
+      sum += arr.get_value(key.get_value());
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.count());
+}
+BENCHMARK(BM_array_map_string_keys_get)->Range(8, 1 << 16);
+
+static void BM_array_copy_on_write(benchmark::State &state) {
+  array<int64_t> arr;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    arr.push_back(i);
+  }
+  for (auto _ : state) {
+    array<int64_t> copy = arr;
+    copy.set_value(0, -1);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetBytesProcessed(state.iterations() * arr.count() * sizeof(int64_t));
+}
+BENCHMARK(BM_array_copy_on_write)->Range(8, 1 << 16);
+
+static void BM_array_sort(benchmark::State &state) {
+  array<int64_t> arr;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    arr.push_back(bench_data::random_int(0, 1000000000));
+  }
+  for (auto _ : state) {
+    array<int64_t> copy = arr;
+    f$sort(copy);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * arr.count());
+}
+BENCHMARK(BM_array_sort)->Range(8, 1 << 16);
+
+static void BM_array_merge(benchmark::State &state) {
+  const array<mixed> first = bench_data::random_user_records(state.range(0));
+  const array<mixed> second = bench_data::random_user_records(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$array_merge(first, second));
+  }
+  state.SetItemsProcessed(state.iterations() * (first.count() + second.count()));
+}
+BENCHMARK(BM_array_merge)->Range(8, 1 << 12);
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <random>
+
+#include "runtime/kphp_core.h"
+
+// The data sets are generated with fixed seeds, so every run of the benchmarks measures the same work
+
+namespace bench_data {
+
+inline std::mt19937 &generator() {
+  static std::mt19937 gen{2020};
+  return gen;
+}
+
+inline int64_t random_int(int64_t min, int64_t max) {
+  return std::uniform_int_distribution<int64_t>{min, max}(generator());
+}
+
+inline string random_word(int64_t min_len = 3, int64_t max_len = 10) {
+  string word(static_cast<string::size_type>(random_int(min_len, max_len)), false);
+  for (string::size_type i = 0; i < word.size(); ++i) {
+    word[i] = static_cast<char>('a' + random_int(0, 25));
+  }
+  return word;
+}
+
+// A text of words separated by spaces with some punctuation and capital letters
+inline string random_text(int64_t size) {
+  string text;
+  text.reserve_at_least(static_cast<string::size_type>(size + 16));
+  while (text.size() < size) {
+    string word = random_word();
+    if (random_int(0, 9) == 0) {
+      word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    }
+    text.append(word);
+    text.push_back(random_int(0, 15) == 0 ? '.' : ' ');
+  }
+  return text;
+}
+
+// Records like the ones fetched from a storage and sent to a client
+inline array<mixed> random_user_record(int64_t id) {
+  array<mixed> record;
+  record.set_value(string{"id"}, id);
+  record.set_value(string{"first_name"}, random_word(3, 8));
+  record.set_value(string{"last_name"}, random_word(5, 12));
+  record.set_value(string{"email"}, string{random_word(5, 10)}.append(string{"@example.com"}));
+  record.set_value(string{"is_active"}, random_int(0, 1) == 1);
+  record.set_value(string{"rating"}, static_cast<double>(random_int(0, 100000)) / 100.0);
+  array<mixed> tags;
+  for (int64_t i = random_int(0, 5); i > 0; --i) {
+    tags.push_back(random_word(4, 8));
+  }
+  record.set_value(string{"tags"}, tags);
+  record.set_value(string{"about"}, random_text(random_int(0, 200)));
+  return record;
+}
+
+inline array<mixed> random_user_records(int64_t count) {
+  array<mixed> records(array_size(count, 0, true));
+  for (int64_t i = 0; i < count; ++i) {
+    records.push_back(random_user_record(1000000 + i));
+  }
+  return records;
+}
+
+} // namespace bench_data
@@ -0,0 +1,77 @@
+#!/usr/bin/python3
+import argparse
+import json
+import statistics
+import sys
+from collections import defaultdict
+
+
+def load_times(path, metric):
+    with open(path) as f:
+        report = json.load(f)
+
+    medians = {}
+    runs = defaultdict(list)
+    for benchmark in report["benchmarks"]:
+        if benchmark.get("error_occurred"):
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        if benchmark.get("run_type") == "aggregate":
+            if benchmark.get("aggregate_name") == "median":
+                medians[name] = benchmark[metric]
+        else:
+            runs[name].append(benchmark[metric])
+
+    # the median of the repetitions is more stable than a single run, it is used if it's reported
+    times = {name: statistics.median(values) for name, values in runs.items()}
+    times.update(medians)
+    return times
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Compares two json reports of kphp-runtime-bench, "
+                    "which are made with --benchmark_format=json or --benchmark_out=<file>. "
+                    "Exits with 1 if any benchmark is slower than the threshold.")
+    parser.add_argument("baseline", help="report of the base commit")
+    parser.add_argument("contender", help="report of the tested commit")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="the slowdown in percent, which is considered a regression (default: 5)")
+    parser.add_argument("--metric", choices=["cpu_time", "real_time"], default="cpu_time",
+                        help="the compared time (default: cpu_time)")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    baseline = load_times(args.baseline, args.metric)
+    contender = load_times(args.contender, args.metric)
+
+    regressions = []
+    name_width = max((len(name) for name in baseline), default=10)
+    print("{:<{w}} {:>14} {:>14} {:>9}".format("benchmark", "baseline", "contender", "change", w=name_width))
+    for name, base_time in baseline.items():
+        if name not in contender:
+            print("{:<{w}} {:>14.1f} {:>14} {:>9}".format(name, base_time, "-", "missing", w=name_width))
+            continue
+        new_time = contender[name]
+        change = (new_time - base_time) / base_time * 100.0 if base_time else 0.0
+        mark = ""
+        if change > args.threshold:
+            regressions.append(name)
+            mark = " REGRESSION"
+        elif change < -args.threshold:
+            mark = " improvement"
+        print("{:<{w}} {:>14.1f} {:>14.1f} {:>+8.1f}%{}".format(name, base_time, new_time, change, mark, w=name_width))
+
+    for name in contender:
+        if name not in baseline:
+            print("{:<{w}} {:>14} {:>14.1f} {:>9}".format(name, "-", contender[name], "new", w=name_width))
+
+    if regressions:
+        print("\n{} benchmark(s) are slower by more than {}%".format(len(regressions), args.threshold))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
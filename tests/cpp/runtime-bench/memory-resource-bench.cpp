@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include "runtime/memory_resource/monotonic_buffer_resource.h"
+#include "runtime/memory_resource/unsynchronized_pool_resource.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+namespace {
+
+constexpr size_t RESOURCE_MEMORY_SIZE = 64 * 1024 * 1024;
+
+// The sizes of the pieces are mostly small, like the sizes of strings and arrays in php scripts
+std::vector<size_t> random_piece_sizes(size_t count) {
+  std::vector<size_t> sizes(count);
+  for (auto &size : sizes) {
+    size = bench_data::random_int(0, 9) ? static_cast<size_t>(bench_data::random_int(8, 256))
+                                        : static_cast<size_t>(bench_data::random_int(257, 16 * 1024));
+  }
+  return sizes;
+}
+
+} // namespace
+
+static void BM_monotonic_buffer_resource_allocate(benchmark::State &state) {
+  auto memory = std::make_unique<char[]>(RESOURCE_MEMORY_SIZE);
+  const std::vector<size_t> sizes = random_piece_sizes(static_cast<size_t>(state.range(0)));
+  memory_resource::monotonic_buffer_resource resource;
+  for (auto _ : state) {
+    resource.init(memory.get(), RESOURCE_MEMORY_SIZE);
+    for (size_t size : sizes) {
+      benchmark::DoNotOptimize(resource.allocate(size));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * sizes.size());
+}
+BENCHMARK(BM_monotonic_buffer_resource_allocate)->Range(64, 1 << 12);
+
+// Allocates all the pieces and deallocates them in the random order, so the free lists are used on the next iteration
+static void BM_unsynchronized_pool_resource_churn(benchmark::State &state) {
+  auto memory = std::make_unique<char[]>(RESOURCE_MEMORY_SIZE);
+  const std::vector<size_t> sizes = random_piece_sizes(static_cast<size_t>(state.range(0)));
+  std::vector<size_t> order(sizes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), bench_data::generator());
+  std::vector<void *> pieces(sizes.size());
+
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(memory.get(), RESOURCE_MEMORY_SIZE, state.range(1) != 0);
+  for (auto _ : state) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      pieces[i] = resource.allocate(sizes[i]);
+    }
+    for (size_t i : order) {
+      resource.deallocate(pieces[i], sizes[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * sizes.size() * 2);
+}
+BENCHMARK(BM_unsynchronized_pool_resource_churn)->ArgNames({"pieces", "slabs"})->Ranges({{64, 1 << 12}, {0, 1}});
+
+static void BM_unsynchronized_pool_resource_reallocate(benchmark::State &state) {
+  auto memory = std::make_unique<char[]>(RESOURCE_MEMORY_SIZE);
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(memory.get(), RESOURCE_MEMORY_SIZE);
+  for (auto _ : state) {
+    size_t size = 16;
+    void *mem = resource.allocate(size);
+    // grows like a string, which is appended to
+    while (size < static_cast<size_t>(state.range(0))) {
+      mem = resource.reallocate(mem, size * 2, size);
+      size *= 2;
+    }
+    resource.deallocate(mem, size);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_unsynchronized_pool_resource_reallocate)->Range(1 << 10, 1 << 20);
@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/kphp_core.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_mixed_arithmetic(benchmark::State &state) {
+  const mixed int_value{static_cast<int64_t>(7919)};
+  const mixed double_value{3.5};
+  const mixed string_value{string{"42"}};
+  for (auto _ : state) {
+    mixed result = int_value + double_value;
+    result = result * string_value;
+    result = result - int_value;
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_mixed_arithmetic);
+
+static void BM_mixed_compare(benchmark::State &state) {
+  const mixed values[] = {mixed{static_cast<int64_t>(1)}, mixed{string{"1.0"}}, mixed{1.0}, mixed{true}, mixed{string{"abc"}}, mixed{}};
+  for (auto _ : state) {
+    int64_t equal = 0;
+    for (const auto &lhs : values) {
+      for (const auto &rhs : values) {
+        equal += equals(lhs, rhs);
+        equal += eq2(lhs, rhs);
+      }
+    }
+    benchmark::DoNotOptimize(equal);
+  }
+  state.SetItemsProcessed(state.iterations() * 72);
+}
+BENCHMARK(BM_mixed_compare);
+
+static void BM_mixed_array_access(benchmark::State &state) {
+  const array<mixed> records = bench_data::random_user_records(state.range(0));
+  const mixed records_mixed{records};
+  const mixed id_key{string{"id"}};
+  const mixed rating_key{string{"rating"}};
+  for (auto _ : state) {
+    double sum = 0;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      const mixed &record = records_mixed.get_value(i);
+      sum += record.get_value(id_key).to_float() + record.get_value(rating_key).to_float();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * records.count());
+}
+BENCHMARK(BM_mixed_array_access)->Range(8, 1 << 12);
+
+static void BM_mixed_to_string(benchmark::State &state) {
+  const mixed values[] = {mixed{static_cast<int64_t>(1234567)}, mixed{3.14159}, mixed{true}, mixed{string{"text"}}};
+  for (auto _ : state) {
+    for (const auto &value : values) {
+      benchmark::DoNotOptimize(value.to_string());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_mixed_to_string);
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/kphp_core.h"
+#include "runtime/regexp.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_preg_match_compiled(benchmark::State &state) {
+  const regexp email{string{"/[a-z0-9._]+@[a-z0-9.]+\\.[a-z]{2,}/"}};
+  const string text = bench_data::random_text(state.range(0)).append(string{" john.doe@example.com"});
+  for (auto _ : state) {
+    mixed matches;
+    benchmark::DoNotOptimize(f$preg_match(email, text, matches));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_preg_match_compiled)->Range(64, 1 << 14);
+
+// The pattern is compiled on every call, or taken from the regexp cache
+static void BM_preg_match_dynamic_pattern(benchmark::State &state) {
+  const string pattern{"/^[A-Z][a-z]+$/"};
+  const string word{"Hello"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$preg_match(pattern, word));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_preg_match_dynamic_pattern);
+
+static void BM_preg_match_all_words(benchmark::State &state) {
+  const regexp capitalized{string{"/\\b[A-Z][a-z]+\\b/"}};
+  const string text = bench_data::random_text(state.range(0));
+  for (auto _ : state) {
+    mixed matches;
+    benchmark::DoNotOptimize(f$preg_match_all(capitalized, text, matches));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_preg_match_all_words)->Range(64, 1 << 14);
+
+static void BM_preg_replace(benchmark::State &state) {
+  const regexp spaces{string{"/\\s+/"}};
+  const string text = bench_data::random_text(state.range(0));
+  const string replacement{"_"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$preg_replace(spaces, replacement, text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_preg_replace)->Range(64, 1 << 14);
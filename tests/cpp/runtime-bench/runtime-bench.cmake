@@ -0,0 +1,14 @@
+prepend(RUNTIME_BENCH_SOURCES ${BASE_DIR}/tests/cpp/runtime-bench/
+        _runtime-bench-env.cpp
+        array-bench.cpp
+        memory-resource-bench.cpp
+        mixed-bench.cpp
+        regexp-bench.cpp
+        serialization-bench.cpp
+        string-bench.cpp
+        string-buffer-bench.cpp)
+
+add_executable(kphp-runtime-bench ${RUNTIME_BENCH_SOURCES} ${BASE_DIR}/tests/cpp/runtime/_runtime-linkage-stubs.cpp)
+target_link_libraries(kphp-runtime-bench PRIVATE benchmark::benchmark ${RUNTIME_LIBS} ${RUNTIME_LINK_TEST_LIBS} vk::popular_common)
+target_link_options(kphp-runtime-bench PRIVATE ${NO_PIE})
+set_target_properties(kphp-runtime-bench PROPERTIES FOLDER tests)
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/kphp_core.h"
+#include "runtime/misc.h"
+#include "runtime/msgpack-serialization.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_json_encode(benchmark::State &state) {
+  const mixed records{bench_data::random_user_records(state.range(0))};
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const Optional<string> json = f$json_encode(records);
+    bytes += json.val().size();
+    benchmark::DoNotOptimize(json);
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_json_encode)->Range(1, 1 << 10);
+
+static void BM_json_decode(benchmark::State &state) {
+  const string json = f$json_encode(mixed{bench_data::random_user_records(state.range(0))}).val();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$json_decode(json, true));
+  }
+  state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_json_decode)->Range(1, 1 << 10);
+
+static void BM_serialize(benchmark::State &state) {
+  const mixed records{bench_data::random_user_records(state.range(0))};
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const string serialized = f$serialize(records);
+    bytes += serialized.size();
+    benchmark::DoNotOptimize(serialized);
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_serialize)->Range(1, 1 << 10);
+
+static void BM_unserialize(benchmark::State &state) {
+  const string serialized = f$serialize(mixed{bench_data::random_user_records(state.range(0))});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$unserialize(serialized));
+  }
+  state.SetBytesProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_unserialize)->Range(1, 1 << 10);
+
+static void BM_msgpack_serialize(benchmark::State &state) {
+  const mixed records{bench_data::random_user_records(state.range(0))};
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    const Optional<string> packed = f$msgpack_serialize(records);
+    bytes += packed.val().size();
+    benchmark::DoNotOptimize(packed);
+  }
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_msgpack_serialize)->Range(1, 1 << 10);
+
+static void BM_msgpack_deserialize(benchmark::State &state) {
+  const string packed = f$msgpack_serialize(mixed{bench_data::random_user_records(state.range(0))}).val();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$msgpack_deserialize<mixed>(packed));
+  }
+  state.SetBytesProcessed(state.iterations() * packed.size());
+}
+BENCHMARK(BM_msgpack_deserialize)->Range(1, 1 << 10);
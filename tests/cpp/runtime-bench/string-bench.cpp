@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/array_functions.h"
+#include "runtime/kphp_core.h"
+#include "runtime/string_functions.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_string_concat(benchmark::State &state) {
+  const string word = bench_data::random_word(8, 8);
+  for (auto _ : state) {
+    string result;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      result.append(word);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * word.size());
+}
+BENCHMARK(BM_string_concat)->Range(8, 1 << 14);
+
+static void BM_string_from_int(benchmark::State &state) {
+  int64_t value = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(string{value});
+    value += 7919;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_string_from_int);
+
+static void BM_string_to_int(benchmark::State &state) {
+  const string value{static_cast<int64_t>(1234567890123)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(value.to_int());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_string_to_int);
+
+static void BM_string_compare(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0));
+  const string copy{text.c_str(), text.size()};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text == copy);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_string_compare)->Range(8, 1 << 16);
+
+static void BM_strpos(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0)).append(string{"needle"});
+  const string needle{"needle"};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$strpos(text, needle));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_strpos)->Range(64, 1 << 16);
+
+static void BM_str_replace(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0));
+  const string search{"a"};
+  const string replace{"[A]"};
+  for (auto _ : state) {
+    int64_t count = 0;
+    benchmark::DoNotOptimize(f$str_replace(search, replace, text, count));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_str_replace)->Range(64, 1 << 16);
+
+static void BM_strtr_pairs(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0));
+  array<string> pairs;
+  for (int i = 0; i < 16; ++i) {
+    pairs.set_value(bench_data::random_word(2, 4), bench_data::random_word(1, 6));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$strtr(text, pairs));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_strtr_pairs)->Range(64, 1 << 16);
+
+static void BM_htmlspecialchars(benchmark::State &state) {
+  string text = bench_data::random_text(state.range(0));
+  for (string::size_type i = 0; i < text.size(); i += 97) {
+    text[i] = '<';
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$htmlspecialchars(text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_htmlspecialchars)->Range(64, 1 << 16);
+
+static void BM_explode_implode(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0));
+  const string space{" "};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$implode(space, f$explode(space, text)));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_explode_implode)->Range(64, 1 << 16);
+
+static void BM_strtolower(benchmark::State &state) {
+  const string text = bench_data::random_text(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f$strtolower(text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_strtolower)->Range(64, 1 << 16);
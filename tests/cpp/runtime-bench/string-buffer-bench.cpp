@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include "runtime/kphp_core.h"
+#include "tests/cpp/runtime-bench/bench-data.h"
+
+static void BM_string_buffer_append_strings(benchmark::State &state) {
+  array<string> words;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    words.push_back(bench_data::random_word());
+  }
+  string_buffer sb;
+  for (auto _ : state) {
+    sb.clean();
+    for (const auto &word : words) {
+      sb << word.get_value();
+    }
+    benchmark::DoNotOptimize(sb.str());
+  }
+  state.SetBytesProcessed(state.iterations() * sb.size());
+}
+BENCHMARK(BM_string_buffer_append_strings)->Range(8, 1 << 16);
+
+static void BM_string_buffer_append_ints(benchmark::State &state) {
+  string_buffer sb;
+  for (auto _ : state) {
+    sb.clean();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      sb << i * 7919 << ',';
+    }
+    benchmark::DoNotOptimize(sb.str());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_string_buffer_append_ints)->Range(8, 1 << 16);
+
+static void BM_string_buffer_append_doubles(benchmark::State &state) {
+  string_buffer sb;
+  for (auto _ : state) {
+    sb.clean();
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      sb << static_cast<double>(i) / 7.0 << ',';
+    }
+    benchmark::DoNotOptimize(sb.str());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_string_buffer_append_doubles)->Range(8, 1 << 14);
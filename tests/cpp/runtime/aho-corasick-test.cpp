@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "runtime/string_functions.h"
+
+namespace {
+
+std::string naive_strtr(const std::string &subject, const std::vector<std::pair<std::string, std::string>> &pairs) {
+  std::string result;
+  for (size_t pos = 0; pos < subject.size();) {
+    const std::pair<std::string, std::string> *best = nullptr;
+    for (const auto &pair : pairs) {
+      if (subject.compare(pos, pair.first.size(), pair.first) == 0 && (!best || best->first.size() < pair.first.size())) {
+        best = &pair;
+      }
+    }
+    if (best) {
+      result += best->second;
+      pos += best->first.size();
+    } else {
+      result += subject[pos++];
+    }
+  }
+  return result;
+}
+
+std::string naive_str_replace(std::string subject, const std::vector<std::pair<std::string, std::string>> &pairs, int64_t &replace_count) {
+  for (const auto &pair : pairs) {
+    for (size_t pos = subject.find(pair.first); pos != std::string::npos; pos = subject.find(pair.first, pos + pair.second.size())) {
+      subject.replace(pos, pair.first.size(), pair.second);
+      ++replace_count;
+    }
+  }
+  return subject;
+}
+
+std::string random_string(std::mt19937 &gen, size_t min_len, size_t max_len, const char *alphabet) {
+  const size_t alphabet_size = strlen(alphabet);
+  std::string s(std::uniform_int_distribution<size_t>{min_len, max_len}(gen), ' ');
+  for (char &c : s) {
+    c = alphabet[std::uniform_int_distribution<size_t>{0, alphabet_size - 1}(gen)];
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(aho_corasick_test, test_strtr) {
+  array<string> pairs;
+  pairs.set_value(string{"hi"}, string{"hello"});
+  pairs.set_value(string{"hello"}, string{"hi"});
+  pairs.set_value(string{"h"}, string{"-"});
+  ASSERT_STREQ(f$strtr(string{"hi all, I said hello"}, pairs).c_str(), "hello all, I said hi");
+  ASSERT_STREQ(f$strtr(string{"ahhi"}, pairs).c_str(), "a-hello");
+  ASSERT_STREQ(f$strtr(string{"nothing, oh"}, pairs).c_str(), "nothellong, o-");
+  ASSERT_STREQ(f$strtr(string{""}, pairs).c_str(), "");
+
+  pairs.set_value(string{""}, string{"empty"});
+  ASSERT_STREQ(f$strtr(string{"hi"}, pairs).c_str(), "hi");
+}
+
+TEST(aho_corasick_test, test_strtr_random) {
+  std::mt19937 gen{42};
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    std::vector<std::pair<std::string, std::string>> pairs;
+    array<string> replace_pairs;
+    const int pairs_count = std::uniform_int_distribution<int>{2, 10}(gen);
+    for (int i = 0; i < pairs_count; ++i) {
+      const std::string search = random_string(gen, 1, 4, "abc");
+      const std::string replace = random_string(gen, 0, 4, "abcd");
+      if (!replace_pairs.has_key(string{search.c_str(), static_cast<string::size_type>(search.size())})) {
+        pairs.emplace_back(search, replace);
+        replace_pairs.set_value(string{search.c_str(), static_cast<string::size_type>(search.size())},
+                                string{replace.c_str(), static_cast<string::size_type>(replace.size())});
+      }
+    }
+    const std::string subject = random_string(gen, 0, 40, "abcd");
+    const string result = f$strtr(string{subject.c_str(), static_cast<string::size_type>(subject.size())}, replace_pairs);
+    ASSERT_EQ(std::string(result.c_str(), result.size()), naive_strtr(subject, pairs)) << subject;
+  }
+}
+
+TEST(aho_corasick_test, test_str_replace_random) {
+  std::mt19937 gen{42};
+  std::vector<std::string> letter_pairs = {"ab", "cd", "ef", "gh", "ij", "kl", "mn", "op", "qr", "st", "uv", "wx", "yz"};
+  for (int iteration = 0; iteration < 4000; ++iteration) {
+    std::shuffle(letter_pairs.begin(), letter_pairs.end(), gen);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    array<string> search;
+    array<string> replace;
+    const int pairs_count = std::uniform_int_distribution<int>{8, 13}(gen);
+    for (int i = 0; i < pairs_count; ++i) {
+      // the patterns of the odd iterations can't overlap, so they are mostly replaced in a single pass
+      const std::string search_string = iteration % 2 ? random_string(gen, 1, 3, letter_pairs[i].c_str())
+                                                      : random_string(gen, 1, 3, "abcdefghij");
+      const std::string replace_string = random_string(gen, iteration % 4 == 1 ? 1 : 0, 3, iteration % 3 ? "XYZ" : "aXYZ");
+      pairs.emplace_back(search_string, replace_string);
+      search.push_back(string{search_string.c_str(), static_cast<string::size_type>(search_string.size())});
+      replace.push_back(string{replace_string.c_str(), static_cast<string::size_type>(replace_string.size())});
+    }
+    const std::string subject = random_string(gen, 0, 60, "abcdefghijklmnopqrstuvwxyz");
+    int64_t replace_count = 0;
+    const string result = f$str_replace(search, replace, string{subject.c_str(), static_cast<string::size_type>(subject.size())}, replace_count);
+    int64_t expected_replace_count = 0;
+    ASSERT_EQ(std::string(result.c_str(), result.size()), naive_str_replace(subject, pairs, expected_replace_count)) << subject;
+    ASSERT_EQ(replace_count, expected_replace_count) << subject;
+  }
+}
+
+TEST(aho_corasick_test, test_cached_const_arrays) {
+  array<string> search;
+  array<string> replace;
+  for (char c = 'a'; c <= 'j'; ++c) {
+    search.push_back(string(1, c));
+    replace.push_back(string(2, static_cast<char>(c - 'a' + 'A')));
+  }
+  search.set_reference_counter_to(ExtraRefCnt::for_global_const);
+  replace.set_reference_counter_to(ExtraRefCnt::for_global_const);
+
+  for (int i = 0; i < 2; ++i) {
+    int64_t replace_count = 0;
+    ASSERT_STREQ(f$str_replace(search, replace, string{"a-b-j-k"}, replace_count).c_str(), "AA-BB-JJ-k");
+    ASSERT_EQ(replace_count, 3);
+    ASSERT_NE(get_cached_aho_corasick_replacer(search.get_inner_pointer(), replace.get_inner_pointer()), nullptr);
+  }
+}
+
+TEST(aho_corasick_test, test_str_replace_fallback_with_converted_values) {
+  array<mixed> search;
+  array<mixed> replace;
+  for (int64_t i = 1; i <= 8; ++i) {
+    // '1' and '12' overlap, so the automaton falls back to the sequential replacement
+    search.push_back(i == 8 ? mixed{12} : mixed{i});
+    replace.push_back(i == 1 ? mixed{string{"-"}} : mixed{i * 10});
+  }
+
+  int64_t replace_count = 0;
+  ASSERT_STREQ(f$str_replace(mixed{search}, mixed{string{"x"}}, string{"1234567"}, replace_count).c_str(), "xxxxxxx");
+  ASSERT_EQ(replace_count, 7);
+
+  replace_count = 0;
+  ASSERT_STREQ(f$str_replace(mixed{search}, mixed{replace}, string{"12 7"}, replace_count).c_str(), "-20 70");
+  ASSERT_EQ(replace_count, 3);
+}
@@ -132,3 +132,36 @@ TEST(array_test, test_mutate_shared_map) {
   ASSERT_EQ(arr_copy.get_reference_counter(), 1);
   ASSERT_FALSE(arr_copy.is_equal_inner_pointer(arr));
 }
+
+TEST(array_test, test_map_order_after_unset) {
+  array<int64_t> arr;
+  for (int64_t i = 0; i < 1000; ++i) {
+    arr.set_value(string{"key_"}.append(i), i);
+    arr.set_value(i * 7, i);
+  }
+  for (int64_t i = 0; i < 1000; i += 3) {
+    arr.unset(string{"key_"}.append(i));
+    arr.unset(i * 7);
+  }
+
+  ASSERT_EQ(arr.count(), 1332);
+  int64_t expected = 1;
+  bool expect_string_key = true;
+  for (auto it = arr.begin(); it != arr.end(); ++it) {
+    ASSERT_EQ(it.get_value(), expected);
+    ASSERT_EQ(it.is_string_key(), expect_string_key);
+    if (expect_string_key) {
+      ASSERT_EQ(it.get_string_key(), string{"key_"}.append(expected));
+    } else {
+      ASSERT_EQ(it.get_int_key(), expected * 7);
+      expected += expected % 3 == 2 ? 2 : 1;
+    }
+    expect_string_key = !expect_string_key;
+  }
+  ASSERT_EQ(expected, 1000);
+
+  for (int64_t i = 0; i < 1000; ++i) {
+    ASSERT_EQ(arr.isset(string{"key_"}.append(i)), i % 3 != 0);
+    ASSERT_EQ(arr.isset(i * 7), i % 3 != 0);
+  }
+}
@@ -89,6 +89,13 @@ TEST(confdata_functions_test, test_confdata_get_values_by_any_wildcard) {
     std::make_pair(mixed{string{"_2"}}, mixed{string{"value_2"}})
   }));
 
+  ASSERT_TRUE(equals(f$confdata_get_values_by_any_wildcard(string{"_ke"}), array<mixed>{
+    std::make_pair(mixed{string{"y_1"}}, mixed{string{"value_1"}}),
+    std::make_pair(mixed{string{"y_2"}}, mixed{string{"value_2"}})
+  }));
+  ASSERT_EQ(f$confdata_get_values_by_any_wildcard(string{"_key_\xFF"}).count(), 0);
+  ASSERT_EQ(f$confdata_get_values_by_any_wildcard(string{"\xFF"}).count(), 0);
+
   ASSERT_TRUE(equals(f$confdata_get_values_by_any_wildcard(string{"_one dot."}), array<mixed>{
     std::make_pair(mixed{string{"one_1"}}, mixed{string{"one_value_1"}}),
     std::make_pair(mixed{string{"one_2"}}, mixed{string{"one_value_2"}}),
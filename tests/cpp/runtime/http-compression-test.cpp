@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <zstd.h>
+
+#include "runtime/http-compression.h"
+#include "runtime/zlib.h"
+
+namespace {
+
+string make_body(int size) {
+  string body;
+  for (int i = 0; body.size() < size; ++i) {
+    body.append(string{"<div class=\"item\">"}).append(string{static_cast<int64_t>(i)}).append(string{"</div>\n"});
+  }
+  return body;
+}
+
+string zstd_decode(const string &compressed, string::size_type size) {
+  string result(size, false);
+  const size_t decoded = ZSTD_decompress(result.buffer(), size, compressed.c_str(), compressed.size());
+  return ZSTD_isError(decoded) ? string{} : string{result.c_str(), static_cast<string::size_type>(decoded)};
+}
+
+} // namespace
+
+TEST(http_compression_test, test_accept_encoding) {
+  ASSERT_EQ(parse_http_accept_encoding("gzip, deflate, br"), HTTP_ACCEPT_GZIP | HTTP_ACCEPT_DEFLATE);
+  ASSERT_EQ(choose_http_encoding(parse_http_accept_encoding("gzip, deflate, br")), HttpEncoding::gzip);
+  ASSERT_EQ(choose_http_encoding(parse_http_accept_encoding("deflate, zstd")), HttpEncoding::zstd);
+  ASSERT_EQ(choose_http_encoding(parse_http_accept_encoding("br")), HttpEncoding::identity);
+}
+
+TEST(http_compression_test, test_levels) {
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 100), 6);
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::zstd, 100), 3);
+
+  ASSERT_TRUE(set_http_compression_levels("gzip", "5,1000:3,100000:1"));
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 0), 5);
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::deflate, 999), 5);
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 1000), 3);
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 1000000), 1);
+
+  ASSERT_FALSE(set_http_compression_levels("gzip", "10"));
+  ASSERT_FALSE(set_http_compression_levels("gzip", "6,1000"));
+  ASSERT_FALSE(set_http_compression_levels("gzip", "6,1000:3,500:1"));
+  ASSERT_FALSE(set_http_compression_levels("brotli", "6"));
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 1000), 3);
+
+  ASSERT_TRUE(set_http_compression_levels("gzip", "6"));
+  ASSERT_EQ(get_http_compression_level(HttpEncoding::gzip, 1000000), 6);
+}
+
+TEST(http_compression_test, test_compress) {
+  const string body = make_body(100000);
+  ASSERT_EQ(f$gzdecode(http_compress(HttpEncoding::gzip, body.c_str(), body.size())->str()), body);
+  ASSERT_EQ(f$gzuncompress(http_compress(HttpEncoding::deflate, body.c_str(), body.size())->str()), body);
+  ASSERT_EQ(zstd_decode(http_compress(HttpEncoding::zstd, body.c_str(), body.size())->str(), body.size()), body);
+}
+
+TEST(http_compression_test, test_cache) {
+  set_http_compression_cache_size_limit(1 << 20);
+  const string body = make_body(10000);
+  const string compressed = http_compress(HttpEncoding::gzip, body.c_str(), body.size())->str();
+  ASSERT_EQ(http_compress(HttpEncoding::gzip, body.c_str(), body.size())->str(), compressed);
+  ASSERT_EQ(f$gzdecode(compressed), body);
+
+  const string other_body = make_body(20000);
+  ASSERT_EQ(f$gzdecode(http_compress(HttpEncoding::gzip, other_body.c_str(), other_body.size())->str()), other_body);
+  ASSERT_EQ(zstd_decode(http_compress(HttpEncoding::zstd, body.c_str(), body.size())->str(), body.size()), body);
+  set_http_compression_cache_size_limit(0);
+}
+
+TEST(http_compression_test, test_stream_compress) {
+  const string body = make_body(50000);
+  for (HttpEncoding encoding : {HttpEncoding::gzip, HttpEncoding::zstd}) {
+    http_stream_compression_start(encoding);
+    string compressed;
+    for (string::size_type pos = 0; pos < body.size(); pos += 7000) {
+      const string part = body.substr(pos, std::min(body.size() - pos, 7000u));
+      compressed.append(http_stream_compress(part.c_str(), part.size(), false)->str());
+    }
+    compressed.append(http_stream_compress("", 0, true)->str());
+    if (encoding == HttpEncoding::gzip) {
+      ASSERT_EQ(f$gzdecode(compressed), body);
+    } else {
+      ASSERT_EQ(zstd_decode(compressed, body.size()), body);
+    }
+  }
+  free_http_compression_lib();
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "runtime/critical_section.h"
+#include "runtime/instance_cache.h"
+#include "runtime/refcountable_php_classes.h"
+
+namespace {
+
+struct C$CachedValue : public refcountable_php_classes<C$CachedValue> {
+  using immutable_class_tag = C$CachedValue;
+
+  int64_t $id{0};
+  string $name;
+
+  const char *get_class() const {
+    return "CachedValue";
+  }
+
+  template<class Visitor>
+  void generic_accept(Visitor &&visitor) {
+    visitor("id", $id);
+    visitor("name", $name);
+  }
+
+  void accept(DeepMoveFromScriptToCacheVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+
+  void accept(DeepDestroyFromCacheVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+};
+
+class_instance<C$CachedValue> make_value(int64_t id, const char *name) {
+  class_instance<C$CachedValue> value;
+  value.alloc();
+  value->$id = id;
+  value->$name = string{name};
+  return value;
+}
+
+class_instance<C$CachedValue> fetch_value(const char *key, bool even_if_expired = false) {
+  return f$instance_cache_fetch<class_instance<C$CachedValue>>(string{"CachedValue"}, string{key}, even_if_expired);
+}
+
+// the request caches are dropped, so the next fetch goes to the published storage
+void start_new_request() {
+  free_instance_cache_lib();
+  init_instance_cache_lib();
+}
+
+} // namespace
+
+TEST(instance_cache_test, fetch_published_element) {
+  ASSERT_TRUE(f$instance_cache_store(string{"fetch_published_element"}, make_value(42, "answer"), 100));
+  start_new_request();
+
+  for (int i = 0; i < 3; ++i) {
+    auto value = fetch_value("fetch_published_element");
+    ASSERT_FALSE(value.is_null());
+    ASSERT_EQ(value->$id, 42);
+    ASSERT_STREQ(value->$name.c_str(), "answer");
+    ASSERT_TRUE(value.is_cache_reference_counter());
+    // the reading of the published storage is finished together with its critical section
+    ASSERT_EQ(dl::in_critical_section, 0);
+    start_new_request();
+  }
+
+  ASSERT_TRUE(fetch_value("fetch_absent_element").is_null());
+  ASSERT_EQ(dl::in_critical_section, 0);
+}
+
+TEST(instance_cache_test, fetch_replaced_element) {
+  ASSERT_TRUE(f$instance_cache_store(string{"fetch_replaced_element"}, make_value(1, "first"), 100));
+  start_new_request();
+  auto first_value = fetch_value("fetch_replaced_element");
+  ASSERT_FALSE(first_value.is_null());
+
+  // the previous snapshot is kept while the element is used by this request
+  ASSERT_TRUE(f$instance_cache_store(string{"fetch_replaced_element"}, make_value(2, "second"), 100));
+  ASSERT_EQ(first_value->$id, 1);
+  ASSERT_STREQ(first_value->$name.c_str(), "first");
+  first_value = class_instance<C$CachedValue>{};
+  start_new_request();
+
+  auto second_value = fetch_value("fetch_replaced_element");
+  ASSERT_FALSE(second_value.is_null());
+  ASSERT_EQ(second_value->$id, 2);
+  ASSERT_STREQ(second_value->$name.c_str(), "second");
+  second_value = class_instance<C$CachedValue>{};
+  start_new_request();
+}
+
+TEST(instance_cache_test, update_ttl_and_delete) {
+  ASSERT_FALSE(f$instance_cache_update_ttl(string{"update_ttl_and_delete"}, 100));
+  ASSERT_FALSE(f$instance_cache_delete(string{"update_ttl_and_delete"}));
+
+  ASSERT_TRUE(f$instance_cache_store(string{"update_ttl_and_delete"}, make_value(7, "seven"), 100));
+  ASSERT_TRUE(f$instance_cache_update_ttl(string{"update_ttl_and_delete"}, 0));
+  start_new_request();
+  ASSERT_FALSE(fetch_value("update_ttl_and_delete").is_null());
+  start_new_request();
+
+  // the next fetch of the deleted element misses, but it still can be fetched with even_if_expired
+  ASSERT_TRUE(f$instance_cache_delete(string{"update_ttl_and_delete"}));
+  start_new_request();
+  ASSERT_TRUE(fetch_value("update_ttl_and_delete").is_null());
+  auto expired_value = fetch_value("update_ttl_and_delete", true);
+  ASSERT_FALSE(expired_value.is_null());
+  ASSERT_EQ(expired_value->$id, 7);
+  expired_value = class_instance<C$CachedValue>{};
+  start_new_request();
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "runtime/instance-json.h"
+#include "runtime/refcountable_php_classes.h"
+
+namespace {
+
+struct C$Point : public refcountable_php_classes<C$Point> {
+  int64_t $x{0};
+  double $y{0};
+
+  const char *get_class() const {
+    return "Point";
+  }
+
+  template<class Visitor>
+  void generic_accept(Visitor &&visitor) {
+    visitor("x", $x);
+    visitor("y", $y);
+  }
+
+  void accept(InstanceToJsonVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+
+  void accept(InstanceFromJsonVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+};
+
+struct C$Route : public refcountable_php_classes<C$Route> {
+  string $name;
+  bool $active{false};
+  Optional<int64_t> $limit;
+  array<class_instance<C$Point>> $points;
+  class_instance<C$Point> $start;
+  std::tuple<int64_t, string> $tag;
+  mixed $extra;
+
+  const char *get_class() const {
+    return "Route";
+  }
+
+  template<class Visitor>
+  void generic_accept(Visitor &&visitor) {
+    visitor("name", $name);
+    visitor("active", $active);
+    visitor("limit", $limit);
+    visitor("points", $points);
+    visitor("start", $start);
+    visitor("tag", $tag);
+    visitor("extra", $extra);
+  }
+
+  void accept(InstanceToJsonVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+
+  void accept(InstanceFromJsonVisitor &visitor) {
+    return generic_accept(visitor);
+  }
+};
+
+class_instance<C$Point> make_point(int64_t x, double y) {
+  class_instance<C$Point> point;
+  point.alloc();
+  point->$x = x;
+  point->$y = y;
+  return point;
+}
+
+} // namespace
+
+TEST(instance_json_test, encode) {
+  class_instance<C$Route> route;
+  route.alloc();
+  route->$name = string{"r\"1"};
+  route->$active = true;
+  route->$points.push_back(make_point(1, 2.5));
+  route->$points.push_back(make_point(-3, 0));
+  route->$tag = std::make_tuple(int64_t{7}, string{"t"});
+  route->$extra = mixed{int64_t{5}};
+
+  auto json = f$instance_to_json(route);
+  ASSERT_TRUE(json.has_value());
+  ASSERT_STREQ(json.val().c_str(),
+               R"({"name":"r\"1","active":true,"limit":null,"points":[{"x":1,"y":2.5},{"x":-3,"y":0}],"start":null,"tag":[7,"t"],"extra":5})");
+
+  ASSERT_STREQ(f$instance_to_json(class_instance<C$Route>{}).val().c_str(), "null");
+}
+
+TEST(instance_json_test, decode) {
+  const string json{R"( {"extra": {"a": [1]}, "unknown": [{"x": 1}, null], "name": "abc", "limit": 10,
+                        "points": [{"y": 1.5, "x": 2}, {}], "start": {"x": 4}, "tag": [3, "q"], "active": false} )"};
+  auto route = f$instance_from_json<class_instance<C$Route>>(json, string{"Route"});
+  ASSERT_FALSE(route.is_null());
+  ASSERT_STREQ(route->$name.c_str(), "abc");
+  ASSERT_FALSE(route->$active);
+  ASSERT_TRUE(route->$limit.has_value());
+  ASSERT_EQ(route->$limit.val(), 10);
+  ASSERT_EQ(route->$points.count(), 2);
+  ASSERT_EQ(route->$points.get_value(0)->$x, 2);
+  ASSERT_EQ(route->$points.get_value(0)->$y, 1.5);
+  ASSERT_EQ(route->$points.get_value(1)->$x, 0);
+  ASSERT_EQ(route->$start->$x, 4);
+  ASSERT_EQ(std::get<0>(route->$tag), 3);
+  ASSERT_STREQ(std::get<1>(route->$tag).c_str(), "q");
+  ASSERT_TRUE(route->$extra.is_array());
+}
+
+TEST(instance_json_test, decode_round_trip) {
+  class_instance<C$Route> route;
+  route.alloc();
+  route->$name = string{"\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82"};
+  route->$limit = false;
+  route->$start = make_point(9, -0.25);
+
+  auto json = f$instance_to_json(route, JSON_UNESCAPED_UNICODE);
+  ASSERT_TRUE(json.has_value());
+  auto decoded = f$instance_from_json<class_instance<C$Route>>(json.val(), string{"Route"});
+  ASSERT_FALSE(decoded.is_null());
+  ASSERT_STREQ(f$instance_to_json(decoded, JSON_UNESCAPED_UNICODE).val().c_str(), json.val().c_str());
+}
+
+TEST(instance_json_test, decode_errors) {
+  for (const char *json : {"", "[]", "{", "{\"x\":\"1\"}", "{\"x\":1,}", "{\"x\":true}", "{\"x\":1} 1", "{\"y\":[]}"}) {
+    ASSERT_TRUE(f$instance_from_json<class_instance<C$Point>>(string{json}, string{"Point"}).is_null()) << json;
+  }
+  ASSERT_TRUE(f$instance_from_json<class_instance<C$Point>>(string{"null"}, string{"Point"}).is_null());
+  ASSERT_FALSE(f$instance_from_json<class_instance<C$Point>>(string{"{}"}, string{"Point"}).is_null());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "runtime/inter-process-epoch.h"
+
+namespace {
+
+void set_reader_id(int id) {
+  workers_n = 10;
+  logname_id = id;
+}
+
+} // namespace
+
+TEST(inter_process_epoch_control_test, test_no_readers) {
+  InterProcessEpochControl epoch_control;
+  set_reader_id(0);
+
+  const uint64_t first_retired_epoch = epoch_control.retire();
+  ASSERT_LT(first_retired_epoch, epoch_control.get_oldest_reading_epoch());
+  const uint64_t second_retired_epoch = epoch_control.retire();
+  ASSERT_LT(first_retired_epoch, second_retired_epoch);
+  ASSERT_LT(second_retired_epoch, epoch_control.get_oldest_reading_epoch());
+}
+
+TEST(inter_process_epoch_control_test, test_retired_while_reading) {
+  InterProcessEpochControl epoch_control;
+
+  set_reader_id(1);
+  epoch_control.enter_reading();
+
+  set_reader_id(2);
+  const uint64_t first_retired_epoch = epoch_control.retire();
+  ASSERT_GE(first_retired_epoch, epoch_control.get_oldest_reading_epoch());
+
+  {
+    auto reading_guard = epoch_control.reading_guard();
+    const uint64_t second_retired_epoch = epoch_control.retire();
+    ASSERT_GE(second_retired_epoch, epoch_control.get_oldest_reading_epoch());
+
+    set_reader_id(1);
+    epoch_control.leave_reading();
+    // the first data can't be seen by the second reader
+    ASSERT_LT(first_retired_epoch, epoch_control.get_oldest_reading_epoch());
+    ASSERT_GE(second_retired_epoch, epoch_control.get_oldest_reading_epoch());
+    set_reader_id(2);
+  }
+  const uint64_t last_retired_epoch = epoch_control.retire();
+  ASSERT_EQ(epoch_control.get_oldest_reading_epoch(), last_retired_epoch + 1);
+}
+
+TEST(inter_process_epoch_control_test, test_force_leave_reading) {
+  InterProcessEpochControl epoch_control;
+
+  set_reader_id(3);
+  epoch_control.enter_reading();
+  const uint64_t retired_epoch = epoch_control.retire();
+  ASSERT_GE(retired_epoch, epoch_control.get_oldest_reading_epoch());
+
+  epoch_control.force_leave_reading();
+  ASSERT_LT(retired_epoch, epoch_control.get_oldest_reading_epoch());
+  epoch_control.enter_reading();
+  epoch_control.leave_reading();
+}
+
+TEST(inter_process_epoch_control_test, test_reader_beyond_workers_number) {
+  InterProcessEpochControl epoch_control;
+
+  // e.g. a process, which has been started before the workers number was decreased
+  set_reader_id(MAX_WORKERS - 1);
+  epoch_control.enter_reading();
+
+  set_reader_id(0);
+  const uint64_t retired_epoch = epoch_control.retire();
+  ASSERT_GE(retired_epoch, epoch_control.get_oldest_reading_epoch());
+
+  set_reader_id(MAX_WORKERS - 1);
+  epoch_control.leave_reading();
+  ASSERT_LT(retired_epoch, epoch_control.get_oldest_reading_epoch());
+}
@@ -0,0 +1,106 @@
+#include <array>
+#include <map>
+#include <gtest/gtest.h>
+
+#include "runtime/memory_resource/persistent_map.h"
+#include "runtime/memory_resource/unsynchronized_pool_resource.h"
+
+namespace {
+
+using test_persistent_map = memory_resource::persistent_map<int64_t, int64_t, memory_resource::unsynchronized_pool_resource>;
+
+void expect_equal(const test_persistent_map &map, const std::map<int64_t, int64_t> &expected) {
+  ASSERT_EQ(map.size(), expected.size());
+  ASSERT_EQ(map.empty(), expected.empty());
+  auto expected_it = expected.begin();
+  for (auto it = map.begin(); it != map.end(); ++it, ++expected_it) {
+    ASSERT_NE(expected_it, expected.end());
+    ASSERT_EQ(it->first, expected_it->first);
+    ASSERT_EQ(it->second, expected_it->second);
+  }
+  ASSERT_EQ(expected_it, expected.end());
+}
+
+} // namespace
+
+TEST(persistent_map_test, insert_find_erase) {
+  std::array<char, 1024 * 1024> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(some_memory.data(), some_memory.size());
+
+  {
+    test_persistent_map map{test_persistent_map::allocator_type{resource}};
+    std::map<int64_t, int64_t> expected;
+    for (int64_t i = 0; i < 1000; ++i) {
+      const int64_t key = (i * 7919) % 1000;
+      ASSERT_TRUE(map.try_emplace(key, i).second);
+      expected.emplace(key, i);
+    }
+    ASSERT_FALSE(map.try_emplace(int64_t{5}, int64_t{0}).second);
+    expect_equal(map, expected);
+
+    ASSERT_EQ(map.find(int64_t{1000}), map.end());
+    ASSERT_EQ(map.find(int64_t{500})->first, 500);
+    ASSERT_EQ(map.lower_bound(int64_t{-1})->first, 0);
+    ASSERT_EQ(map.lower_bound(int64_t{1000}), map.end());
+
+    for (int64_t i = 0; i < 1000; i += 3) {
+      ASSERT_TRUE(map.erase(i));
+      expected.erase(i);
+    }
+    ASSERT_FALSE(map.erase(int64_t{0}));
+    ASSERT_EQ(map.find_for_update(int64_t{0}), nullptr);
+    map.find_for_update(int64_t{1})->second = -1;
+    expected[1] = -1;
+    expect_equal(map, expected);
+  }
+
+  ASSERT_EQ(resource.get_memory_stats().memory_used, 0);
+}
+
+TEST(persistent_map_test, copies_are_independent) {
+  std::array<char, 1024 * 1024> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+  resource.init(some_memory.data(), some_memory.size());
+
+  {
+    test_persistent_map map{test_persistent_map::allocator_type{resource}};
+    std::map<int64_t, int64_t> expected;
+    for (int64_t i = 0; i < 1000; ++i) {
+      map[i] = i;
+      expected[i] = i;
+    }
+    const auto memory_used = resource.get_memory_stats().memory_used;
+
+    test_persistent_map snapshot = map;
+    ASSERT_EQ(resource.get_memory_stats().memory_used, memory_used);
+
+    size_t not_shared = 0;
+    map.for_each_not_shared([&not_shared](std::pair<const int64_t, int64_t> &) { ++not_shared; });
+    ASSERT_EQ(not_shared, 0);
+
+    map.find_for_update(int64_t{10})->second = -10;
+    map.erase(int64_t{20});
+    map[int64_t{2000}] = 2000;
+
+    not_shared = 0;
+    map.for_each_not_shared([&not_shared](std::pair<const int64_t, int64_t> &) { ++not_shared; });
+    ASSERT_GT(not_shared, 0);
+    ASSERT_LT(not_shared, 100);
+    // only paths from the root are copied
+    ASSERT_LT(resource.get_memory_stats().memory_used, memory_used + memory_used / 10);
+
+    expect_equal(snapshot, expected);
+
+    expected[10] = -10;
+    expected.erase(20);
+    expected[2000] = 2000;
+    expect_equal(map, expected);
+
+    snapshot.clear();
+    expect_equal(map, expected);
+    ASSERT_EQ(resource.get_memory_stats().memory_used, memory_used);
+  }
+
+  ASSERT_EQ(resource.get_memory_stats().memory_used, 0);
+}
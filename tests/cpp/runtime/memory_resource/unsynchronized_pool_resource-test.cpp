@@ -292,4 +292,91 @@ TEST(unsynchronized_pool_resource_test, test_auto_defragmentation_small_piece) {
   ASSERT_EQ(mem_stats.small_memory_pieces, 0);
 
   resource.deallocate(mem64, 64);
-}
\ No newline at end of file
+}
+
+TEST(unsynchronized_pool_resource_test, test_slab_mode) {
+  std::array<char, 1024*256> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+  constexpr size_t slab_size = memory_resource::details::memory_slab::SIZE;
+
+  resource.init(some_memory.data() + 8, some_memory.size() - 8, true);
+
+  std::array<void *, 400> pieces{};
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    const size_t size = i % 2 ? 24 : 500;
+    pieces[i] = resource.allocate(size);
+    ASSERT_TRUE(pieces[i]);
+    memset(pieces[i], static_cast<int>(i), size);
+  }
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    const size_t size = i % 2 ? 24 : 500;
+    const auto *mem = static_cast<const unsigned char *>(pieces[i]);
+    ASSERT_EQ(mem[0], static_cast<unsigned char>(i));
+    ASSERT_EQ(mem[size - 1], static_cast<unsigned char>(i));
+  }
+
+  auto mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.memory_used, 200 * 24 + 200 * 504);
+  ASSERT_LE(mem_stats.memory_slabs, mem_stats.real_memory_used / slab_size);
+  ASSERT_EQ(mem_stats.defragmentation_calls, 0);
+  const size_t memory_slabs = mem_stats.memory_slabs;
+
+  // the empty slabs are released, but the last slab of each size is kept
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    resource.deallocate(pieces[i], i % 2 ? 24 : 500);
+  }
+  mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.memory_used, 0);
+  ASSERT_EQ(mem_stats.memory_slabs, 2);
+
+  // the released slabs are reused for another sizes
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    pieces[i] = resource.allocate(256);
+    ASSERT_TRUE(pieces[i]);
+  }
+  mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.memory_used, pieces.size() * 256);
+  ASSERT_LE(mem_stats.memory_slabs, memory_slabs + 2);
+  ASSERT_EQ(mem_stats.defragmentation_calls, 0);
+
+  // the huge pieces don't interfere with the slabs
+  void *huge_mem = resource.allocate(slab_size + 8);
+  ASSERT_TRUE(huge_mem);
+  for (auto &mem: pieces) {
+    resource.deallocate(mem, 256);
+  }
+  resource.deallocate(huge_mem, slab_size + 8);
+
+  mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.memory_used, 0);
+  ASSERT_EQ(mem_stats.memory_slabs, 3);
+}
+
+TEST(unsynchronized_pool_resource_test, test_slab_mode_defragmentation) {
+  std::array<char, 1024*128> some_memory{};
+  memory_resource::unsynchronized_pool_resource resource;
+
+  resource.init(some_memory.data(), some_memory.size(), true);
+
+  std::array<void *, 1024> pieces{};
+  for (auto &mem: pieces) {
+    mem = resource.allocate(64);
+    ASSERT_TRUE(mem);
+  }
+  for (auto &mem: pieces) {
+    resource.deallocate(mem, 64);
+  }
+
+  // 5 slabs are used, the last one is kept, the empty ones are merged back by the defragmentation
+  const size_t free_slabs_size = 4 * memory_resource::details::memory_slab::SIZE;
+  void *mem_free_slabs = resource.allocate(free_slabs_size);
+  ASSERT_EQ(mem_free_slabs, some_memory.data());
+  auto mem_stats = resource.get_memory_stats();
+  ASSERT_EQ(mem_stats.defragmentation_calls, 1);
+  ASSERT_EQ(mem_stats.memory_slabs, 1);
+  resource.deallocate(mem_free_slabs, free_slabs_size);
+
+  void *mem8 = resource.allocate(8);
+  ASSERT_TRUE(mem8);
+  resource.deallocate(mem8, 8);
+}
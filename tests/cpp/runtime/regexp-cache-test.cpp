@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "runtime/regexp.h"
+
+namespace {
+
+class regexp_cache_test : public testing::Test {
+protected:
+  // leaves only one pattern in the cache, so the evictions of the test don't depend on the other tests
+  void SetUp() final {
+    set_regexp_cache_size_limit(1);
+    start_request();
+    regexp reset{string{"/reset/"}};
+    initial_ = regexp_cache_get_stats();
+  }
+
+  void TearDown() final {
+    set_regexp_cache_size_limit(DEFAULT_REGEXP_CACHE_SIZE_LIMIT);
+  }
+
+  static void start_request() {
+    ++dl::query_num;
+  }
+
+  RegexpCacheStats added_stats() const {
+    const auto &stats = regexp_cache_get_stats();
+    RegexpCacheStats result;
+    result.hits = stats.hits - initial_.hits;
+    result.misses = stats.misses - initial_.misses;
+    result.evictions = stats.evictions - initial_.evictions;
+    result.uncached = stats.uncached - initial_.uncached;
+    result.size = stats.size;
+    return result;
+  }
+
+private:
+  RegexpCacheStats initial_;
+};
+
+} // namespace
+
+TEST_F(regexp_cache_test, test_lru_eviction) {
+  set_regexp_cache_size_limit(2);
+
+  start_request();
+  ASSERT_EQ(f$preg_match(regexp{string{"/a/"}}, string{"xax"}).val(), 1);
+  ASSERT_EQ(f$preg_match(regexp{string{"/b/"}}, string{"xax"}).val(), 0);
+  ASSERT_EQ(added_stats().misses, 2);
+  ASSERT_EQ(added_stats().evictions, 1);
+
+  // "/a/" becomes the most recently used pattern, so "/b/" is evicted
+  start_request();
+  ASSERT_EQ(f$preg_match(regexp{string{"/a/"}}, string{"xax"}).val(), 1);
+  ASSERT_EQ(f$preg_match(regexp{string{"/c/"}}, string{"xcx"}).val(), 1);
+  ASSERT_EQ(added_stats().hits, 1);
+  ASSERT_EQ(added_stats().evictions, 2);
+
+  start_request();
+  ASSERT_EQ(f$preg_match(regexp{string{"/a/"}}, string{"xax"}).val(), 1);
+  ASSERT_EQ(f$preg_match(regexp{string{"/b/"}}, string{"xbx"}).val(), 1);
+
+  const auto stats = added_stats();
+  ASSERT_EQ(stats.hits, 2);
+  ASSERT_EQ(stats.misses, 4);
+  ASSERT_EQ(stats.evictions, 3);
+  ASSERT_EQ(stats.uncached, 0);
+  ASSERT_EQ(stats.size, 2);
+}
+
+TEST_F(regexp_cache_test, test_patterns_of_current_request_are_not_evicted) {
+  set_regexp_cache_size_limit(2);
+
+  start_request();
+  regexp a{string{"/a/"}};
+  regexp b{string{"/b/"}};
+  regexp c{string{"/c/"}};
+  ASSERT_EQ(added_stats().uncached, 1);
+  ASSERT_EQ(added_stats().size, 2);
+
+  // the uncached pattern is compiled for the current request
+  ASSERT_EQ(f$preg_match(a, string{"abc"}).val(), 1);
+  ASSERT_EQ(f$preg_match(b, string{"abc"}).val(), 1);
+  ASSERT_EQ(f$preg_match(c, string{"abc"}).val(), 1);
+  ASSERT_EQ(f$preg_match(c, string{"ab"}).val(), 0);
+
+  start_request();
+  ASSERT_EQ(f$preg_match(regexp{string{"/c/"}}, string{"abc"}).val(), 1);
+  ASSERT_EQ(added_stats().uncached, 1);
+  ASSERT_EQ(added_stats().evictions, 2);
+  ASSERT_EQ(added_stats().size, 2);
+}
+
+TEST_F(regexp_cache_test, test_jit_compiled_pcre) {
+  set_regexp_cache_size_limit(2);
+
+  // back references aren't supported by RE2, such patterns are executed by PCRE
+  for (int i = 0; i < 2; ++i) {
+    start_request();
+    mixed matches;
+    ASSERT_EQ(f$preg_match(regexp{string{"/(\\w+) \\1/"}}, string{"say hello hello"}, matches).val(), 1);
+    ASSERT_EQ(matches.get_value(1).to_string(), string{"hello"});
+    ASSERT_EQ(f$preg_match(regexp{string{"/(\\w+) \\1/"}}, string{"say hello world"}).val(), 0);
+  }
+  ASSERT_EQ(added_stats().hits, 1);
+
+  // match limits are kept for the studied patterns
+  start_request();
+  const auto result = f$preg_match(regexp{string{"/^(a+)+\\1$/"}}, string{"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa!"});
+  ASSERT_FALSE(result.has_value());
+  ASSERT_NE(f$preg_last_error(), PHP_PCRE_NO_ERROR);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "runtime/rpc.h"
+#include "runtime/tl/rpc_request.h"
+#include "runtime/tl/tl_builtins.h"
+
+namespace {
+
+class rpc_fetch_test : public testing::Test {
+protected:
+  void TearDown() final {
+    CurException = Optional<bool>{};
+  }
+
+  static void parse(std::initializer_list<int32_t> data) {
+    string rpc_data{reinterpret_cast<const char *>(data.begin()), static_cast<string::size_type>(data.size() * sizeof(int32_t))};
+    ASSERT_TRUE(f$rpc_parse(rpc_data));
+  }
+
+  static int32_t low(int64_t v) {
+    return static_cast<int32_t>(v & 0xffffffff);
+  }
+
+  static int32_t high(int64_t v) {
+    return static_cast<int32_t>(v >> 32);
+  }
+
+  static void expect_not_enough_data() {
+    ASSERT_FALSE(CurException.is_null());
+    ASSERT_EQ(CurException->message, string{"Not enough data to fetch"});
+  }
+};
+
+// 2.5 as the two halves of a little endian double
+constexpr int32_t DOUBLE_2_5_LOW = 0;
+constexpr int32_t DOUBLE_2_5_HIGH = 0x40040000;
+
+constexpr int64_t BIG_LONG = (int64_t{1} << 40) + 7;
+
+} // namespace
+
+// count:int total:long avg:double fields_mask:# name:string, as it's fetched by tl2cpp in the untyped mode
+TEST_F(rpc_fetch_test, test_fixed_fetch_block) {
+  parse({-7, low(BIG_LONG), high(BIG_LONG), DOUBLE_2_5_LOW, DOUBLE_2_5_HIGH, 5, 0x63626103});
+
+  array<mixed> result;
+  if (rpc_check_fetch_len(6)) {
+    result.set_value(string{"count"}, t_Int().fetch_unchecked());
+    result.set_value(string{"total"}, t_Long().fetch_unchecked());
+    result.set_value(string{"avg"}, t_Double().fetch_unchecked());
+    result.set_value(string{"fields_mask"}, t_Int().fetch_unchecked());
+  }
+  result.set_value(string{"name"}, t_String().fetch());
+
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_EQ(result.get_value(string{"count"}).to_int(), -7);
+  ASSERT_EQ(result.get_value(string{"total"}).to_int(), BIG_LONG);
+  ASSERT_EQ(result.get_value(string{"avg"}).to_float(), 2.5);
+  ASSERT_EQ(result.get_value(string{"fields_mask"}).to_int(), 5);
+  ASSERT_EQ(result.get_value(string{"name"}).to_string(), string{"abc"});
+}
+
+TEST_F(rpc_fetch_test, test_typed_fixed_fetch_block) {
+  parse({-7, low(BIG_LONG), high(BIG_LONG), DOUBLE_2_5_LOW, DOUBLE_2_5_HIGH});
+
+  int64_t count = 0;
+  int64_t total = 0;
+  double avg = 0;
+  if (rpc_check_fetch_len(5)) {
+    t_Int().typed_fetch_unchecked_to(count);
+    t_Long().typed_fetch_unchecked_to(total);
+    t_Double().typed_fetch_unchecked_to(avg);
+  }
+
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_EQ(count, -7);
+  ASSERT_EQ(total, BIG_LONG);
+  ASSERT_EQ(avg, 2.5);
+}
+
+TEST_F(rpc_fetch_test, test_truncated_fixed_fetch_block) {
+  parse({-7, low(BIG_LONG), high(BIG_LONG), DOUBLE_2_5_LOW});
+
+  int64_t count = 0;
+  if (rpc_check_fetch_len(5)) {
+    t_Int().typed_fetch_unchecked_to(count);
+  }
+
+  // nothing is fetched from the truncated block
+  expect_not_enough_data();
+  ASSERT_EQ(count, 0);
+  ASSERT_EQ(rpc_get_pos(), 0);
+
+  // and the next block isn't fetched after the error
+  ASSERT_FALSE(rpc_check_fetch_len(1));
+}
+
+TEST_F(rpc_fetch_test, test_vector_int) {
+  parse({4, 1, -2, 3, std::numeric_limits<int32_t>::max()});
+
+  array<int64_t> result;
+  t_Vector<t_Int, 0>(t_Int()).typed_fetch_to(result);
+
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_TRUE(result.is_vector());
+  ASSERT_EQ(result.count(), 4);
+  ASSERT_EQ(result.get_value(0), 1);
+  ASSERT_EQ(result.get_value(1), -2);
+  ASSERT_EQ(result.get_value(2), 3);
+  ASSERT_EQ(result.get_value(3), std::numeric_limits<int32_t>::max());
+}
+
+TEST_F(rpc_fetch_test, test_vector_long) {
+  parse({3, low(BIG_LONG), high(BIG_LONG), low(-BIG_LONG), high(-BIG_LONG), 0, 0});
+
+  array<int64_t> result;
+  t_Vector<t_Long, 0>(t_Long()).typed_fetch_to(result);
+
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_TRUE(result.is_vector());
+  ASSERT_EQ(result.count(), 3);
+  ASSERT_EQ(result.get_value(0), BIG_LONG);
+  ASSERT_EQ(result.get_value(1), -BIG_LONG);
+  ASSERT_EQ(result.get_value(2), 0);
+}
+
+TEST_F(rpc_fetch_test, test_empty_vectors) {
+  parse({0, 0});
+
+  array<int64_t> ints;
+  array<int64_t> longs;
+  t_Vector<t_Int, 0>(t_Int()).typed_fetch_to(ints);
+  t_Vector<t_Long, 0>(t_Long()).typed_fetch_to(longs);
+
+  ASSERT_TRUE(CurException.is_null());
+  ASSERT_TRUE(f$fetch_eof());
+  ASSERT_TRUE(ints.empty());
+  ASSERT_TRUE(longs.empty());
+}
+
+TEST_F(rpc_fetch_test, test_truncated_vector_int) {
+  parse({3, 1, 2});
+
+  array<int64_t> result;
+  t_Vector<t_Int, 0>(t_Int()).typed_fetch_to(result);
+
+  expect_not_enough_data();
+  ASSERT_TRUE(result.empty());
+  // only the size is fetched
+  ASSERT_EQ(rpc_get_pos(), 1);
+}
+
+TEST_F(rpc_fetch_test, test_truncated_vector_long) {
+  // the last long is cut in half
+  parse({2, low(BIG_LONG), high(BIG_LONG), low(BIG_LONG)});
+
+  array<int64_t> result;
+  t_Vector<t_Long, 0>(t_Long()).typed_fetch_to(result);
+
+  expect_not_enough_data();
+  ASSERT_TRUE(result.empty());
+  ASSERT_EQ(rpc_get_pos(), 1);
+}
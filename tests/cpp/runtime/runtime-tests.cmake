@@ -1,17 +1,26 @@
 prepend(RUNTIME_TESTS_SOURCES ${BASE_DIR}/tests/cpp/runtime/
+        _runtime-linkage-stubs.cpp
         _runtime-tests-env.cpp
+        aho-corasick-test.cpp
         allocator-malloc-replacement-test.cpp
         array-test.cpp
         common-php-functions-test.cpp
         confdata-functions-test.cpp
         confdata-key-maker-test.cpp
         confdata-predefined-wildcards-test.cpp
+        http-compression-test.cpp
+        instance-cache-test.cpp
+        instance-json-test.cpp
+        inter-process-epoch-test.cpp
         inter-process-mutex-test.cpp
         inter-process-resource-test.cpp
         memory_resource/details/memory_chunk_list-test.cpp
         memory_resource/details/memory_chunk_tree-test.cpp
         memory_resource/details/memory_ordered_chunk_list-test.cpp
+        memory_resource/persistent_map-test.cpp
         memory_resource/unsynchronized_pool_resource-test.cpp
+        regexp-cache-test.cpp
+        rpc-fetch-test.cpp
         string-test.cpp)
 
 vk_add_unittest(runtime "${RUNTIME_LIBS};${RUNTIME_LINK_TEST_LIBS}" ${RUNTIME_TESTS_SOURCES})
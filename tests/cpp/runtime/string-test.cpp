@@ -65,6 +65,45 @@ TEST(string_test, test_copy_and_make_not_shared) {
   ASSERT_EQ(str3.get_reference_counter(), 1);
 }
 
+TEST(string_test, test_cached_hash) {
+  string str{"hello world"};
+  const int64_t hello_world_hash = string_hash("hello world", 11);
+  ASSERT_EQ(str.hash(), hello_world_hash);
+  ASSERT_EQ(str.hash(), hello_world_hash);
+
+  const string str_copy = str;
+  ASSERT_EQ(str_copy.hash(), hello_world_hash);
+
+  str.append("!");
+  ASSERT_EQ(str.hash(), string_hash("hello world!", 12));
+  ASSERT_EQ(str_copy.hash(), hello_world_hash);
+
+  str.make_not_shared();
+  str[0] = 'H';
+  ASSERT_EQ(str.hash(), string_hash("Hello world!", 12));
+
+  str.buffer()[1] = 'E';
+  ASSERT_EQ(str.hash(), string_hash("HEllo world!", 12));
+
+  str.shrink(5);
+  ASSERT_EQ(str.hash(), string_hash("HEllo", 5));
+
+  str.reserve_at_least(16).append_unsafe(int64_t{-12345}).finish_append();
+  ASSERT_EQ(str.hash(), string_hash("HEllo-12345", 11));
+}
+
+TEST(string_test, test_precomputed_hash_of_const_string) {
+  char mem[1024];
+
+  auto s = string::make_const_string_on_memory("hello", 5, mem, sizeof(mem));
+  ASSERT_EQ(s.hash(), string_hash("hello", 5));
+
+  string str{"hello world"};
+  str.set_reference_counter_to(ExtraRefCnt::for_instance_cache);
+  ASSERT_EQ(str.hash(), string_hash("hello world", 11));
+  str.force_destroy(ExtraRefCnt::for_instance_cache);
+}
+
 TEST(string_test, test_hex_to_int) {
   for (size_t c = 0; c != 256; ++c) {
     if (vk::none_of_equal(c,
@@ -0,0 +1,125 @@
+#!/usr/bin/python3
+import argparse
+import json
+import os
+import sys
+import tempfile
+
+from python.lib.colors import red, green
+from python.lib.kphp_builder import KphpBuilder
+from python.lib.kphp_server import KphpServer
+from python.lib.load_replay import load_recording, run_load, format_report
+from python.lib.port_generator import get_port
+from python.lib.stub_backends import StubBackends
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Replays recorded http and rpc requests against a kphp server and reports "
+                    "rps, latency percentiles, workers utilization and memory. "
+                    "The server is either compiled from --php-script, started from --server-bin, "
+                    "or is already running and is reached by --http-port and --rpc-port. "
+                    "Stub memcache and rpc backends are started locally, their ports are passed to the started server "
+                    "with ini options 'load_replay.memcache_port' and 'load_replay.rpc_port'.")
+    parser.add_argument("requests", help="file with the recorded requests, a json object on each line")
+
+    server = parser.add_argument_group("server")
+    server.add_argument("--php-script", help="php script, which is compiled and started as the server")
+    server.add_argument("--server-bin", help="compiled kphp server, which is started")
+    server.add_argument("--workers-num", type=int, default=os.cpu_count(),
+                        help="workers number of the started server (default: cpu count)")
+    server.add_argument("--server-option", action="append", default=[], metavar="OPTION[=VALUE]",
+                        help="extra option of the started server, e.g. --server-option=--hard-memory-limit=256m")
+    server.add_argument("--working-dir", help="working directory of the compilation and the started server "
+                                              "(default: a temporary directory)")
+    server.add_argument("--host", default="127.0.0.1", help="host of the running server (default: 127.0.0.1)")
+    server.add_argument("--http-port", type=int, help="http port of the running server")
+    server.add_argument("--rpc-port", type=int, help="rpc port of the running server")
+    server.add_argument("--master-pid", type=int, help="master pid of the running server for the workers monitoring")
+
+    load = parser.add_argument_group("load")
+    load.add_argument("-c", "--concurrency", type=int, default=16,
+                      help="number of concurrent http and rpc clients (default: 16)")
+    load.add_argument("-d", "--duration", type=float, default=10.0,
+                      help="load duration in seconds, 0 means unlimited (default: 10)")
+    load.add_argument("-n", "--requests-count", type=int,
+                      help="stop after this number of http and rpc requests each")
+    load.add_argument("--warmup", type=float, default=1.0,
+                      help="warmup duration in seconds, which isn't included in the report (default: 1)")
+    load.add_argument("--no-keep-alive", action="store_true", help="open a new connection for each request")
+    load.add_argument("--json-report", help="write the report as json into the file")
+    return parser.parse_args()
+
+
+def start_server(args, working_dir, stubs):
+    server_bin = args.server_bin
+    if args.php_script:
+        builder = KphpBuilder(args.php_script, os.path.join(working_dir, "artifacts"), working_dir)
+        print("Compiling {}".format(args.php_script))
+        if not builder.compile_with_kphp():
+            artifact = builder.kphp_build_stderr_artifact
+            print(red("Can't compile {}{}".format(args.php_script, ", see " + artifact.file if artifact else "")))
+            sys.exit(1)
+        server_bin = builder.kphp_runtime_bin
+
+    ini_file = os.path.join(working_dir, "load_replay.ini")
+    with open(ini_file, "w") as f:
+        f.write("load_replay.memcache_port={}\n".format(stubs.memcache_port))
+        f.write("load_replay.rpc_port={}\n".format(stubs.rpc_port))
+
+    options = {"--workers-num": args.workers_num, "--define-from-config": ini_file}
+    for option in args.server_option:
+        name, eq, value = option.partition("=")
+        options[name] = value if eq else True
+    server = KphpServer(server_bin, working_dir, options=options)
+    server.start()
+    return server
+
+
+def main():
+    args = parse_args()
+    if not args.php_script and not args.server_bin and not args.http_port and not args.rpc_port:
+        print(red("One of --php-script, --server-bin, --http-port or --rpc-port is required"))
+        sys.exit(1)
+
+    http_requests, rpc_requests = load_recording(args.requests)
+    print("Loaded {} http and {} rpc requests from {}".format(len(http_requests), len(rpc_requests), args.requests))
+
+    working_dir = args.working_dir or tempfile.mkdtemp(prefix="kphp_load_replay_")
+    os.makedirs(working_dir, exist_ok=True)
+    stubs = StubBackends(get_port(), get_port())
+    stubs.start()
+    server = None
+    host, http_port, rpc_port, master_pid = args.host, args.http_port, args.rpc_port, args.master_pid
+    try:
+        if args.php_script or args.server_bin:
+            server = start_server(args, working_dir, stubs)
+            host, http_port, rpc_port, master_pid = "127.0.0.1", server.http_port, server.rpc_port, server.master_pid
+        if not http_port:
+            http_requests = []
+        if not rpc_port:
+            rpc_requests = []
+
+        keep_alive = not args.no_keep_alive
+        if args.warmup > 0:
+            run_load(host, http_port, rpc_port, http_requests, rpc_requests,
+                     concurrency=args.concurrency, duration=args.warmup, keep_alive=keep_alive)
+        report = run_load(host, http_port, rpc_port, http_requests, rpc_requests,
+                          concurrency=args.concurrency, duration=args.duration or None,
+                          requests_count=args.requests_count, keep_alive=keep_alive, master_pid=master_pid)
+        report["stub_backends"] = {"memcache_queries": stubs.memcache.queries, "rpc_queries": stubs.rpc.queries}
+    finally:
+        if server:
+            server.stop()
+        stubs.stop()
+
+    print(green(format_report(report)))
+    print("stub backends: {} memcache and {} rpc queries".format(
+        report["stub_backends"]["memcache_queries"], report["stub_backends"]["rpc_queries"]))
+    if args.json_report:
+        with open(args.json_report, "w") as f:
+            json.dump(report, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,12 @@
+@kphp_should_fail
+/You may not decode interface or abstract class from json I/
+<?php
+interface I {}
+class A implements I {
+  public $x = 1;
+}
+function demo() {
+  $a = instance_from_json('{"x":2}', I::class);
+  var_dump($a !== null);
+}
+demo();
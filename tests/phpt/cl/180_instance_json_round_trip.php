@@ -0,0 +1,108 @@
+@ok
+<?php
+require_once 'kphp_tester_include.php';
+
+#ifndef KPHP
+echo <<<'EXPECTED'
+{"x":1,"y":1.5}
+{"name":"home","active":true,"limit":null,"timeout":false,"tags":["a","b"],"weights":{"a":1,"b":2},"start":{"x":1,"y":1.5},"points":[{"x":1,"y":1.5},{"x":2,"y":-0.5}]}
+round trip: 1
+name=home active=1 limit=null timeout=false tags=a,b weights=a:1,b:2 start=1:1.5 points=1:1.5,2:-0.5
+{"name":"","active":false,"limit":5,"timeout":10,"tags":[],"weights":[],"start":null,"points":[]}
+name=route active=0 limit=null timeout=3 tags= weights= start=null points= comment=extended
+
+EXPECTED;
+return;
+#endif
+
+class Point {
+  /** @var int */
+  public $x = 0;
+  /** @var float */
+  public $y = 0.0;
+
+  public function __construct(int $x = 0, float $y = 0.0) {
+    $this->x = $x;
+    $this->y = $y;
+  }
+}
+
+class Route {
+  /** @var string */
+  public $name = "";
+  /** @var bool */
+  public $active = false;
+  /** @var ?int */
+  public $limit = null;
+  /** @var int|false */
+  public $timeout = false;
+  /** @var string[] */
+  public $tags = [];
+  /** @var int[] */
+  public $weights = [];
+  /** @var ?Point */
+  public $start = null;
+  /** @var Point[] */
+  public $points = [];
+}
+
+class ExtendedRoute extends Route {
+  /** @var string */
+  public $comment = "";
+}
+
+function describe_point(?Point $p): string {
+  return $p === null ? "null" : "{$p->x}:{$p->y}";
+}
+
+function describe_route(Route $r): string {
+  $weights = [];
+  foreach ($r->weights as $key => $weight) {
+    $weights[] = "$key:$weight";
+  }
+  $points = [];
+  foreach ($r->points as $point) {
+    $points[] = describe_point($point);
+  }
+  return "name={$r->name} active=" . (int)$r->active .
+    " limit=" . ($r->limit === null ? "null" : (string)$r->limit) .
+    " timeout=" . ($r->timeout === false ? "false" : (string)$r->timeout) .
+    " tags=" . implode(",", $r->tags) .
+    " weights=" . implode(",", $weights) .
+    " start=" . describe_point($r->start) .
+    " points=" . implode(",", $points);
+}
+
+function test_round_trip() {
+  echo instance_to_json(new Point(1, 1.5)), "\n";
+
+  $route = new Route;
+  $route->name = "home";
+  $route->active = true;
+  $route->tags = ["a", "b"];
+  $route->weights = ["a" => 1, "b" => 2];
+  $route->start = new Point(1, 1.5);
+  $route->points = [new Point(1, 1.5), new Point(2, -0.5)];
+
+  $json = instance_to_json($route);
+  echo $json, "\n";
+
+  $decoded = instance_from_json($json, Route::class);
+  echo "round trip: ", (int)(instance_to_json($decoded) === $json), "\n";
+  echo describe_route($decoded), "\n";
+}
+
+function test_missing_and_unknown_fields() {
+  // the missing fields keep their default values, the unknown ones are skipped
+  $decoded = instance_from_json(' { "timeout" : 10, "unknown": {"points": [1, 2]}, "limit": 5 } ', Route::class);
+  echo instance_to_json($decoded), "\n";
+}
+
+function test_inherited_fields() {
+  $decoded = instance_from_json('{"comment":"extended","name":"route","timeout":3}', ExtendedRoute::class);
+  echo describe_route($decoded), " comment={$decoded->comment}\n";
+}
+
+test_round_trip();
+test_missing_and_unknown_fields();
+test_inherited_fields();
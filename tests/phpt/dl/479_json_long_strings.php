@@ -0,0 +1,32 @@
+@ok
+<?php
+
+function test_json_long_strings() {
+  $plain = str_repeat("abcdefghijklmnopqrstuvwxyz0123456789", 5);
+  $strings = [
+    "",
+    $plain,
+    $plain . "\"",
+    "\\" . $plain,
+    $plain . "/" . $plain . "\n" . $plain . "\t",
+    str_repeat("x\"", 40),
+    str_repeat("0123456789abcde\\", 10),
+    $plain . "привет" . $plain . "日本語" . $plain,
+    str_repeat("\x01", 20) . $plain . "\x1f",
+  ];
+  foreach ($strings as $s) {
+    foreach ([0, JSON_UNESCAPED_UNICODE] as $options) {
+      $encoded = json_encode($s, $options);
+      var_dump($encoded);
+      var_dump(json_decode($encoded) === $s);
+    }
+    var_dump(json_decode(json_encode([$s, [$s => $s]])));
+  }
+
+  var_dump(json_decode("\"" . $plain . "\\u0041\\u0444\\ud83d\\ude00" . $plain . "\""));
+  var_dump(json_decode("\"" . $plain . "\\\""));
+  var_dump(json_decode("\"" . $plain . "\\"));
+  var_dump(json_decode("\"" . $plain));
+}
+
+test_json_long_strings();
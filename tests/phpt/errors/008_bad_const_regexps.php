@@ -0,0 +1,17 @@
+@kphp_should_fail
+/Wrong start delimiter in regular expression "abc"/
+/No ending matching delimiter '#' found in regexp: #abc/
+/Unknown modifier 'k' found in regexp \/abc\/k/
+/Regexp \/\(\?<name\/ compilation failed/
+/contains not UTF-8 symbols/
+<?php
+
+function test_bad_regexps($subject) {
+  var_dump(preg_match('abc', $subject));
+  var_dump(preg_match('#abc', $subject));
+  var_dump(preg_replace('/abc/k', '', $subject));
+  var_dump(preg_split('/(?<name/', $subject));
+  var_dump(preg_match("/abc\xff/u", $subject));
+}
+
+test_bad_regexps("abc");
@@ -53,6 +53,20 @@ class KphpServer(Engine):
                 f.write(str(tag))
         self.update_options({"--error-tag": error_tag_file})
 
+    @property
+    def http_port(self):
+        """
+        :return: http port listened by workers
+        """
+        return self._http_port
+
+    @property
+    def master_pid(self):
+        """
+        :return: pid of the master process
+        """
+        return self._engine_process.pid
+
     @property
     def master_port(self):
         """
@@ -0,0 +1,345 @@
+import asyncio
+import base64
+import json
+import time
+
+import psutil
+
+from .tcp_rpc import open_tcp_rpc_connection
+
+
+class HttpReplayRequest:
+    def __init__(self, method="GET", uri="/", headers=None, body=b""):
+        self.method = method
+        self.uri = uri
+        self.headers = headers or {}
+        self.body = body
+
+    def serialize(self, host, keep_alive):
+        lines = ["{} {} HTTP/1.1".format(self.method, self.uri), "Host: {}".format(host)]
+        for name, value in self.headers.items():
+            if name.lower() not in ("host", "connection", "content-length"):
+                lines.append("{}: {}".format(name, value))
+        if self.body or self.method in ("POST", "PUT"):
+            lines.append("Content-Length: {}".format(len(self.body)))
+        lines.append("Connection: {}".format("keep-alive" if keep_alive else "close"))
+        return ("\r\n".join(lines) + "\r\n\r\n").encode() + self.body
+
+
+class RpcReplayRequest:
+    def __init__(self, body):
+        """
+        :param body: serialized TL query without the rpcInvokeReq header
+        """
+        self.body = body
+
+
+def load_recording(path):
+    """
+    Read the recorded requests, the file contains a json object on each line:
+        {"type": "http", "method": "POST", "uri": "/", "headers": {...}, "body": "..."} or "body_base64": "..."
+        {"type": "rpc", "body_hex": "..."}
+    :return: tuple of the http and the rpc request lists
+    """
+    http_requests = []
+    rpc_requests = []
+    with open(path) as f:
+        for line_num, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            record = json.loads(line)
+            request_type = record.get("type", "http")
+            if request_type == "http":
+                if "body_base64" in record:
+                    body = base64.b64decode(record["body_base64"])
+                else:
+                    body = record.get("body", "").encode()
+                http_requests.append(HttpReplayRequest(
+                    record.get("method", "GET"), record.get("uri", "/"), record.get("headers"), body))
+            elif request_type == "rpc":
+                rpc_requests.append(RpcReplayRequest(bytes.fromhex(record["body_hex"])))
+            else:
+                raise RuntimeError("Unknown request type '{}' at line {} of {}".format(request_type, line_num, path))
+    return http_requests, rpc_requests
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    rank = max(int(round(p / 100.0 * len(sorted_values) + 0.5)) - 1, 0)
+    return sorted_values[min(rank, len(sorted_values) - 1)]
+
+
+class LoadStats:
+    def __init__(self):
+        self.latencies = []
+        self.errors = 0
+        self.connections = 0
+        self.statuses = {}
+
+    def add(self, latency, status):
+        self.latencies.append(latency)
+        self.statuses[status] = self.statuses.get(status, 0) + 1
+
+    def summary(self, elapsed):
+        latencies = sorted(self.latencies)
+        return {
+            "requests": len(latencies),
+            "errors": self.errors,
+            "connections": self.connections,
+            "rps": len(latencies) / elapsed if elapsed > 0 else 0.0,
+            "statuses": {str(status): count for status, count in sorted(self.statuses.items())},
+            "latency_ms": {
+                "p50": percentile(latencies, 50) * 1000,
+                "p99": percentile(latencies, 99) * 1000,
+                "p999": percentile(latencies, 99.9) * 1000,
+                "max": (latencies[-1] if latencies else 0.0) * 1000,
+            }
+        }
+
+
+class _RequestFeed:
+    """
+    Cycles over the recorded requests until the deadline or the requests limit is reached
+    """
+
+    def __init__(self, requests, deadline, requests_limit):
+        self._requests = requests
+        self._deadline = deadline
+        self._left = requests_limit
+        self._next = 0
+
+    def next(self):
+        if not self._requests or time.monotonic() >= self._deadline or self._left == 0:
+            return None
+        if self._left is not None:
+            self._left -= 1
+        request = self._requests[self._next]
+        self._next = (self._next + 1) % len(self._requests)
+        return request
+
+
+async def _read_http_response(reader):
+    """
+    :return: tuple of the status code, the body and the flag that the connection can be reused
+    """
+    head = await reader.readuntil(b"\r\n\r\n")
+    status_line, *header_lines = head.decode("latin-1").split("\r\n")
+    version, status = status_line.split(" ", 2)[:2]
+    headers = {}
+    for header_line in filter(None, header_lines):
+        name, _, value = header_line.partition(":")
+        headers[name.strip().lower()] = value.strip()
+
+    reusable = version == "HTTP/1.1" and headers.get("connection", "").lower() != "close"
+    if headers.get("transfer-encoding", "").lower() == "chunked":
+        chunks = []
+        while True:
+            size = int((await reader.readuntil(b"\r\n")).split(b";")[0], 16)
+            chunks.append(await reader.readexactly(size + 2))
+            if size == 0:
+                break
+        body = b"".join(chunk[:-2] for chunk in chunks)
+    elif "content-length" in headers:
+        body = await reader.readexactly(int(headers["content-length"]))
+    else:
+        body = await reader.read()
+        reusable = False
+    return int(status), body, reusable
+
+
+async def _http_client(host, port, feed, keep_alive, stats):
+    reader = writer = None
+    while True:
+        request = feed.next()
+        if request is None:
+            break
+        started = time.monotonic()
+        try:
+            if writer is None:
+                reader, writer = await asyncio.open_connection(host, port)
+                stats.connections += 1
+            writer.write(request.serialize(host, keep_alive))
+            await writer.drain()
+            status, _, reusable = await _read_http_response(reader)
+            stats.add(time.monotonic() - started, status)
+        except (ConnectionError, asyncio.IncompleteReadError, asyncio.LimitOverrunError, ValueError):
+            stats.errors += 1
+            reusable = False
+        if not (keep_alive and reusable) and writer is not None:
+            writer.close()
+            reader = writer = None
+    if writer is not None:
+        writer.close()
+
+
+async def _rpc_client(host, port, feed, keep_alive, stats):
+    connection = None
+    query_id = 0
+    while True:
+        request = feed.next()
+        if request is None:
+            break
+        started = time.monotonic()
+        try:
+            if connection is None:
+                connection = await open_tcp_rpc_connection(host, port)
+                stats.connections += 1
+            query_id += 1
+            connection.send_query(query_id, request.body)
+            await connection.drain()
+            answer_id, is_error, _ = await connection.read_answer()
+            if answer_id != query_id:
+                raise RuntimeError("Got answer for unexpected query {}".format(answer_id))
+            stats.add(time.monotonic() - started, "rpc_error" if is_error else "rpc_ok")
+        except (ConnectionError, asyncio.IncompleteReadError, RuntimeError):
+            stats.errors += 1
+            if connection is not None:
+                connection.close()
+                connection = None
+        if not keep_alive and connection is not None:
+            connection.close()
+            connection = None
+    if connection is not None:
+        connection.close()
+
+
+class WorkersMonitor:
+    """
+    Samples cpu time and memory of the master process children (the workers) while the load is running
+    """
+
+    def __init__(self, master_pid, interval=0.5):
+        self._master = psutil.Process(master_pid) if master_pid else None
+        self._interval = interval
+        self._cpu_start = {}
+        self._cpu_last = {}
+        self._rss_max = 0
+        self._uss_max = 0
+        self._rss_samples = []
+
+    def _workers(self):
+        try:
+            return self._master.children()
+        except psutil.Error:
+            return []
+
+    def _sample(self):
+        rss = uss = 0
+        for worker in self._workers():
+            try:
+                with worker.oneshot():
+                    cpu = worker.cpu_times()
+                    self._cpu_last[worker.pid] = cpu.user + cpu.system
+                    self._cpu_start.setdefault(worker.pid, self._cpu_last[worker.pid])
+                    try:
+                        memory = worker.memory_full_info()
+                        uss += memory.uss
+                    except psutil.AccessDenied:
+                        memory = worker.memory_info()
+                    rss += memory.rss
+            except psutil.Error:
+                continue
+        self._rss_max = max(self._rss_max, rss)
+        self._uss_max = max(self._uss_max, uss)
+        self._rss_samples.append(rss)
+
+    async def run(self, stop_event):
+        if not self._master:
+            return
+        while not stop_event.is_set():
+            self._sample()
+            try:
+                await asyncio.wait_for(stop_event.wait(), self._interval)
+            except asyncio.TimeoutError:
+                pass
+        self._sample()
+
+    def summary(self, elapsed):
+        if not self._master:
+            return None
+        workers = len(self._cpu_last)
+        cpu_used = sum(self._cpu_last[pid] - self._cpu_start[pid] for pid in self._cpu_last)
+        return {
+            "workers": workers,
+            # the share of the time the workers were busy, 1.0 means every worker was on cpu all the time
+            "utilization": cpu_used / (elapsed * workers) if elapsed > 0 and workers else 0.0,
+            "rss_max_mb": self._rss_max / (1 << 20),
+            "uss_max_mb": self._uss_max / (1 << 20),
+            "rss_avg_mb": sum(self._rss_samples) / len(self._rss_samples) / (1 << 20) if self._rss_samples else 0.0,
+        }
+
+
+async def _run_load(host, http_port, rpc_port, http_requests, rpc_requests,
+                    concurrency, duration, requests_count, keep_alive, master_pid):
+    deadline = time.monotonic() + duration if duration else float("inf")
+    http_stats = LoadStats()
+    rpc_stats = LoadStats()
+    http_feed = _RequestFeed(http_requests, deadline, requests_count)
+    rpc_feed = _RequestFeed(rpc_requests, deadline, requests_count)
+
+    clients = []
+    if http_requests:
+        clients += [_http_client(host, http_port, http_feed, keep_alive, http_stats) for _ in range(concurrency)]
+    if rpc_requests:
+        clients += [_rpc_client(host, rpc_port, rpc_feed, keep_alive, rpc_stats) for _ in range(concurrency)]
+
+    monitor = WorkersMonitor(master_pid)
+    stop_monitor = asyncio.Event()
+    monitor_task = asyncio.ensure_future(monitor.run(stop_monitor))
+    started = time.monotonic()
+    await asyncio.gather(*clients)
+    elapsed = time.monotonic() - started
+    stop_monitor.set()
+    await monitor_task
+
+    report = {"elapsed_sec": elapsed, "concurrency": concurrency, "keep_alive": keep_alive}
+    if http_requests:
+        report["http"] = http_stats.summary(elapsed)
+    if rpc_requests:
+        report["rpc"] = rpc_stats.summary(elapsed)
+    workers = monitor.summary(elapsed)
+    if workers:
+        report["workers"] = workers
+    return report
+
+
+def run_load(host, http_port, rpc_port, http_requests, rpc_requests,
+             concurrency=16, duration=10.0, requests_count=None, keep_alive=True, master_pid=None):
+    """
+    Replay the requests against the server with the closed loop model:
+    every of the concurrency clients for http and rpc sends the next request right after the previous answer
+    :param duration: the load time limit in seconds, None means unlimited
+    :param requests_count: the limit of http and rpc requests (each), None means unlimited
+    :param keep_alive: reuse the connections, otherwise a new connection is opened for each request
+    :param master_pid: pid of the server master process, its children are monitored as the workers
+    :return: report dict
+    """
+    loop = asyncio.new_event_loop()
+    try:
+        return loop.run_until_complete(_run_load(host, http_port, rpc_port, http_requests, rpc_requests,
+                                                 concurrency, duration, requests_count, keep_alive, master_pid))
+    finally:
+        loop.close()
+
+
+def format_report(report):
+    lines = ["elapsed {:.2f}s, concurrency {}, keep-alive {}".format(
+        report["elapsed_sec"], report["concurrency"], "on" if report["keep_alive"] else "off")]
+    for kind in ("http", "rpc"):
+        stats = report.get(kind)
+        if not stats:
+            continue
+        latency = stats["latency_ms"]
+        lines.append("{}: {} requests, {} errors, {} connections, {:.1f} rps".format(
+            kind, stats["requests"], stats["errors"], stats["connections"], stats["rps"]))
+        lines.append("  latency ms: p50 {:.2f}, p99 {:.2f}, p999 {:.2f}, max {:.2f}".format(
+            latency["p50"], latency["p99"], latency["p999"], latency["max"]))
+        lines.append("  statuses: " + ", ".join("{}: {}".format(k, v) for k, v in stats["statuses"].items()))
+    workers = report.get("workers")
+    if workers:
+        lines.append("workers: {}, utilization {:.1f}%, rss max {:.1f}MB (avg {:.1f}MB), uss max {:.1f}MB".format(
+            workers["workers"], workers["utilization"] * 100, workers["rss_max_mb"], workers["rss_avg_mb"],
+            workers["uss_max_mb"]))
+    return "\n".join(lines)
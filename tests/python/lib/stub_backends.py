@@ -0,0 +1,146 @@
+import asyncio
+import struct
+import threading
+
+from .tcp_rpc import TcpRpcConnection, TL_BOOL_TRUE, TL_RPC_DEST_ACTOR, TL_RPC_DEST_ACTOR_FLAGS, TL_RPC_DEST_FLAGS, \
+    TL_RPC_INVOKE_REQ, TL_RPC_PING, TL_RPC_PONG, TL_RPC_REQ_RESULT
+
+
+class StubMemcache:
+    """
+    In-memory memcache, which speaks the text protocol: get, set, add, replace, delete, incr, decr
+    """
+
+    def __init__(self):
+        self._data = {}
+        self.queries = 0
+
+    async def handle(self, reader, writer):
+        try:
+            while True:
+                line = await reader.readline()
+                if not line:
+                    break
+                self.queries += 1
+                writer.write(await self._execute(line.split(), reader))
+                await writer.drain()
+        except (ConnectionError, asyncio.IncompleteReadError):
+            pass
+        finally:
+            writer.close()
+
+    async def _execute(self, args, reader):
+        if not args:
+            return b"ERROR\r\n"
+        command = args[0]
+        if command in (b"get", b"gets"):
+            response = []
+            for key in args[1:]:
+                if key in self._data:
+                    flags, value = self._data[key]
+                    response.append(b"VALUE %s %d %d\r\n%s\r\n" % (key, flags, len(value), value))
+            response.append(b"END\r\n")
+            return b"".join(response)
+        if command in (b"set", b"add", b"replace") and len(args) >= 5:
+            value = (await reader.readexactly(int(args[4]) + 2))[:-2]
+            exists = args[1] in self._data
+            if (command == b"add" and exists) or (command == b"replace" and not exists):
+                return b"NOT_STORED\r\n"
+            self._data[args[1]] = (int(args[2]), value)
+            return b"STORED\r\n"
+        if command == b"delete" and len(args) >= 2:
+            return b"DELETED\r\n" if self._data.pop(args[1], None) else b"NOT_FOUND\r\n"
+        if command in (b"incr", b"decr") and len(args) >= 3:
+            if args[1] not in self._data:
+                return b"NOT_FOUND\r\n"
+            flags, value = self._data[args[1]]
+            delta = int(args[2]) if command == b"incr" else -int(args[2])
+            value = str(max(int(value or b"0") + delta, 0)).encode()
+            self._data[args[1]] = (flags, value)
+            return value + b"\r\n"
+        if command == b"version":
+            return b"VERSION stub\r\n"
+        return b"ERROR\r\n"
+
+
+class StubRpcServer:
+    """
+    Answers every rpc query with the result configured for its TL function, or with boolTrue
+    """
+
+    def __init__(self, results=None):
+        """
+        :param results: dict of TL function magic to the serialized result
+        """
+        self._results = results or {}
+        self.queries = 0
+
+    async def handle(self, reader, writer):
+        connection = TcpRpcConnection(reader, writer)
+        try:
+            await connection.server_handshake()
+            while True:
+                _, payload = await connection.read_packet()
+                packet_type = struct.unpack_from("<I", payload)[0]
+                if packet_type == TL_RPC_PING:
+                    connection.send_packet(struct.pack("<I", TL_RPC_PONG) + payload[4:12])
+                elif packet_type == TL_RPC_INVOKE_REQ:
+                    self.queries += 1
+                    query_id = payload[4:12]
+                    function_magic = self._find_function_magic(payload[12:])
+                    result = self._results.get(function_magic, struct.pack("<I", TL_BOOL_TRUE))
+                    connection.send_packet(struct.pack("<I", TL_RPC_REQ_RESULT) + query_id + result)
+                await connection.drain()
+        except (ConnectionError, asyncio.IncompleteReadError, RuntimeError):
+            pass
+        finally:
+            connection.close()
+
+    @staticmethod
+    def _find_function_magic(body):
+        # the query may be wrapped into rpcDestActor, and into rpcDestFlags or rpcDestActorFlags without extra fields
+        offset = 0
+        while offset + 4 <= len(body):
+            magic = struct.unpack_from("<I", body, offset)[0]
+            if magic == TL_RPC_DEST_ACTOR:
+                offset += 12
+            elif magic == TL_RPC_DEST_FLAGS and struct.unpack_from("<i", body, offset + 4)[0] == 0:
+                offset += 8
+            elif magic == TL_RPC_DEST_ACTOR_FLAGS and struct.unpack_from("<i", body, offset + 12)[0] == 0:
+                offset += 16
+            else:
+                return magic
+        return 0
+
+
+async def start_stub_server(handler, port, host="127.0.0.1"):
+    return await asyncio.start_server(handler, host, port)
+
+
+class StubBackends:
+    """
+    Stub memcache and rpc servers, which are served by the own event loop in a background thread,
+    so they don't compete with the load generator
+    """
+
+    def __init__(self, memcache_port, rpc_port, rpc_results=None):
+        self.memcache_port = memcache_port
+        self.rpc_port = rpc_port
+        self.memcache = StubMemcache()
+        self.rpc = StubRpcServer(rpc_results)
+        self._loop = asyncio.new_event_loop()
+        self._servers = []
+        self._thread = threading.Thread(target=self._loop.run_forever, daemon=True)
+
+    def start(self):
+        for handler, port in ((self.memcache.handle, self.memcache_port), (self.rpc.handle, self.rpc_port)):
+            self._servers.append(self._loop.run_until_complete(start_stub_server(handler, port)))
+        self._thread.start()
+
+    def stop(self):
+        if not self._thread.is_alive():
+            return
+        for server in self._servers:
+            self._loop.call_soon_threadsafe(server.close)
+        self._loop.call_soon_threadsafe(self._loop.stop)
+        self._thread.join()
@@ -0,0 +1,117 @@
+import asyncio
+import os
+import struct
+import time
+import zlib
+
+RPC_NONCE = 0x7acb87aa
+RPC_HANDSHAKE = 0x7682eef5
+RPC_HANDSHAKE_ERROR = 0x6a27beda
+TL_RPC_INVOKE_REQ = 0x2374df3d
+TL_RPC_REQ_RESULT = 0x63aeda4e
+TL_RPC_REQ_ERROR = 0x7ae432f5
+TL_RPC_PING = 0x5730a2df
+TL_RPC_PONG = 0x8430eaa7
+TL_BOOL_TRUE = 0x997275b5
+TL_RPC_DEST_ACTOR = 0x7568aabd
+TL_RPC_DEST_ACTOR_FLAGS = 0xf0a5acf7
+TL_RPC_DEST_FLAGS = 0xe352035e
+
+_LOCALHOST_IP = 0x7f000001
+
+
+def _pack_pid(port):
+    # struct process_id: ip, port, pid, utime
+    return struct.pack("<IHHI", _LOCALHOST_IP, port & 0xffff, os.getpid() & 0x7fff, int(time.time()))
+
+
+def _unpack_int(data, offset=0):
+    return struct.unpack_from("<I", data, offset)[0]
+
+
+class TcpRpcConnection:
+    """
+    Unencrypted tcp rpc connection with crc32 checksums, it can be either a client or a server side
+    Every packet is [length][packet num][payload][crc32], the nonce and handshake packets have the numbers -2 and -1
+    """
+
+    def __init__(self, reader, writer):
+        self._reader = reader
+        self._writer = writer
+        self._out_packet_num = -2
+
+    def send_packet(self, payload):
+        head = struct.pack("<ii", len(payload) + 12, self._out_packet_num)
+        crc = zlib.crc32(head + payload) & 0xffffffff
+        self._writer.write(head + payload + struct.pack("<I", crc))
+        self._out_packet_num += 1
+
+    async def read_packet(self):
+        """
+        :return: tuple of the packet num and its payload
+        """
+        while True:
+            length = _unpack_int(await self._reader.readexactly(4))
+            # the packets of length 4 are used for padding
+            if length != 4:
+                break
+        if length < 16 or length > (1 << 24):
+            raise RuntimeError("Got bad tcp rpc packet length {}".format(length))
+        rest = await self._reader.readexactly(length - 4)
+        packet = struct.pack("<I", length) + rest
+        crc = _unpack_int(packet, length - 4)
+        if zlib.crc32(packet[:length - 4]) & 0xffffffff != crc:
+            raise RuntimeError("Got tcp rpc packet with bad crc32")
+        packet_num = struct.unpack_from("<i", packet, 4)[0]
+        return packet_num, packet[8:length - 4]
+
+    async def drain(self):
+        await self._writer.drain()
+
+    def close(self):
+        self._writer.close()
+
+    async def client_handshake(self):
+        local_port = self._writer.get_extra_info("sockname")[1]
+        self.send_packet(struct.pack("<IiiI16s", RPC_NONCE, 0, 0, int(time.time()), os.urandom(16)))
+        self.send_packet(struct.pack("<Ii", RPC_HANDSHAKE, 0) + _pack_pid(local_port) + bytes(12))
+        await self.drain()
+        for expected_type in (RPC_NONCE, RPC_HANDSHAKE):
+            _, payload = await self.read_packet()
+            packet_type = _unpack_int(payload)
+            if packet_type != expected_type:
+                raise RuntimeError("Tcp rpc handshake failed: got packet type 0x{:08x}".format(packet_type))
+
+    async def server_handshake(self):
+        local_port = self._writer.get_extra_info("sockname")[1]
+        _, nonce = await self.read_packet()
+        if _unpack_int(nonce) != RPC_NONCE:
+            raise RuntimeError("Expected tcp rpc nonce packet")
+        self.send_packet(struct.pack("<IiiI16s", RPC_NONCE, 0, 0, int(time.time()), os.urandom(16)))
+        _, handshake = await self.read_packet()
+        if _unpack_int(handshake) != RPC_HANDSHAKE:
+            raise RuntimeError("Expected tcp rpc handshake packet")
+        client_pid = handshake[8:20]
+        self.send_packet(struct.pack("<Ii", RPC_HANDSHAKE, 0) + _pack_pid(local_port) + client_pid)
+        await self.drain()
+
+    def send_query(self, query_id, body):
+        self.send_packet(struct.pack("<Iq", TL_RPC_INVOKE_REQ, query_id) + body)
+
+    async def read_answer(self):
+        """
+        :return: tuple of the query id, the error flag and the result body
+        """
+        while True:
+            _, payload = await self.read_packet()
+            packet_type = _unpack_int(payload)
+            if packet_type in (TL_RPC_REQ_RESULT, TL_RPC_REQ_ERROR):
+                query_id = struct.unpack_from("<q", payload, 4)[0]
+                return query_id, packet_type == TL_RPC_REQ_ERROR, payload[12:]
+
+
+async def open_tcp_rpc_connection(host, port):
+    reader, writer = await asyncio.open_connection(host, port)
+    connection = TcpRpcConnection(reader, writer)
+    await connection.client_handshake()
+    return connection
@@ -0,0 +1,13 @@
+<?php
+
+function match_const_regexps(): array {
+  preg_match("/б+/u", "абббв", $matches);
+  return [
+    "RE2" => preg_match("/abc/", "xabcx"),
+    "RE2_utf8" => $matches[0],
+    "RE2_with_PCRE" => preg_match_all("/b*/", "abc"),
+    "PCRE" => preg_match_all("/^a$/m", "a\nb\na"),
+  ];
+}
+
+echo json_encode(match_const_regexps());
@@ -0,0 +1,12 @@
+<?php
+
+class Greeter {
+  /** @var string */
+  public $greeting = "hello";
+
+  public function greet(string $name): string {
+    return "{$this->greeting}, $name";
+  }
+}
+
+echo json_encode(["message" => (new Greeter)->greet("objs cache")]);
@@ -0,0 +1,48 @@
+import collections
+import os
+import re
+
+from python.lib.testcase import KphpCompilerAutoTestCase
+from python.lib.kphp_builder import KphpBuilder
+from python.lib.kphp_server import KphpServer
+
+
+class TestConstRegexps(KphpCompilerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_builder = KphpBuilder(
+            php_script_path=os.path.join(cls.test_dir, "php/const_regexps.php"),
+            artifacts_dir=cls.artifacts_dir,
+            working_dir=cls.kphp_build_working_dir
+        )
+
+    def _get_emitted_engines(self):
+        engines = collections.Counter()
+        generated_dir = os.path.join(os.path.dirname(self.kphp_builder.kphp_runtime_bin), "kphp")
+        for directory, _, file_names in os.walk(generated_dir):
+            for file_name in file_names:
+                if file_name.endswith(".cpp"):
+                    with open(os.path.join(directory, file_name), encoding="utf-8", errors="replace") as f:
+                        engines.update(re.findall(r"\.init \(.*, RegexpEngine::(\w+)\);", f.read()))
+        return engines
+
+    def test_engines_of_const_regexps(self):
+        self.kphp_builder.try_remove_kphp_build_trash()
+        self.assertTrue(self.kphp_builder.compile_with_kphp())
+        # the runtime skips the detection for the engines chosen by the compiler
+        self.assertEqual(self._get_emitted_engines(), {"RE2": 2, "RE2_with_PCRE": 1, "PCRE": 1})
+
+        kphp_server = KphpServer(
+            engine_bin=self.kphp_builder.kphp_runtime_bin,
+            working_dir=self.kphp_server_working_dir,
+            auto_start=True
+        )
+        try:
+            self.assertEqual(kphp_server.http_get("/").json(), {
+                "RE2": 1,
+                "RE2_utf8": "ббб",
+                "RE2_with_PCRE": 4,
+                "PCRE": 2,
+            })
+        finally:
+            kphp_server.stop()
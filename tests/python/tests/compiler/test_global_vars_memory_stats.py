@@ -33,11 +33,11 @@ class TestGlobalVarsMemoryStats(KphpCompilerAutoTestCase):
             auto_start=True
         )
         self.assertEqual(kphp_server.http_get("/").json(), {
-            'globals': {'$arr': 104, '$result': 896, '$str': 24},
+            'globals': {'$arr': 104, '$result': 896, '$str': 32},
             'initial': [],
             'static': {
-                '$arr': 104, '$result': 1536, '$str': 24,
+                '$arr': 104, '$result': 1536, '$str': 32,
                 'function_with_static_var::$static_array': 184,
-                'function_with_static_var::$static_str': 24
+                'function_with_static_var::$static_str': 32
             }
         })
@@ -0,0 +1,55 @@
+import os
+
+from python.lib.testcase import KphpCompilerAutoTestCase
+from python.lib.kphp_builder import KphpBuilder
+from python.lib.kphp_server import KphpServer
+
+
+class TestObjsCache(KphpCompilerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.objs_cache_dir = os.path.join(cls.kphp_build_working_dir, "objs_cache")
+        cls.kphp_builder = KphpBuilder(
+            php_script_path=os.path.join(cls.test_dir, "php/objs_cache.php"),
+            artifacts_dir=cls.artifacts_dir,
+            working_dir=cls.kphp_build_working_dir
+        )
+
+    def _compile_from_scratch(self):
+        # the destination dir is dropped, so all the objects are either compiled or taken from the cache
+        self.kphp_builder.try_remove_kphp_build_trash()
+        self.assertTrue(self.kphp_builder.compile_with_kphp({"KPHP_OBJS_CACHE_DIR": self.objs_cache_dir}))
+
+    def _get_cache_dir_files(self):
+        files = {}
+        for directory, _, file_names in os.walk(self.objs_cache_dir):
+            for file_name in file_names:
+                file_path = os.path.join(directory, file_name)
+                files[os.path.relpath(file_path, self.objs_cache_dir)] = os.stat(file_path).st_ino
+        return files
+
+    def _check_server(self):
+        kphp_server = KphpServer(
+            engine_bin=self.kphp_builder.kphp_runtime_bin,
+            working_dir=self.kphp_server_working_dir,
+            auto_start=True
+        )
+        try:
+            self.assertEqual(kphp_server.http_get("/").json(), {"message": "hello, objs cache"})
+        finally:
+            kphp_server.stop()
+
+    def test_cold_and_warm_builds(self):
+        self._compile_from_scratch()
+        cold_files = self._get_cache_dir_files()
+        self.assertTrue(cold_files)
+        # only the objects under their final names, no temporary ones
+        for file_name in cold_files:
+            self.assertRegex(os.path.basename(file_name), "^[0-9a-f]{32}\\.o$")
+        self._check_server()
+
+        for _ in range(2):
+            self._compile_from_scratch()
+            # the objects are reused as is, neither rewritten nor stored back under temporary names
+            self.assertEqual(self._get_cache_dir_files(), cold_files)
+            self._check_server()
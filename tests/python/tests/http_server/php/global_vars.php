@@ -0,0 +1,18 @@
+<?php
+
+class GlobalVarsCounter {
+  /** @var int[] */
+  public static $values = [];
+}
+
+$global_counter = 0;
+
+function touch_global_vars() {
+  global $global_counter;
+  static $static_counter = 0;
+
+  $global_counter++;
+  $static_counter++;
+  GlobalVarsCounter::$values[] = $static_counter;
+  return "$global_counter $static_counter " . count(GlobalVarsCounter::$values);
+}
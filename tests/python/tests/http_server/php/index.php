@@ -1,5 +1,6 @@
 <?php
 
+require_once "global_vars.php";
 
 if ($_SERVER["PHP_SELF"] === "/ini_get") {
   echo ini_get($_SERVER["QUERY_STRING"]);
@@ -10,6 +11,23 @@ if ($_SERVER["PHP_SELF"] === "/ini_get") {
   sleep($sleep_time);
   fwrite(STDERR, "wake up!");
   echo "after sleep";
+} else if ($_SERVER["PHP_SELF"] === "/touch_global_vars") {
+  echo touch_global_vars();
+} else if ($_SERVER["PHP_SELF"] === "/warmup") {
+  // make the script memory dirty, it mustn't be inherited by the workers
+  $data = str_repeat("warm-up", 1 << 20);
+  fwrite(STDERR, "warm-up request level={$_GET["level"]} size=" . strlen($data) . "\n");
+  echo "warmed up";
+} else if ($_SERVER["PHP_SELF"] === "/flush") {
+  echo "first part\n";
+  flush();
+  usleep(500 * 1000);
+  echo "second part\n";
+  flush();
+  if (isset($_GET["error"])) {
+    critical_error("error after flush");
+  }
+  echo "last part";
 }  else {
   echo "Hello world!";
 }
@@ -0,0 +1,87 @@
+import socket
+import time
+
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestFlush(KphpServerAutoTestCase):
+    def _send_raw(self, request_line):
+        s = socket.create_connection(("127.0.0.1", self.kphp_server.http_port), timeout=30)
+        s.sendall(request_line + b"\r\nHost: localhost\r\nConnection: close\r\n\r\n")
+        return s
+
+    @staticmethod
+    def _recv_until(s, response, expected):
+        while expected not in response:
+            data = s.recv(4096)
+            if not data:
+                break
+            response += data
+        return response
+
+    @staticmethod
+    def _recv_all(s, response):
+        data = s.recv(4096)
+        while data:
+            response += data
+            data = s.recv(4096)
+        s.close()
+        return response
+
+    @staticmethod
+    def _split_response(response):
+        head, _, body = response.partition(b"\r\n\r\n")
+        status_line, _, headers_data = head.partition(b"\r\n")
+        headers = {}
+        for line in headers_data.split(b"\r\n"):
+            k, _, v = line.partition(b": ")
+            headers[k.decode().lower()] = v.decode()
+        return status_line, headers, body
+
+    def test_flush_http11_chunked(self):
+        s = self._send_raw(b"GET /flush HTTP/1.1")
+        response = self._recv_until(s, b"", b"first part\n\r\n")
+        first_chunk_time = time.time()
+        response = self._recv_all(s, response)
+        # the first chunk is sent before the script sleeps
+        self.assertGreater(time.time() - first_chunk_time, 0.3)
+
+        status_line, headers, body = self._split_response(response)
+        self.assertTrue(status_line.endswith(b" 200 OK"))
+        self.assertEqual(headers["transfer-encoding"], "chunked")
+        self.assertNotIn("content-length", headers)
+        self.assertEqual(body, b"b\r\nfirst part\n\r\nc\r\nsecond part\n\r\n9\r\nlast part\r\n0\r\n\r\n")
+
+    def test_flush_http11_keep_alive(self):
+        s = socket.create_connection(("127.0.0.1", self.kphp_server.http_port), timeout=30)
+        for _ in range(2):
+            s.sendall(b"GET /flush HTTP/1.1\r\nHost: localhost\r\n\r\n")
+            response = self._recv_until(s, b"", b"\r\n0\r\n\r\n")
+            _, headers, body = self._split_response(response)
+            self.assertEqual(headers["transfer-encoding"], "chunked")
+            self.assertEqual(body, b"b\r\nfirst part\n\r\nc\r\nsecond part\n\r\n9\r\nlast part\r\n0\r\n\r\n")
+        s.close()
+
+    def test_flush_http10_close_delimited(self):
+        s = self._send_raw(b"GET /flush HTTP/1.0")
+        response = self._recv_all(s, b"")
+
+        status_line, headers, body = self._split_response(response)
+        self.assertTrue(status_line.endswith(b" 200 OK"))
+        self.assertNotIn("transfer-encoding", headers)
+        self.assertNotIn("content-length", headers)
+        self.assertEqual(body, b"first part\nsecond part\nlast part")
+
+    def test_error_after_flush(self):
+        s = self._send_raw(b"GET /flush?error=1 HTTP/1.1")
+        response = self._recv_all(s, b"")
+
+        # the sent chunks are kept as is, the missing last chunk tells the client that the response is broken
+        status_line, headers, body = self._split_response(response)
+        self.assertTrue(status_line.endswith(b" 200 OK"))
+        self.assertEqual(headers["transfer-encoding"], "chunked")
+        self.assertEqual(body, b"b\r\nfirst part\n\r\nc\r\nsecond part\n\r\n")
+
+        resp = self.kphp_server.http_get("/")
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.text, "Hello world!")
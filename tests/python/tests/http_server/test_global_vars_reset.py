@@ -0,0 +1,16 @@
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestGlobalVarsReset(KphpServerAutoTestCase):
+    def test_touched_global_vars_reset(self):
+        for _ in range(10):
+            resp = self.kphp_server.http_get("/touch_global_vars")
+            self.assertEqual(resp.status_code, 200)
+            self.assertEqual(resp.text, "1 1 1")
+
+    def test_untouched_global_vars_stay_reset(self):
+        for uri in ["/", "/touch_global_vars", "/", "/", "/touch_global_vars"]:
+            resp = self.kphp_server.http_get(uri)
+            self.assertEqual(resp.status_code, 200)
+            if uri == "/touch_global_vars":
+                self.assertEqual(resp.text, "1 1 1")
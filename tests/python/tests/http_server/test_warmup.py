@@ -0,0 +1,25 @@
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestWarmup(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--warmup-uri": "/warmup?level=full",
+            "--warmup-requests": 3,
+        })
+
+    def test_warmup_requests_are_run_before_forking(self):
+        self.kphp_server.assert_log(
+            ["run 3 warm-up requests of /warmup\\?level=full"] +
+            ["warm-up request level=full size=7340032"] * 3)
+
+    def test_workers_serve_requests_after_warmup(self):
+        for _ in range(20):
+            resp = self.kphp_server.http_get("/")
+            self.assertEqual(resp.status_code, 200)
+            self.assertEqual(resp.text, "Hello world!")
+        resp = self.kphp_server.http_get("/warmup?level=request")
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.text, "warmed up")
+        self.assertKphpNoTerminatedRequests()
@@ -0,0 +1,17 @@
+<?php
+
+if (isset($_SERVER["RPC_REQUEST_ID"])) {
+  $value = fetch_int();
+  rpc_clean();
+  store_int($value + 1);
+  store_finish();
+} else if ($_SERVER["PHP_SELF"] === "/outbound_rpc") {
+  // the stub rpc server answers boolTrue to any query
+  $conn = new_rpc_connection("127.0.0.1", (int)ini_get("io_uring.rpc_port"), 0, 5);
+  rpc_clean();
+  store_int(0x12345678);
+  $answer = rpc_get(rpc_send($conn));
+  echo $answer === false ? "failed" : bin2hex($answer);
+} else {
+  echo "uri=" . $_SERVER["PHP_SELF"];
+}
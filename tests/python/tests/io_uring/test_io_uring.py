@@ -0,0 +1,87 @@
+import asyncio
+import os
+import platform
+import struct
+import unittest
+
+import requests
+
+from python.lib.testcase import KphpServerAutoTestCase
+from python.lib.port_generator import get_port
+from python.lib.stub_backends import StubBackends
+from python.lib.tcp_rpc import open_tcp_rpc_connection
+
+
+def _io_uring_supported():
+    # multishot polls appeared in linux 5.13
+    version = tuple(int(part) for part in platform.release().split("-")[0].split(".")[:2])
+    if version < (5, 13):
+        return False
+    try:
+        with open("/proc/sys/kernel/io_uring_disabled") as f:
+            return f.read().strip() != "2"
+    except OSError:
+        return True
+
+
+@unittest.skipUnless(_io_uring_supported(), "io_uring isn't supported by the kernel")
+class TestIoUring(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.stubs = StubBackends(get_port(), get_port())
+        cls.stubs.start()
+        ini_file = os.path.join(cls.kphp_server_working_dir, "io_uring.ini")
+        with open(ini_file, "w") as f:
+            f.write("io_uring.rpc_port={}\n".format(cls.stubs.rpc_port))
+        cls.kphp_server.update_options({
+            "--io-uring": True,
+            "--port": cls.kphp_server.rpc_port,
+            "--workers-num": 4,
+            "--define-from-config": ini_file,
+        })
+
+    @classmethod
+    def extra_class_teardown(cls):
+        cls.stubs.stop()
+
+    def test_http_connections_close(self):
+        for i in range(20):
+            resp = self.kphp_server.http_get("/close/{}".format(i), headers={"Connection": "close"})
+            self.assertEqual(resp.status_code, 200)
+            self.assertEqual(resp.text, "uri=/close/{}".format(i))
+        self.assertKphpNoTerminatedRequests()
+
+    def test_http_connection_reuse(self):
+        with requests.Session() as session:
+            for i in range(20):
+                resp = session.get("http://127.0.0.1:{}/keep_alive/{}".format(self.kphp_server.http_port, i), timeout=30)
+                self.assertEqual(resp.status_code, 200)
+                self.assertEqual(resp.text, "uri=/keep_alive/{}".format(i))
+        self.assertKphpNoTerminatedRequests()
+
+    def test_outbound_rpc(self):
+        for _ in range(10):
+            resp = self.kphp_server.http_get("/outbound_rpc")
+            self.assertEqual(resp.status_code, 200)
+            self.assertEqual(resp.text, struct.pack("<I", 0x997275b5).hex())
+        self.assertKphpNoTerminatedRequests()
+
+    def test_inbound_rpc(self):
+        async def send_queries(connections_count, queries_per_connection):
+            query_id = 0
+            for _ in range(connections_count):
+                connection = await open_tcp_rpc_connection("127.0.0.1", self.kphp_server.rpc_port)
+                try:
+                    for _ in range(queries_per_connection):
+                        query_id += 1
+                        connection.send_query(query_id, struct.pack("<i", query_id * 10))
+                        await connection.drain()
+                        answer_id, is_error, body = await asyncio.wait_for(connection.read_answer(), 30)
+                        self.assertEqual(answer_id, query_id)
+                        self.assertFalse(is_error)
+                        self.assertEqual(struct.unpack_from("<i", body)[0], query_id * 10 + 1)
+                finally:
+                    connection.close()
+
+        asyncio.new_event_loop().run_until_complete(send_queries(connections_count=5, queries_per_connection=5))
+        self.assertKphpNoTerminatedRequests()
@@ -16,6 +16,10 @@ function do_set_context(array $tags, array $extra_info, string $env) {
   kphp_set_context_on_error($tags, $extra_info, $env);
 }
 
+function do_htmlspecialchars(string $str, int $flags) {
+  echo htmlspecialchars($str, $flags);
+}
+
 function do_stack_overflow(int $x): int {
   $z = 10;
   if ($x) {
@@ -41,6 +45,9 @@ function main() {
       case "set_context":
         do_set_context((array)$action["tags"], (array)$action["extra_info"], (string)$action["env"]);
         break;
+      case "htmlspecialchars":
+        do_htmlspecialchars((string)$action["str"], (int)$action["flags"]);
+        break;
       case "stack_overflow":
         do_stack_overflow(1);
         break;
@@ -0,0 +1,42 @@
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestJsonLogsCriticalErrors(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.ignore_log_errors()
+
+    def test_htmlspecialchars_supported_flags(self):
+        resp = self.kphp_server.http_post(
+            json=[
+                {"op": "htmlspecialchars", "str": "<a href='x'>\"&\"</a>", "flags": 0},
+                {"op": "htmlspecialchars", "str": "<a href='x'>\"&\"</a>", "flags": 1},
+                {"op": "htmlspecialchars", "str": "<a href='x'>\"&\"</a>", "flags": 2},
+            ])
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(
+            resp.text,
+            "&lt;a href='x'&gt;&quot;&amp;&quot;&lt;/a&gt;"
+            "&lt;a href=&#039;x&#039;&gt;&quot;&amp;&quot;&lt;/a&gt;"
+            "&lt;a href='x'&gt;\"&amp;\"&lt;/a&gt;"
+            "ok")
+
+    def test_htmlspecialchars_negative_flags(self):
+        resp = self.kphp_server.http_post(json=[{"op": "htmlspecialchars", "str": "<a>", "flags": -1}])
+        self.assertEqual(resp.status_code, 500)
+        self.kphp_server.assert_json_log(
+            expect=[{
+                "version": 0, "type": 1, "env": "",
+                "msg": "unsupported parameter flags = -1 in function htmlspecialchars",
+                "tags": {"uncaught": True}
+            }])
+
+    def test_htmlspecialchars_too_big_flags(self):
+        resp = self.kphp_server.http_post(json=[{"op": "htmlspecialchars", "str": "<a>", "flags": 3}])
+        self.assertEqual(resp.status_code, 500)
+        self.kphp_server.assert_json_log(
+            expect=[{
+                "version": 0, "type": 1, "env": "",
+                "msg": "unsupported parameter flags = 3 in function htmlspecialchars",
+                "tags": {"uncaught": True}
+            }])
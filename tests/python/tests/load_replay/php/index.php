@@ -0,0 +1,28 @@
+<?php
+
+$mc = new McMemcache();
+$mc->addServer("127.0.0.1", (int)ini_get("load_replay.memcache_port"));
+
+if (isset($_SERVER["RPC_REQUEST_ID"])) {
+  // the replayed rpc query is forwarded to the stub rpc server, which answers boolTrue
+  $function_magic = fetch_int();
+  $conn = new_rpc_connection("127.0.0.1", (int)ini_get("load_replay.rpc_port"), 0, 5);
+  rpc_clean();
+  store_int($function_magic);
+  $answer = rpc_get(rpc_send($conn));
+  rpc_clean();
+  if ($answer === false) {
+    store_error(-3000, "stub rpc server didn't answer");
+  } else {
+    store_raw($answer);
+  }
+  store_finish();
+} else if ($_SERVER["PHP_SELF"] === "/counter") {
+  $counter = (int)$mc->get("counter");
+  $mc->set("counter", $counter + 1);
+  echo json_encode(["counter" => $counter + 1]);
+} else if ($_SERVER["PHP_SELF"] === "/echo") {
+  echo file_get_contents("php://input");
+} else {
+  echo json_encode(["uri" => $_SERVER["REQUEST_URI"], "method" => $_SERVER["REQUEST_METHOD"]]);
+}
@@ -0,0 +1,68 @@
+import os
+
+from python.lib.testcase import KphpServerAutoTestCase
+from python.lib.load_replay import load_recording, run_load
+from python.lib.port_generator import get_port
+from python.lib.stub_backends import StubBackends
+
+
+class TestLoadReplay(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.stubs = StubBackends(get_port(), get_port())
+        cls.stubs.start()
+        ini_file = os.path.join(cls.kphp_server_working_dir, "load_replay.ini")
+        with open(ini_file, "w") as f:
+            f.write("load_replay.memcache_port={}\n".format(cls.stubs.memcache_port))
+            f.write("load_replay.rpc_port={}\n".format(cls.stubs.rpc_port))
+        cls.kphp_server.update_options({
+            "--port": cls.kphp_server.rpc_port,
+            "--define-from-config": ini_file
+        })
+
+    @classmethod
+    def extra_class_teardown(cls):
+        cls.stubs.stop()
+
+    def _replay(self, keep_alive):
+        http_requests, rpc_requests = load_recording(os.path.join(self.test_dir, "php/data/requests.jsonl"))
+        self.assertEqual(len(http_requests), 4)
+        self.assertEqual(len(rpc_requests), 1)
+        return run_load("127.0.0.1", self.kphp_server.http_port, self.kphp_server.rpc_port,
+                        http_requests, rpc_requests, concurrency=4, duration=None, requests_count=200,
+                        keep_alive=keep_alive, master_pid=self.kphp_server.master_pid)
+
+    def test_replay_with_keep_alive(self):
+        memcache_queries = self.stubs.memcache.queries
+        rpc_queries = self.stubs.rpc.queries
+        report = self._replay(keep_alive=True)
+        self.assertEqual(report["http"]["requests"], 200)
+        self.assertEqual(report["http"]["errors"], 0)
+        self.assertEqual(report["http"]["statuses"], {"200": 200})
+        self.assertLessEqual(report["http"]["connections"], 8)
+        self.assertGreater(report["http"]["rps"], 0)
+        latency = report["http"]["latency_ms"]
+        self.assertLessEqual(latency["p50"], latency["p99"])
+        self.assertLessEqual(latency["p99"], latency["p999"])
+        self.assertGreaterEqual(report["workers"]["workers"], 2)
+        self.assertGreater(report["workers"]["rss_max_mb"], 0)
+        # every /counter request makes memcache get and set
+        self.assertGreaterEqual(self.stubs.memcache.queries - memcache_queries, 100)
+
+        self.assertEqual(report["rpc"]["requests"], 200)
+        self.assertEqual(report["rpc"]["errors"], 0)
+        self.assertEqual(report["rpc"]["statuses"], {"rpc_ok": 200})
+        self.assertLessEqual(report["rpc"]["connections"], 8)
+        # every replayed rpc query is forwarded to the stub rpc server
+        self.assertEqual(self.stubs.rpc.queries - rpc_queries, 200)
+        self.assertKphpNoTerminatedRequests()
+
+    def test_replay_without_keep_alive(self):
+        report = self._replay(keep_alive=False)
+        self.assertEqual(report["http"]["requests"], 200)
+        self.assertEqual(report["http"]["errors"], 0)
+        self.assertEqual(report["http"]["connections"], 200)
+        self.assertEqual(report["rpc"]["requests"], 200)
+        self.assertEqual(report["rpc"]["errors"], 0)
+        self.assertEqual(report["rpc"]["connections"], 200)
+        self.assertKphpNoTerminatedRequests()
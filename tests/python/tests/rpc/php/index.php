@@ -0,0 +1,11 @@
+<?php
+
+// the stub rpc server answers the function magic 0x0b16a115 with a huge answer and everything else with boolTrue
+$conn = new_rpc_connection("127.0.0.1", (int)ini_get("rpc_answers.rpc_port"), 0, 5);
+
+rpc_clean();
+store_int($_SERVER["PHP_SELF"] === "/big_answer" ? 0x0b16a115 : 0x12345678);
+$query_id = rpc_send($conn);
+$answer = rpc_get($query_id);
+
+echo json_encode(["ok" => $answer !== false, "size" => $answer === false ? 0 : strlen($answer)]);
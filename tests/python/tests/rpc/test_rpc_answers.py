@@ -0,0 +1,48 @@
+import os
+import struct
+
+from python.lib.testcase import KphpServerAutoTestCase
+from python.lib.port_generator import get_port
+from python.lib.stub_backends import StubBackends
+
+BIG_ANSWER_MAGIC = 0x0b16a115
+# more than the whole script memory, which is limited by --hard-memory-limit
+BIG_ANSWER_SIZE = 12 * 1024 * 1024
+
+
+class TestRpcAnswers(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.stubs = StubBackends(get_port(), get_port(), rpc_results={
+            BIG_ANSWER_MAGIC: struct.pack("<I", BIG_ANSWER_MAGIC) * (BIG_ANSWER_SIZE // 4)
+        })
+        cls.stubs.start()
+        ini_file = os.path.join(cls.kphp_server_working_dir, "rpc_answers.ini")
+        with open(ini_file, "w") as f:
+            f.write("rpc_answers.rpc_port={}\n".format(cls.stubs.rpc_port))
+        cls.kphp_server.update_options({
+            "--define-from-config": ini_file,
+            "--hard-memory-limit": "8m",
+        })
+
+    @classmethod
+    def extra_class_teardown(cls):
+        cls.stubs.stop()
+
+    def test_small_answer(self):
+        resp = self.kphp_server.http_get("/small_answer")
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.json(), {"ok": True, "size": 4})
+        self.assertKphpNoTerminatedRequests()
+
+    def test_answer_bigger_than_script_memory(self):
+        for _ in range(3):
+            resp = self.kphp_server.http_get("/big_answer")
+            self.assertEqual(resp.status_code, 200)
+            # the query fails, but neither the script nor the worker is terminated
+            self.assertEqual(resp.json(), {"ok": False, "size": 0})
+
+        resp = self.kphp_server.http_get("/small_answer")
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.json(), {"ok": True, "size": 4})
+        self.assertKphpNoTerminatedRequests()
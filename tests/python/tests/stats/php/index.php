@@ -16,5 +16,9 @@ function run() {
   wait($i1);
 }
 
-run();
-echo "Hello world!";
+if (isset($_GET["pattern"])) {
+  echo preg_match((string)$_GET["pattern"], (string)$_GET["subject"]);
+} else {
+  run();
+  echo "Hello world!";
+}
@@ -0,0 +1,35 @@
+from python.lib.testcase import KphpServerAutoTestCase
+
+
+class TestRegexpCacheStats(KphpServerAutoTestCase):
+    @classmethod
+    def extra_class_setup(cls):
+        cls.kphp_server.update_options({
+            "--workers-num": 1,
+            "--regexp-cache-size": 2
+        })
+
+    def _preg_match(self, pattern, subject, expected):
+        resp = self.kphp_server.http_get("/?pattern={}&subject={}".format(pattern, subject))
+        self.assertEqual(resp.status_code, 200)
+        self.assertEqual(resp.text, str(expected))
+
+    def test_regexp_cache_stats(self):
+        initial_stats = self.kphp_server.get_stats(prefix="kphp_server.regexp_cache_")
+        self._preg_match("/a/", "xax", 1)
+        self._preg_match("/b/", "xax", 0)
+        self._preg_match("/a/", "xax", 1)
+        self._preg_match("/c/", "xcx", 1)
+        self._preg_match("/b/", "xbx", 1)
+
+        self.kphp_server.assert_stats(
+            initial_stats=initial_stats,
+            prefix="kphp_server.regexp_cache_",
+            expected_added_stats={
+                "hits": 1,
+                "misses": 4,
+                "evictions": 2,
+                "uncached": 0,
+                "size": 2
+            }
+        )
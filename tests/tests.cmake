@@ -16,3 +16,7 @@ if(KPHP_TESTS)
     include(tests/cpp/runtime/runtime-tests.cmake)
     include(tests/cpp/server/server-tests.cmake)
 endif()
+
+if(KPHP_BENCHMARKS)
+    include(tests/cpp/runtime-bench/runtime-bench.cmake)
+endif()